@@ -268,7 +268,7 @@ rdZipf::rdZipf(cXMLAttributeMap attributes)
 
     try
     {
-        atoi(attributes["n"].c_str());
+        n = atoi(attributes["n"].c_str());
     }
     catch (...)
     {
@@ -295,16 +295,7 @@ rdZipf::rdZipf(int n, double alpha, bool baseZero)
 
 double rdZipf::draw()
 {
-    double sum_prob = 0;
-    double z = uniform(0.0001, 0.9999);
-
-    int i;
-    for (i=1; i<=m_number; i++)
-    {
-        sum_prob += m_c / pow((double) i, m_alpha);
-        if (sum_prob >= z)
-            break;
-    }
+    int i = m_table.draw(uniform(0, 1)) + 1;
     if (m_baseZero) return i-1;
     else return i;
 }
@@ -329,10 +320,67 @@ void rdZipf::__initialize(int n, double alpha, bool baseZero)
 
 void rdZipf::__setup_c()
 {
+    std::vector<double> weights(m_number > 0 ? m_number : 1, 1.0);
     m_c = 0.0;
     for (int i=1; i<=m_number; i++)
-        m_c += (1.0 / pow((double) i, m_alpha));
+    {
+        weights[i-1] = 1.0 / pow((double) i, m_alpha);
+        m_c += weights[i-1];
+    }
     m_c = 1.0 / m_c;
+    m_table.build(weights);
+}
+
+void rdAliasTable::build(const std::vector<double>& weights)
+{
+    int n = weights.size();
+    m_prob.assign(n, 0.0);
+    m_alias.assign(n, 0);
+    m_total = 0.0;
+    for (int i=0; i<n; i++)
+        if (weights[i] > 0.0)
+            m_total += weights[i];
+    if (n == 0 || m_total <= 0.0)
+        return;
+
+    // Scale the weights to an average of one and pair each underfull slot with an overfull one
+    std::vector<int> small, large;
+    for (int i=0; i<n; i++)
+    {
+        m_prob[i] = (weights[i] > 0.0 ? weights[i] : 0.0) * n / m_total;
+        if (m_prob[i] < 1.0)
+            small.push_back(i);
+        else
+            large.push_back(i);
+    }
+    while (!small.empty() && !large.empty())
+    {
+        int s = small.back();
+        small.pop_back();
+        int l = large.back();
+        m_alias[s] = l;
+        m_prob[l] -= 1.0 - m_prob[s];
+        if (m_prob[l] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // Whatever is left is full up to rounding errors
+    for (unsigned int i=0; i<small.size(); i++)
+        m_prob[small[i]] = 1.0;
+    for (unsigned int i=0; i<large.size(); i++)
+        m_prob[large[i]] = 1.0;
+}
+
+int rdAliasTable::draw(double u) const
+{
+    int n = m_prob.size();
+    double x = u * n;
+    int i = (int)x;
+    if (i >= n)
+        i = n-1;
+    return (x - i < m_prob[i]) ? i : m_alias[i];
 }
 
 rdObject* rdObjectFactory::create(cXMLAttributeMap attributes)
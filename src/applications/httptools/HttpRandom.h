@@ -33,6 +33,7 @@
 
 #include <exception>
 #include <string>
+#include <vector>
 
 #include "INETDefs.h"
 
@@ -68,6 +69,26 @@ class rdObject
         bool _hasKey(cXMLAttributeMap attributes, std::string key) {return attributes.find(key)!=attributes.end();}
 };
 
+/**
+ * Alias table for sampling a discrete distribution in constant time (Walker's alias method).
+ * The table is built in O(n) from a list of weights, which need not be normalized.
+ */
+class rdAliasTable
+{
+    protected:
+        std::vector<double> m_prob;   ///< Probability of returning the slot itself rather than its alias
+        std::vector<int> m_alias;     ///< The alias of each slot
+        double m_total;               ///< Sum of the weights the table was built from
+    public:
+        rdAliasTable() : m_total(0.0) {}
+        /** Build the table. Negative weights are treated as zero. */
+        void build(const std::vector<double>& weights);
+        /** Return an index with probability proportional to its weight. u must be uniform on [0,1). */
+        int draw(double u) const;
+        int size() const {return m_prob.size();}
+        double getTotal() const {return m_total;}
+};
+
 /**
  * Normal distribution random object.
  * Wraps the OMNeT++ normal distribution function but adds a minimum limit.
@@ -201,6 +222,7 @@ class rdZipf : public rdObject
         int m_number;       ///< The number of nodes to pick from
         double m_c;         ///< Helper constant.
         bool m_baseZero;    ///< True if we want a zero-based return value
+        rdAliasTable m_table;   ///< Alias table of the n probabilities
     public:
         /** Constructor for direct initialization */
         rdZipf(int n, double alpha, bool baseZero = false);
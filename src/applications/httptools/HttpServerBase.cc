@@ -145,6 +145,10 @@ void HttpServerBase::initialize(int stage)
         // Initialize statistics
         htmlDocsServed = imgResourcesServed = textResourcesServed = badRequests = 0;
 
+        benchmark = par("benchmark");
+        benchmarkRequests = 0;
+        benchmarkTime = 0;
+
         // Initialize watches
         WATCH(htmlDocsServed);
         WATCH(imgResourcesServed);
@@ -174,6 +178,19 @@ void HttpServerBase::finish()
     recordScalar("images.served", imgResourcesServed);
     recordScalar("text.served", textResourcesServed);
     recordScalar("bad.requests", badRequests);
+
+    if (benchmark)
+    {
+        double cpuTime = (double)benchmarkTime / CLOCKS_PER_SEC;
+        double simTimeActive = (simTime() - activationTime).dbl();
+        EV_INFO << "Benchmark: " << benchmarkRequests << " requests processed in " << cpuTime << "s CPU time" << endl;
+        recordScalar("benchmark.requests", benchmarkRequests);
+        recordScalar("benchmark.cpuTime", cpuTime);
+        if (cpuTime > 0)
+            recordScalar("benchmark.requestsPerSec", benchmarkRequests / cpuTime);
+        if (simTimeActive > 0)
+            recordScalar("benchmark.requestsPerSimSec", benchmarkRequests / simTimeActive);
+    }
 }
 
 void HttpServerBase::updateDisplay()
@@ -204,6 +221,18 @@ void HttpServerBase::handleMessage(cMessage *msg)
 }
 
 cPacket* HttpServerBase::handleReceivedMessage(cMessage *msg)
+{
+    if (!benchmark)
+        return processRequest(msg);
+
+    clock_t startTime = clock();
+    cPacket *reply = processRequest(msg);
+    benchmarkTime += clock() - startTime;
+    benchmarkRequests++;
+    return reply;
+}
+
+cPacket* HttpServerBase::processRequest(cMessage *msg)
 {
     HttpRequestMessage *request = check_and_cast<HttpRequestMessage *>(msg);
     if (request==NULL)
@@ -314,9 +343,9 @@ HttpReplyMessage* HttpServerBase::generateDocument(HttpRequestMessage *request,
 {
     EV_DEBUG << "Generating HTML document for request " << request->getName() << " from " << request->getSenderModule()->getName() << endl;
 
-    char szReply[512];
-    sprintf(szReply, "HTTP/1.1 200 OK (%s)", resource);
-    HttpReplyMessage* replymsg = new HttpReplyMessage(szReply);
+    std::string replyName = "HTTP/1.1 200 OK (";
+    replyName.append(resource).append(")");
+    HttpReplyMessage* replymsg = new HttpReplyMessage(replyName.c_str());
     replymsg->setHeading("HTTP/1.1 200 OK");
     replymsg->setOriginatorUrl(hostName.c_str());
     replymsg->setTargetUrl(request->originatorUrl());
@@ -328,8 +357,9 @@ HttpReplyMessage* HttpServerBase::generateDocument(HttpRequestMessage *request,
 
     if (scriptedMode)
     {
-        replymsg->setPayload(htmlPages[resource].body.c_str());
-        size = htmlPages[resource].size;
+        const HtmlPageData& page = htmlPages[resource];
+        replymsg->setPayload(page.body.c_str());
+        size = page.size;
     }
     else
     {
@@ -369,9 +399,9 @@ HttpReplyMessage* HttpServerBase::generateResourceMessage(HttpRequestMessage *re
     else
         error("Invalid resource category");
 
-    char szReply[512];
-    sprintf(szReply, "HTTP/1.1 200 OK (%s)", resource.c_str());
-    HttpReplyMessage* replymsg = new HttpReplyMessage(szReply);
+    std::string replyName = "HTTP/1.1 200 OK (";
+    replyName.append(resource).append(")");
+    HttpReplyMessage* replymsg = new HttpReplyMessage(replyName.c_str());
     replymsg->setHeading("HTTP/1.1 200 OK");
     replymsg->setOriginatorUrl(hostName.c_str());
     replymsg->setTargetUrl(request->originatorUrl());
@@ -382,7 +412,6 @@ HttpReplyMessage* HttpServerBase::generateResourceMessage(HttpRequestMessage *re
     replymsg->setByteLength(size); // Set the resource size
     replymsg->setKind(HTTPT_RESPONSE_MESSAGE);
 
-    sprintf(szReply, "RESOURCE-BODY:%s", resource.c_str());
     return replymsg;
 }
 
@@ -404,27 +433,42 @@ HttpReplyMessage* HttpServerBase::generateErrorReply(HttpRequestMessage *request
     return replymsg;
 }
 
-std::string HttpServerBase::generateBody()
+const std::string& HttpServerBase::generateBody()
 {
     int numResources = (int)rdNumResources->draw();
     int numImages = (int)(numResources*rdTextImageResourceRatio->draw());
     int numText = numResources - numImages;
 
-    std::string result;
+    return getGeneratedBody(numImages, numText);
+}
 
-    char tempBuf[128];
+const std::string& HttpServerBase::getGeneratedBody(int numImages, int numText)
+{
+    // Bodies only depend on the resource counts, so each one is built once
+    std::pair<int,int> key(numImages, numText);
+    std::map<std::pair<int,int>,std::string>::iterator it = generatedBodies.find(key);
+    if (it != generatedBodies.end())
+        return it->second;
+
+    pregenerateResourceLines(imageResourceLines, "IMG", "jpg", numImages);
+    pregenerateResourceLines(textResourceLines, "TEXT", "txt", numText);
+
+    std::string& result = generatedBodies[key];
     for (int i=0; i<numImages; i++)
-    {
-        sprintf(tempBuf, "%s%.4d.%s\n", "IMG", i, "jpg");
-        result.append(tempBuf);
-    }
+        result.append(imageResourceLines[i]);
     for (int i=0; i<numText; i++)
+        result.append(textResourceLines[i]);
+    return result;
+}
+
+void HttpServerBase::pregenerateResourceLines(std::vector<std::string>& lines, const char *prefix, const char *extension, int count)
+{
+    char tempBuf[128];
+    for (int i=lines.size(); i<count; i++)
     {
-        sprintf(tempBuf, "%s%.4d.%s\n", "TEXT", i, "txt");
-        result.append(tempBuf);
+        sprintf(tempBuf, "%s%.4d.%s\n", prefix, i, extension);
+        lines.push_back(tempBuf);
     }
-
-    return result;
 }
 
 void HttpServerBase::registerWithController()
@@ -33,6 +33,7 @@
 
 #include <string>
 #include <vector>
+#include <time.h>
 #include "HttpNodeBase.h"
 
 // Event message kinds
@@ -82,6 +83,17 @@ class INET_API HttpServerBase : public HttpNodeBase
         /** A map of resource, keyed by a resource URL. Used in scripted mode. */
         std::map<std::string,unsigned int> resources;
 
+        /** Generated page bodies, keyed by the number of image and text resources. Used in random mode. */
+        std::map<std::pair<int,int>,std::string> generatedBodies;
+        /** Pregenerated resource reference lines of generated pages ("IMG0000.jpg\n", ...), indexed by resource number. */
+        std::vector<std::string> imageResourceLines;
+        std::vector<std::string> textResourceLines;
+
+        /** set to true to measure the CPU time spent on request processing */
+        bool benchmark;
+        long benchmarkRequests;
+        clock_t benchmarkTime;
+
         // Basic statistics
         long htmlDocsServed;
         long imgResourcesServed;
@@ -132,11 +144,17 @@ class INET_API HttpServerBase : public HttpNodeBase
         HttpReplyMessage* handleGetRequest(HttpRequestMessage *request, std::string resource);
         /** Generate a error reply in case of invalid resource requests. */
         HttpReplyMessage* generateErrorReply(HttpRequestMessage *request, int code);
-        /** Create a random body according to the site content random distributions. */
-        virtual std::string generateBody();
+        /** Create a random body according to the site content random distributions. The result is valid until the next call. */
+        virtual const std::string& generateBody();
+        /** Return the body listing the given number of image and text resources. The result is cached. */
+        const std::string& getGeneratedBody(int numImages, int numText);
+        /** Extend lines with resource references up to count entries. */
+        void pregenerateResourceLines(std::vector<std::string>& lines, const char *prefix, const char *extension, int count);
 
         /** Handle a received data message, e.g. check if the content requested exists. */
         cPacket* handleReceivedMessage(cMessage *msg);
+        /** Process a received request message and generate the reply. Called by handleReceivedMessage. */
+        cPacket* processRequest(cMessage *msg);
         /** Register the server object with the controller. Called at initialization (simulation startup). */
         void registerWithController();
         /** Read a site definition from file if a scripted site definition is used. */
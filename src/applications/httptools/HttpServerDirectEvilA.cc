@@ -46,21 +46,21 @@ void HttpServerDirectEvilA::initialize(int stage)
     }
 }
 
-std::string HttpServerDirectEvilA::generateBody()
+const std::string& HttpServerDirectEvilA::generateBody()
 {
     int numImages = badLow+(int)uniform(0, badHigh-badLow);
     double rndDelay;
-    std::string result;
+    body.clear();
 
     char tempBuf[128];
     for (int i=0; i<numImages; i++)
     {
         rndDelay = 10.0+uniform(0, 2.0);
         sprintf(tempBuf, "IMG%.4d.jpg;%s;%f\n", i, "www.good.com", rndDelay);
-        result.append(tempBuf);
+        body.append(tempBuf);
     }
 
-    return result;
+    return body;
 }
 
 
@@ -47,20 +47,20 @@ void HttpServerEvilA::initialize(int stage)
     }
 }
 
-std::string HttpServerEvilA::generateBody()
+const std::string& HttpServerEvilA::generateBody()
 {
     int numImages = badLow+(int)uniform(0, badHigh-badLow);
     double rndDelay;
-    std::string result;
+    body.clear();
 
     char tempBuf[128];
     for (int i=0; i<numImages; i++)
     {
         rndDelay = 10.0+uniform(0, 2.0);
         sprintf(tempBuf, "IMG%.4d.jpg;%s;%f\n", i, "www.good.com", rndDelay);
-        result.append(tempBuf);
+        body.append(tempBuf);
     }
 
-    return result;
+    return body;
 }
 
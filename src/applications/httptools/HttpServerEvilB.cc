@@ -47,11 +47,11 @@ void HttpServerEvilB::initialize(int stage)
     }
 }
 
-std::string HttpServerEvilB::generateBody()
+const std::string& HttpServerEvilB::generateBody()
 {
     int numResources = badLow+(int)uniform(0, badHigh-badLow);
     double rndDelay;
-    std::string result;
+    body.clear();
 
     char tempBuf[128];
     int refSize;
@@ -60,9 +60,9 @@ std::string HttpServerEvilB::generateBody()
         rndDelay = 10.0+uniform(0, 2.0);
         refSize = (int)uniform(500, 1000); // The random size represents a random reference string length
         sprintf(tempBuf, "TEXT%.4d.txt;%s;%f;%s;%d\n", i, "www.good.com", rndDelay, "TRUE", refSize);
-        result.append(tempBuf);
+        body.append(tempBuf);
     }
 
-    return result;
+    return body;
 }
 
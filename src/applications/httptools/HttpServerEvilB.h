@@ -55,10 +55,11 @@ class INET_API HttpServerEvilB : public HttpServer
     private:
         int badLow;
         int badHigh;
+        std::string body;  // the body built by the last generateBody() call
     protected:
         virtual int numInitStages() const { return 4; }
         virtual void initialize(int stage);
-        virtual std::string generateBody();
+        virtual const std::string& generateBody();
 };
 
 #endif /* HttpServerEvilB */
@@ -32,22 +32,56 @@
     typedef uint8_t  uint8;
 #endif  // OMNETPP_VERSION >= 0x500
 
+//
+// Compile-time log level. Log statements written with EV_LOG(level) or the
+// EV_xxx macros below are compiled out when their level is below
+// INET_LOG_LEVEL, so their arguments cost nothing. Build with e.g.
+// -DINET_LOG_LEVEL=INET_LOGLEVEL_WARN. Modules on the packet path
+// (Ieee80211Mac, Radio, EtherMAC, IPv4, TCP, ChannelControl) also accept
+// a module specific level that overrides it, e.g.
+// -DIEEE80211MAC_LOG_LEVEL=INET_LOGLEVEL_OFF.
+//
+#define INET_LOGLEVEL_TRACE   0
+#define INET_LOGLEVEL_DEBUG   1
+#define INET_LOGLEVEL_DETAIL  2
+#define INET_LOGLEVEL_INFO    3
+#define INET_LOGLEVEL_WARN    4
+#define INET_LOGLEVEL_ERROR   5
+#define INET_LOGLEVEL_FATAL   6
+#define INET_LOGLEVEL_OFF     7
+
+#ifndef INET_LOG_LEVEL
+#  define INET_LOG_LEVEL  INET_LOGLEVEL_TRACE
+#endif
+
+// true if statements of the level are compiled in (with minLevel as the
+// minimum) and the log is not disabled at runtime (e.g. express mode)
+#if OMNETPP_VERSION < 0x500
+#  define INET_LOG_ENABLED_AT(level, minLevel)  (INET_LOGLEVEL_##level >= (minLevel) && !ev.isDisabled())
+#else
+#  define INET_LOG_ENABLED_AT(level, minLevel)  (INET_LOGLEVEL_##level >= (minLevel))
+#endif
+#define INET_LOG_ENABLED(level)  INET_LOG_ENABLED_AT(level, INET_LOG_LEVEL)
+
+// usage: EV_LOG(DETAIL) << "...";  (Note: deliberately no parens in macro def)
+#define EV_LOG(level)  (!INET_LOG_ENABLED(level))?EV:EV
+
 #if OMNETPP_VERSION < 0x500
-#  define EV_FATAL  EV << "FATAL: "
-#  define EV_ERROR  EV << "ERROR: "
-#  define EV_WARN   EV << "WARN: "
-#  define EV_INFO   EV
-#  define EV_DETAIL EV << "DETAIL: "
-#  define EV_DEBUG  EV << "DEBUG: "
-#  define EV_TRACE  EV << "TRACE: "
-
-#  define EV_FATAL_C(category)  EV << "[" << category << "] FATAL: "
-#  define EV_ERROR_C(category)  EV << "[" << category << "] ERROR: "
-#  define EV_WARN_C(category)   EV << "[" << category << "] WARN: "
-#  define EV_INFO_C(category)   EV << "[" << category << "] "
-#  define EV_DETAIL_C(category) EV << "[" << category << "] DETAIL: "
-#  define EV_DEBUG_C(category)  EV << "[" << category << "] DEBUG: "
-#  define EV_TRACE_C(category)  EV << "[" << category << "] TRACE: "
+#  define EV_FATAL  EV_LOG(FATAL) << "FATAL: "
+#  define EV_ERROR  EV_LOG(ERROR) << "ERROR: "
+#  define EV_WARN   EV_LOG(WARN) << "WARN: "
+#  define EV_INFO   EV_LOG(INFO)
+#  define EV_DETAIL EV_LOG(DETAIL) << "DETAIL: "
+#  define EV_DEBUG  EV_LOG(DEBUG) << "DEBUG: "
+#  define EV_TRACE  EV_LOG(TRACE) << "TRACE: "
+
+#  define EV_FATAL_C(category)  EV_LOG(FATAL) << "[" << category << "] FATAL: "
+#  define EV_ERROR_C(category)  EV_LOG(ERROR) << "[" << category << "] ERROR: "
+#  define EV_WARN_C(category)   EV_LOG(WARN) << "[" << category << "] WARN: "
+#  define EV_INFO_C(category)   EV_LOG(INFO) << "[" << category << "] "
+#  define EV_DETAIL_C(category) EV_LOG(DETAIL) << "[" << category << "] DETAIL: "
+#  define EV_DEBUG_C(category)  EV_LOG(DEBUG) << "[" << category << "] DEBUG: "
+#  define EV_TRACE_C(category)  EV_LOG(TRACE) << "[" << category << "] TRACE: "
 
 #  define EV_STATICCONTEXT  /* Empty */
 
@@ -66,4 +66,48 @@ T *__checknull(T *p, const char *expr, const char *file, int line)
 
 #define PK(msg)  check_and_cast<cPacket *>(msg)    /*XXX temp def*/
 
+//
+// Variants of Enter_Method for service methods that other modules call for
+// every packet. Enter_Method formats its arguments and reports the call even
+// when there is nobody to show it to.
+//
+// Method calls are only visible under a GUI (animation) or in the eventlog
+// (module method call entries), so they are reported in full only then.
+//
+// Enter_Method_Lazy switches the context like Enter_Method, but formats the
+// arguments and reports the call only when it is visible; otherwise it is
+// the same as Enter_Method_Silent. Usable in any method.
+//
+// Enter_Method_Query and Enter_Method_Query_Silent are for pure lookups, i.e.
+// methods that do not create, take, delete, send or schedule objects, and do
+// not write log output or change anything but lookup caches either. When the
+// call is not visible, they do not switch the context at all.
+//
+// Like Enter_Method, these are followed by the argument list of the call:
+//    Enter_Method_Query("findRoute(%s)", addr.str().c_str());
+//
+// The visibility test is the one the simulation kernel itself uses for
+// method call notifications: cEnvir::suppress_notifications is set by Cmdenv
+// unless eventlog recording is on, and it is never set under Tkenv.
+//
+#define INET_METHOD_CALL_VISIBLE  (ev.isGUI() || !ev.suppress_notifications)
+#define Enter_Method_Lazy  cMethodCallContextSwitcher __ctx(this); if (!INET_METHOD_CALL_VISIBLE) __ctx.methodCallSilent(); else __ctx.methodCall
+#define Enter_Method_Query  QueryContextSwitcher __ctx(this); if (__ctx.get()) __ctx.get()->methodCall
+#define Enter_Method_Query_Silent  QueryContextSwitcher __ctx(this); if (__ctx.get()) __ctx.get()->methodCallSilent
+
+/**
+ * Helper for Enter_Method_Query: switches the context only if the call is visible.
+ */
+class QueryContextSwitcher
+{
+  private:
+    cMethodCallContextSwitcher *switcher;
+    QueryContextSwitcher(const QueryContextSwitcher&);
+    QueryContextSwitcher& operator=(const QueryContextSwitcher&);
+  public:
+    QueryContextSwitcher(const cComponent *target) : switcher(INET_METHOD_CALL_VISIBLE ? new cMethodCallContextSwitcher(target) : NULL) {}
+    ~QueryContextSwitcher() { delete switcher; }
+    cMethodCallContextSwitcher *get() { return switcher; }
+};
+
 #endif  // __INET_INETDEFS_H
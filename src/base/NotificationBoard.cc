@@ -49,7 +49,8 @@ std::ostream& operator<<(std::ostream& os, const NotificationBoard::NotifiableVe
 
 void NotificationBoard::initialize()
 {
-    WATCH_MAP(clientMap);
+    clientTable.resize(NF_IPv4_ROUTE_BATCH_COMMITTED + 1);  // other categories are added as needed
+    WATCH_VECTOR(clientTable);
 }
 
 void NotificationBoard::handleMessage(cMessage *msg)
@@ -62,8 +63,13 @@ void NotificationBoard::subscribe(INotifiable *client, int category)
 {
     Enter_Method("subscribe(%s)", notificationCategoryName(category));
 
+    if (category < 0)
+        throw cRuntimeError("invalid notification category %d", category);
+
     // find or create entry for this category
-    NotifiableVector& clients = clientMap[category];
+    if (category >= (int)clientTable.size())
+        clientTable.resize(category + 1);
+    NotifiableVector& clients = clientTable[category];
 
     // add client if not already there
     if (std::find(clients.begin(), clients.end(), client) == clients.end())
@@ -76,34 +82,32 @@ void NotificationBoard::unsubscribe(INotifiable *client, int category)
 {
     Enter_Method("unsubscribe(%s)", notificationCategoryName(category));
 
-    // find (or create) entry for this category
-    NotifiableVector& clients = clientMap[category];
-
     // remove client if there
-    NotifiableVector::iterator it = std::find(clients.begin(), clients.end(), client);
-    if (it!=clients.end())
-        clients.erase(it);
+    NotifiableVector *clients = findClients(category);
+    if (clients)
+    {
+        NotifiableVector::iterator it = std::find(clients->begin(), clients->end(), client);
+        if (it!=clients->end())
+            clients->erase(it);
+    }
 
     fireChangeNotification(NF_SUBSCRIBERLIST_CHANGED, NULL);
 }
 
 bool NotificationBoard::hasSubscribers(int category)
 {
-    ClientMap::iterator it = clientMap.find(category);
-    return it!=clientMap.end() && !it->second.empty();
+    return findClients(category) != NULL;
 }
 
-void NotificationBoard::fireChangeNotification(int category, const cObject *details)
+void NotificationBoard::deliverChangeNotification(int category, const cObject *details)
 {
-    Enter_Method("fireChangeNotification(%s, %s)", notificationCategoryName(category),
-                 details?details->info().c_str() : "n/a");
-
-    ClientMap::iterator it = clientMap.find(category);
-    if (it==clientMap.end())
-        return;
-    NotifiableVector& clients = it->second;
-    for (NotifiableVector::iterator j=clients.begin(); j!=clients.end(); j++)
-        (*j)->receiveChangeNotification(category, details);
+    // details->info() can be expensive, and is only displayed by the GUI
+    Enter_Method_Lazy("fireChangeNotification(%s, %s)", notificationCategoryName(category),
+                      details?details->info().c_str() : "n/a");
+
+    // clients may subscribe during delivery, which can reallocate the table
+    for (unsigned int i=0; i<clientTable[category].size(); i++)
+        clientTable[category][i]->receiveChangeNotification(category, details);
 }
 
 
@@ -19,7 +19,6 @@
 #ifndef __INET_NOTIFICATIONBOARD_H
 #define __INET_NOTIFICATIONBOARD_H
 
-#include <map>
 #include <vector>
 
 #include "INETDefs.h"
@@ -87,11 +86,11 @@ class INET_API NotificationBoard : public cSimpleModule
 {
   public: // should be protected
     typedef std::vector<INotifiable *> NotifiableVector;
-    typedef std::map<int, NotifiableVector> ClientMap;
+    typedef std::vector<NotifiableVector> ClientTable;  // indexed by category
     friend std::ostream& operator<<(std::ostream&, const NotifiableVector&); // doesn't work in MSVC 6.0
 
   protected:
-    ClientMap clientMap;
+    ClientTable clientTable;
 
   protected:
     /**
@@ -128,6 +127,20 @@ class INET_API NotificationBoard : public cSimpleModule
     virtual bool hasSubscribers(int category);
     //@}
 
+  protected:
+    /**
+     * Returns the subscribers of the given category, or NULL if there are none.
+     */
+    NotifiableVector *findClients(int category) {
+        return (category >= 0 && category < (int)clientTable.size() && !clientTable[category].empty()) ? &clientTable[category] : NULL;
+    }
+
+    /**
+     * Delivers the notification; only called if there are subscribers.
+     */
+    virtual void deliverChangeNotification(int category, const cObject *details);
+
+  public:
     /** @name Methods for producers of change notifications */
     //@{
     /**
@@ -135,8 +148,14 @@ class INET_API NotificationBoard : public cSimpleModule
      * taken place. The optional details object may carry more specific
      * information about the change (e.g. exact location, specific attribute
      * that changed, old value, new value, etc).
+     *
+     * Returns right away if nobody is subscribed to the category; the
+     * method call is only annotated with details->info() in GUI mode.
      */
-    virtual void fireChangeNotification(int category, const cObject *details = NULL);
+    virtual void fireChangeNotification(int category, const cObject *details = NULL) {
+        if (findClients(category))
+            deliverChangeNotification(category, details);
+    }
     //@}
 };
 
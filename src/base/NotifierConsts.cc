@@ -73,6 +73,8 @@ const char *notificationCategoryName(int category)
         case NF_BATTERY_CHANGED: return "NF_BATTERY_CHANGED";
         case NF_BATTERY_CPUTIME_CONSUMED: return "NF_BATTERY_CPUTIME_CONSUMED";
 
+        case NF_IPv4_ROUTE_BATCH_COMMITTED: return "IPv4-ROUTE-BATCH";
+
         default: sprintf(buf, "%d", category); s = buf; break;
     }
     return s;
@@ -132,6 +132,9 @@ enum
     // - battery
     NF_BATTERY_CHANGED,
     NF_BATTERY_CPUTIME_CONSUMED,
+
+    // - layer 3 (network), appended so that the values above stay unchanged
+    NF_IPv4_ROUTE_BATCH_COMMITTED,
 };
 
 /**
@@ -0,0 +1,78 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <sstream>
+
+#include "PacketQueue.h"
+
+
+PacketQueue::~PacketQueue()
+{
+    clear();
+}
+
+void PacketQueue::grow()
+{
+    std::vector<cPacket *> newRing(ring.empty() ? 16 : 2 * ring.size(), (cPacket *)NULL);
+    for (unsigned int i = 0; i < length; i++)
+        newRing[i] = ring[(head + i) & (ring.size() - 1)];
+    ring.swap(newRing);
+    head = 0;
+}
+
+void PacketQueue::insert(cPacket *packet)
+{
+    ASSERT(packet);
+    if (length == ring.size())
+        grow();
+    ring[(head + length) & (ring.size() - 1)] = packet;
+    length++;
+    byteLength += packet->getByteLength();
+}
+
+cPacket *PacketQueue::pop()
+{
+    if (length == 0)
+        throw cRuntimeError("PacketQueue::pop(): queue empty");
+    cPacket *packet = ring[head];
+    ring[head] = NULL;
+    head = (head + 1) & (ring.size() - 1);
+    length--;
+    byteLength -= packet->getByteLength();
+    return packet;
+}
+
+cPacket *PacketQueue::get(int k) const
+{
+    if (k < 0 || (unsigned int)k >= length)
+        throw cRuntimeError("PacketQueue::get(): index %d out of range", k);
+    return ring[(head + k) & (ring.size() - 1)];
+}
+
+void PacketQueue::clear()
+{
+    while (length > 0)
+        delete pop();
+    head = 0;
+}
+
+std::string PacketQueue::info() const
+{
+    std::stringstream out;
+    out << "length=" << length << " bytes=" << byteLength;
+    return out.str();
+}
@@ -0,0 +1,93 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_PACKETQUEUE_H
+#define __INET_PACKETQUEUE_H
+
+#include <string>
+#include <vector>
+#include "INETDefs.h"
+
+
+/**
+ * FIFO packet queue for the passive queue modules, used instead of cQueue.
+ * Packets are kept in a ring buffer that grows by doubling, so insertion
+ * and removal do not allocate, and the number of packets and the sum of
+ * their byte lengths are both maintained in constant time.
+ *
+ * Unlike cQueue, the queue does not take ownership of the packets: they
+ * stay owned by the module that inserted them, so no ownership transfer
+ * takes place on insert and pop, and the module can send them directly.
+ * Packets still in the queue are deleted by clear() and the destructor.
+ *
+ * The byte length is accounted at insertion, so packets must not change
+ * their length while they are in the queue.
+ */
+class INET_API PacketQueue
+{
+  protected:
+    std::vector<cPacket *> ring;  // size is zero or a power of two
+    unsigned int head;  // index of the first packet
+    unsigned int length;
+    int64 byteLength;
+
+  protected:
+    void grow();
+
+  public:
+    PacketQueue() : head(0), length(0), byteLength(0) {}
+    ~PacketQueue();
+
+    /**
+     * Appends the packet to the end of the queue.
+     */
+    void insert(cPacket *packet);
+
+    /**
+     * Removes and returns the first packet; the queue must not be empty.
+     */
+    cPacket *pop();
+
+    /**
+     * Returns the first packet without removing it; the queue must not be empty.
+     */
+    cPacket *front() const { ASSERT(length > 0); return ring[head]; }
+
+    /**
+     * Returns the kth packet, counting from the front.
+     */
+    cPacket *get(int k) const;
+
+    /**
+     * Deletes all packets in the queue.
+     */
+    void clear();
+
+    bool isEmpty() const { return length == 0; }
+    int getLength() const { return length; }
+    int64 getByteLength() const { return byteLength; }
+
+    std::string info() const;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const PacketQueue& queue)
+{
+    return os << queue.info();
+}
+
+#endif
+
@@ -42,27 +42,34 @@ void PassiveQueueBase::handleMessage(cMessage *msg)
 {
     numQueueReceived++;
 
-    emit(rcvdPkSignal, msg);
+    // the signals are checked one by one, because the statistics are
+    // usually recorded for a few of them only
+    if (mayHaveListeners(rcvdPkSignal))
+        emit(rcvdPkSignal, msg);
 
     if (packetRequested > 0)
     {
         packetRequested--;
-        emit(enqueuePkSignal, msg);
-        emit(dequeuePkSignal, msg);
-        emit(queueingTimeSignal, SIMTIME_ZERO);
+        if (mayHaveListeners(enqueuePkSignal))
+            emit(enqueuePkSignal, msg);
+        if (mayHaveListeners(dequeuePkSignal))
+            emit(dequeuePkSignal, msg);
+        if (mayHaveListeners(queueingTimeSignal))
+            emit(queueingTimeSignal, SIMTIME_ZERO);
         sendOut(msg);
     }
     else
     {
         msg->setArrivalTime(simTime());
         cMessage *droppedMsg = enqueue(msg);
-        if (msg != droppedMsg)
+        if (msg != droppedMsg && mayHaveListeners(enqueuePkSignal))
             emit(enqueuePkSignal, msg);
 
         if (droppedMsg)
         {
             numQueueDropped++;
-            emit(dropPkByQueueSignal, droppedMsg);
+            if (mayHaveListeners(dropPkByQueueSignal))
+                emit(dropPkByQueueSignal, droppedMsg);
             delete droppedMsg;
         }
         else
@@ -88,8 +95,10 @@ void PassiveQueueBase::requestPacket()
     }
     else
     {
-        emit(dequeuePkSignal, msg);
-        emit(queueingTimeSignal, simTime() - msg->getArrivalTime());
+        if (mayHaveListeners(dequeuePkSignal))
+            emit(dequeuePkSignal, msg);
+        if (mayHaveListeners(queueingTimeSignal))
+            emit(queueingTimeSignal, simTime() - msg->getArrivalTime());
         sendOut(msg);
     }
 }
@@ -46,84 +46,58 @@ bool ReassemblyBuffer::addFragment(ushort beg, ushort end, bool islast)
 
 void ReassemblyBuffer::merge(ushort beg, ushort end, bool islast)
 {
-    if (main.end==beg)
+    if (beg<=main.end && end>=main.beg)
     {
-        // most typical case (<95%): new fragment follows last one
-        main.end = end;
+        // most typical case (<95%): new fragment follows last one;
+        // also covers preceding, overlapping and duplicate fragments
+        if (beg < main.beg)
+            main.beg = beg;
+        if (end > main.end)
+            main.end = end;
         if (islast)
             main.islast = true;
         if (fragments)
-            mergeFragments();
+            absorbFragments(main);
     }
-    else if (main.beg==end)
-    {
-        // new fragment precedes what we already have
-        main.beg = beg;
-        if (fragments)
-            mergeFragments();
-    }
-    else if (main.end<beg || main.beg>end)
+    else
     {
         // disjoint fragment, store it until another fragment fills in the gap
         if (!fragments)
-            fragments = new RegionVector();
+            fragments = new RegionMap();
         Region r;
         r.beg = beg;
         r.end = end;
         r.islast = islast;
-        fragments->push_back(r);
-    }
-    else
-    {
-        // overlapping is not possible;
-        // fragment's range already contained in buffer (probably duplicate fragment)
+        absorbFragments(r);
+        (*fragments)[r.beg] = r;
     }
 }
 
-void ReassemblyBuffer::mergeFragments()
+void ReassemblyBuffer::absorbFragments(Region& region)
 {
-    RegionVector& frags = *fragments;
-
-    bool oncemore;
-    do
+    // The stored regions are disjoint and sorted, so the ones touching
+    // the given region form a contiguous range: those starting at or before
+    // region.end, going backwards while they still reach region.beg.
+    RegionMap::iterator hi = fragments->upper_bound(region.end);
+    RegionMap::iterator lo = hi;
+    while (lo != fragments->begin())
     {
-        oncemore = false;
-        for (RegionVector::iterator i=frags.begin(); i!=frags.end(); )
-        {
-            bool deleteit = false;
-            Region& frag = *i;
-            if (main.end==frag.beg)
-            {
-                main.end = frag.end;
-                if (frag.islast)
-                    main.islast = true;
-                deleteit = true;
-            }
-            else if (main.beg==frag.end)
-            {
-                main.beg = frag.beg;
-                deleteit = true;
-            }
-            else if (main.beg<=frag.beg && main.end>=frag.end)
-            {
-                // we already have this region (duplicate fragment), delete it
-                deleteit = true;
-            }
+        RegionMap::iterator prev = lo;
+        --prev;
+        if (prev->second.end < region.beg)
+            break;
+        lo = prev;
+    }
 
-            if (deleteit)
-            {
-                // deletion is tricky because erase() invalidates iterator
-                int pos = i - frags.begin();
-                frags.erase(i);
-                i = frags.begin() + pos;
-                oncemore = true;
-            }
-            else
-            {
-                ++i;
-            }
-        }
+    for (RegionMap::iterator i = lo; i != hi; ++i)
+    {
+        const Region& frag = i->second;
+        if (frag.beg < region.beg)
+            region.beg = frag.beg;
+        if (frag.end > region.end)
+            region.end = frag.end;
+        if (frag.islast)
+            region.islast = true;
     }
-    while (oncemore);
+    fragments->erase(lo, hi);
 }
-
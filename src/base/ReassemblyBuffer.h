@@ -19,7 +19,6 @@
 #define __INET_REASSEMBLYBUFFER_H
 
 #include <map>
-#include <vector>
 #include "INETDefs.h"
 
 
@@ -39,7 +38,8 @@ class INET_API ReassemblyBuffer
         bool islast;  // if this region represents the last bytes of the datagram
     };
 
-    typedef std::vector<Region> RegionVector;
+    // disjoint regions keyed by their first offset
+    typedef std::map<ushort, Region> RegionMap;
 
     //
     // Thinking of IPv4/IPv6 fragmentation, 99% of the time fragments
@@ -48,14 +48,17 @@ class INET_API ReassemblyBuffer
     // we'll store the offset of the first and last+1 byte we have
     // (main.beg, main.end variables), and keep extending this range
     // as new fragments arrive. If we receive non-connecting fragments,
-    // put them aside into buf until new fragments come and fill the gap.
+    // put them aside into fragments until new fragments come and fill the gap.
+    // The regions in fragments are kept coalesced: they neither overlap nor
+    // touch each other or main, so merging costs O(log n) however
+    // out of order the fragments arrive.
     //
     Region main;   // offset range we already have
-    RegionVector *fragments;  // only used if we receive disjoint fragments
+    RegionMap *fragments;  // only used if we receive disjoint fragments
 
   protected:
     void merge(ushort beg, ushort end, bool islast);
-    void mergeFragments();
+    void absorbFragments(Region& region);
 
   public:
     /**
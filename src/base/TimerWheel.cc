@@ -0,0 +1,298 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <algorithm>
+
+#include "TimerWheel.h"
+
+
+TimerWheel::TimerWheel()
+{
+    owner = NULL;
+    tickEvent = NULL;
+    slotBits = 0;
+    numLevels = 0;
+    slotMask = 0;
+    currentTick = 0;
+    seqCounter = 0;
+}
+
+TimerWheel::~TimerWheel()
+{
+    if (tickEvent)
+        owner->cancelAndDelete(tickEvent);
+}
+
+void TimerWheel::initialize(cSimpleModule *owner, simtime_t granularity, int slotBits, int numLevels)
+{
+    if (granularity <= 0)
+        throw cRuntimeError("TimerWheel: granularity must be positive");
+    if (slotBits <= 0 || numLevels <= 0 || slotBits * numLevels > 62)
+        throw cRuntimeError("TimerWheel: invalid geometry, %d levels of 2^%d slots", numLevels, slotBits);
+    if (tickEvent)
+        this->owner->cancelAndDelete(tickEvent);
+
+    this->owner = owner;
+    this->granularity = granularity;
+    this->slotBits = slotBits;
+    this->numLevels = numLevels;
+    slotMask = ((int64)1 << slotBits) - 1;
+    slots.clear();
+    slots.resize(numLevels << slotBits);
+    levelCounts.assign(numLevels, 0);
+    overflow.clear();
+    due.clear();
+    locations.clear();
+    currentTick = getTick(simTime());
+    seqCounter = 0;
+    tickEvent = new cMessage("timerWheelTick");
+}
+
+bool TimerWheel::compareEntries(const Entry& a, const Entry& b)
+{
+    return a.expiry < b.expiry || (a.expiry == b.expiry && a.seq < b.seq);
+}
+
+bool TimerWheel::isWheelEmpty() const
+{
+    for (int level = 0; level < numLevels; level++)
+        if (levelCounts[level] != 0)
+            return false;
+    return overflow.empty();
+}
+
+void TimerWheel::insert(Slot& from, Slot::iterator pos)
+{
+    // timers in the past of the wheel go to the current slot, they still expire at their exact time
+    int64 tick = std::max(pos->tick, currentTick);
+    int64 delta = tick - currentTick;
+    Location& location = pos->location->second;
+    for (int level = 0; level < numLevels; level++)
+    {
+        int shift = slotBits * level;
+        if (delta < ((int64)1 << (shift + slotBits)))
+        {
+            location.level = level;
+            location.slot = (int)((tick >> shift) & slotMask);
+            getSlot(level, location.slot).splice(getSlot(level, location.slot).end(), from, pos);
+            levelCounts[level]++;
+            return;
+        }
+    }
+    location.level = numLevels;
+    location.slot = 0;
+    overflow.splice(overflow.end(), from, pos);
+}
+
+void TimerWheel::cascade(int level)
+{
+    // redistribute the slot we have just entered among the lower levels
+    Slot& slot = getSlot(level, (int)((currentTick >> (slotBits * level)) & slotMask));
+    Slot tmp;
+    tmp.splice(tmp.end(), slot);
+    while (!tmp.empty())
+    {
+        levelCounts[level]--;
+        insert(tmp, tmp.begin());
+    }
+}
+
+void TimerWheel::advance()
+{
+    // find the lowest non-empty level; the levels below it need not be stepped through
+    int level = 0;
+    while (level < numLevels && levelCounts[level] == 0)
+        level++;
+
+    if (level == numLevels)
+    {
+        // only the overflow list has timers: jump right to the earliest one
+        if (overflow.empty())
+            return;
+        int64 minTick = overflow.front().tick;
+        for (Slot::iterator it = overflow.begin(); it != overflow.end(); ++it)
+            minTick = std::min(minTick, it->tick);
+        currentTick = std::max(minTick, currentTick + 1);
+        Slot tmp;
+        tmp.splice(tmp.end(), overflow);
+        while (!tmp.empty())
+            insert(tmp, tmp.begin());
+        return;
+    }
+
+    int64 blockMask = ((int64)1 << (slotBits * level)) - 1;
+    currentTick = (currentTick | blockMask) + 1;
+    for (int l = 1; l < numLevels; l++)
+    {
+        if ((currentTick & (((int64)1 << (slotBits * l)) - 1)) != 0)
+            return;
+        cascade(l);
+    }
+    if ((currentTick & (((int64)1 << (slotBits * numLevels)) - 1)) == 0 && !overflow.empty())
+    {
+        Slot tmp;
+        tmp.splice(tmp.end(), overflow);
+        while (!tmp.empty())
+            insert(tmp, tmp.begin());
+    }
+}
+
+void TimerWheel::collectExpired(simtime_t now)
+{
+    int64 nowTick = getTick(now);
+    while (true)
+    {
+        Slot& slot = getSlot(0, (int)(currentTick & slotMask));
+        for (Slot::iterator it = slot.begin(); it != slot.end(); )
+        {
+            Slot::iterator cur = it++;
+            if (cur->expiry <= now)
+            {
+                cur->location->second.level = -1;
+                due.splice(due.end(), slot, cur);
+                levelCounts[0]--;
+            }
+        }
+        if (currentTick >= nowTick || isWheelEmpty())
+            break;
+        advance();
+    }
+    due.sort(compareEntries);
+}
+
+void TimerWheel::rescheduleTickEvent()
+{
+    simtime_t next;
+    if (!due.empty())
+        next = due.front().expiry;
+    else if (locations.empty())
+    {
+        if (tickEvent->isScheduled())
+            owner->cancelEvent(tickEvent);
+        return;
+    }
+    else
+    {
+        while (getSlot(0, (int)(currentTick & slotMask)).empty())
+            advance();
+        Slot& slot = getSlot(0, (int)(currentTick & slotMask));
+        next = slot.front().expiry;
+        for (Slot::iterator it = slot.begin(); it != slot.end(); ++it)
+            if (it->expiry < next)
+                next = it->expiry;
+    }
+
+    if (tickEvent->isScheduled())
+    {
+        if (tickEvent->getArrivalTime() == next)
+            return;
+        owner->cancelEvent(tickEvent);
+    }
+    owner->scheduleAt(std::max(next, simTime()), tickEvent);
+}
+
+void TimerWheel::scheduleAt(simtime_t t, cMessage *timer)
+{
+    if (!owner)
+        throw cRuntimeError("TimerWheel: not initialized");
+    if (t < simTime())
+        throw cRuntimeError("TimerWheel: cannot schedule timer '%s' into the past", timer->getName());
+    if (timer->isScheduled() || isScheduled(timer))
+        throw cRuntimeError("TimerWheel: timer '%s' is already scheduled", timer->getName());
+
+    // an empty wheel can be moved to the present, keeping the deltas small
+    if (isWheelEmpty())
+        currentTick = std::max(currentTick, getTick(simTime()));
+
+    Slot tmp;
+    Entry entry;
+    entry.timer = timer;
+    entry.expiry = t;
+    entry.tick = getTick(t);
+    entry.seq = seqCounter++;
+    entry.location = locations.insert(std::make_pair(timer, Location())).first;
+    tmp.push_back(entry);
+    entry.location->second.pos = tmp.begin();
+    insert(tmp, tmp.begin());
+
+    if (!tickEvent->isScheduled() || t < tickEvent->getArrivalTime())
+    {
+        if (tickEvent->isScheduled())
+            owner->cancelEvent(tickEvent);
+        owner->scheduleAt(t, tickEvent);
+    }
+}
+
+cMessage *TimerWheel::cancel(cMessage *timer)
+{
+    LocationMap::iterator it = locations.find(timer);
+    if (it == locations.end())
+        return timer;
+
+    Location& location = it->second;
+    if (location.level == -1)
+        due.erase(location.pos);
+    else if (location.level == numLevels)
+        overflow.erase(location.pos);
+    else
+    {
+        getSlot(location.level, location.slot).erase(location.pos);
+        levelCounts[location.level]--;
+    }
+    locations.erase(it);
+
+    // the tick event of an empty wheel would only make the owner believe it has work to do
+    if (locations.empty() && tickEvent->isScheduled())
+        owner->cancelEvent(tickEvent);
+    return timer;
+}
+
+simtime_t TimerWheel::getExpiryTime(cMessage *timer) const
+{
+    LocationMap::const_iterator it = locations.find(timer);
+    if (it == locations.end())
+        throw cRuntimeError("TimerWheel: timer '%s' is not scheduled", timer->getName());
+    return it->second.pos->expiry;
+}
+
+cMessage *TimerWheel::popExpired()
+{
+    if (due.empty())
+        collectExpired(simTime());
+    if (!due.empty())
+    {
+        cMessage *timer = due.front().timer;
+        locations.erase(due.front().location);
+        due.pop_front();
+        return timer;
+    }
+    rescheduleTickEvent();
+    return NULL;
+}
+
+void TimerWheel::clear()
+{
+    for (unsigned int i = 0; i < slots.size(); i++)
+        slots[i].clear();
+    levelCounts.assign(numLevels, 0);
+    overflow.clear();
+    due.clear();
+    locations.clear();
+    if (tickEvent && tickEvent->isScheduled())
+        owner->cancelEvent(tickEvent);
+}
+
@@ -0,0 +1,170 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_TIMERWHEEL_H
+#define __INET_TIMERWHEEL_H
+
+#include <list>
+#include <map>
+#include <vector>
+#include "INETDefs.h"
+
+
+/**
+ * Hierarchical timer wheel for modules that keep many soft timers
+ * (per-entry or per-destination timeouts). Timers are ordinary cMessage
+ * objects, but instead of being scheduled one by one in the future event
+ * set, they are kept in the wheel and the owner module only has a single
+ * tick event scheduled, at the expiry time of the earliest timer.
+ *
+ * Timers still expire at their exact times, and timers of the same wheel
+ * expiring at the same time fire in the order they were scheduled; the
+ * granularity only determines how timers are bucketed, not when they fire.
+ * The order relative to the module's other events is not the same as with
+ * self-messages, though: all due timers are delivered from the tick event,
+ * which has its own insertion order in the FES. When a timer and another
+ * event (a message arrival, or a self-message not kept in the wheel) fall
+ * on the same simulation time, they may be processed in a different order
+ * than before, so converting a module to the wheel can change simulation
+ * results (fingerprints).
+ *
+ * Usage:
+ * <pre>
+ * void initialize() {
+ *     timerWheel.initialize(this, 0.01);
+ * }
+ * void handleMessage(cMessage *msg) {
+ *     if (timerWheel.isTickEvent(msg)) {
+ *         cMessage *timer;
+ *         while ((timer = timerWheel.popExpired()) != NULL)
+ *             handleTimer(timer);
+ *     }
+ *     ...
+ * }
+ * </pre>
+ *
+ * The wheel does not own the timers: the owner module deletes them as it
+ * would delete its self-messages, after cancel() if they are still pending.
+ */
+class INET_API TimerWheel
+{
+  protected:
+    struct Location;
+    typedef std::map<cMessage *, Location> LocationMap;
+
+    struct Entry
+    {
+        cMessage *timer;
+        simtime_t expiry;
+        int64 tick;
+        unsigned long seq;  // insertion order, to break ties between the wheel's timers
+        LocationMap::iterator location;
+    };
+    typedef std::list<Entry> Slot;
+
+    // where a timer is stored: level -1 is the due list, level numLevels the overflow list
+    struct Location
+    {
+        int level;
+        int slot;
+        Slot::iterator pos;
+    };
+
+    cSimpleModule *owner;
+    cMessage *tickEvent;
+    simtime_t granularity;
+    int slotBits;
+    int numLevels;
+    int64 slotMask;
+
+    std::vector<Slot> slots;    // numLevels * (1 << slotBits) slots
+    std::vector<int> levelCounts;
+    Slot overflow;              // timers beyond the range of the top level
+    Slot due;                   // expired timers not yet returned by popExpired(), in firing order
+    LocationMap locations;
+    int64 currentTick;
+    unsigned long seqCounter;
+
+  protected:
+    int64 getTick(simtime_t t) const { return t.raw() / granularity.raw(); }
+    Slot& getSlot(int level, int slot) { return slots[(level << slotBits) + slot]; }
+    bool isWheelEmpty() const;
+    void insert(Slot& from, Slot::iterator pos);
+    void cascade(int level);
+    void advance();
+    void collectExpired(simtime_t now);
+    void rescheduleTickEvent();
+    static bool compareEntries(const Entry& a, const Entry& b);
+
+  public:
+    TimerWheel();
+    ~TimerWheel();
+
+    /**
+     * Sets the module that receives the tick event, and the tick length.
+     * slotBits is the base 2 logarithm of the number of slots per level;
+     * the default 8 bits and 4 levels cover 2^32 ticks without overflow.
+     */
+    void initialize(cSimpleModule *owner, simtime_t granularity, int slotBits = 8, int numLevels = 4);
+
+    /**
+     * Schedules the timer to expire at the given time. The timer must not
+     * be pending in the wheel, nor scheduled in the FES.
+     */
+    void scheduleAt(simtime_t t, cMessage *timer);
+
+    /**
+     * Removes the timer from the wheel if it is pending, and returns it.
+     */
+    cMessage *cancel(cMessage *timer);
+
+    /**
+     * Returns true if the timer is pending in the wheel.
+     */
+    bool isScheduled(cMessage *timer) const { return locations.find(timer) != locations.end(); }
+
+    /**
+     * Returns the expiry time of a pending timer.
+     */
+    simtime_t getExpiryTime(cMessage *timer) const;
+
+    /**
+     * Returns the number of pending timers.
+     */
+    int size() const { return locations.size(); }
+
+    /**
+     * Returns true if msg is the tick event of this wheel.
+     */
+    bool isTickEvent(cMessage *msg) const { return msg == tickEvent; }
+
+    /**
+     * To be called repeatedly after the tick event arrived: returns the
+     * next expired timer, or NULL when there are no more, after which the
+     * tick event is rescheduled. Timers may be scheduled and cancelled
+     * while processing the expired ones.
+     */
+    cMessage *popExpired();
+
+    /**
+     * Forgets all pending timers without deleting them.
+     */
+    void clear();
+};
+
+#endif
+
@@ -27,6 +27,12 @@
 #include "NodeOperations.h"
 #include "opp_utils.h"
 
+// module specific compile-time log level, see Compat.h
+#ifdef ETHERMAC_LOG_LEVEL
+#  undef INET_LOG_LEVEL
+#  define INET_LOG_LEVEL  ETHERMAC_LOG_LEVEL
+#endif
+
 
 const double EtherMACBase::SPEED_OF_LIGHT_IN_CABLE = 200000000.0;
 
@@ -216,7 +222,7 @@ void EtherMACBase::initializeQueueModule()
             queueModule = check_and_cast<IPassiveQueue *>(queueOut->getOwnerModule());
         }
 
-        EV << "Requesting first frame from queue module\n";
+        EV_LOG(INFO) << "Requesting first frame from queue module\n";
         txQueue.setExternalQueue(queueModule);
 
         if (txQueue.extQueue->getNumPendingRequests() == 0)
@@ -254,7 +260,7 @@ void EtherMACBase::initializeFlags()
     connected = physOutGate->getPathEndGate()->isConnected() && physInGate->getPathStartGate()->isConnected();
 
     if (!connected)
-        EV << "MAC not connected to a network.\n";
+        EV_LOG(INFO) << "MAC not connected to a network.\n";
 
     WATCH(connected);
 
@@ -403,7 +409,7 @@ void EtherMACBase::processConnectDisconnect()
             while (!txQueue.innerQueue->empty())
             {
                 cMessage *msg = check_and_cast<cMessage *>(txQueue.innerQueue->pop());
-                EV << "Interface is not connected, dropping packet " << msg << endl;
+                EV_LOG(DETAIL) << "Interface is not connected, dropping packet " << msg << endl;
                 numDroppedPkFromHLIfaceDown++;
                 emit(dropPkIfaceDownSignal, msg);
                 delete msg;
@@ -484,7 +490,7 @@ bool EtherMACBase::dropFrameNotForUs(EtherFrame *frame)
     if (isPause && frame->getDest().equals(MACAddress::MULTICAST_PAUSE_ADDRESS))
         return false;
 
-    EV << "Frame `" << frame->getName() <<"' not destined to us, discarding\n";
+    EV_LOG(DETAIL) << "Frame `" << frame->getName() <<"' not destined to us, discarding\n";
     numDroppedNotForUs++;
     emit(dropPkNotForUsSignal, frame);
     delete frame;
@@ -567,15 +573,15 @@ void EtherMACBase::readChannelParameters(bool errorWhenAsymmetric)
 void EtherMACBase::printParameters()
 {
     // Dump parameters
-    EV << "MAC address: " << address << (promiscuous ? ", promiscuous mode" : "") << endl
+    EV_LOG(INFO) << "MAC address: " << address << (promiscuous ? ", promiscuous mode" : "") << endl
        << "txrate: " << curEtherDescr->txrate << ", "
        << (duplexMode ? "full-duplex" : "half-duplex") << endl;
 #if 1
-    EV << "bitTime: " << 1.0 / curEtherDescr->txrate << endl;
-    EV << "frameBursting: " << frameBursting << endl;
-    EV << "slotTime: " << curEtherDescr->slotTime << endl;
-    EV << "interFrameGap: " << INTERFRAME_GAP_BITS / curEtherDescr->txrate << endl;
-    EV << endl;
+    EV_LOG(INFO) << "bitTime: " << 1.0 / curEtherDescr->txrate << endl;
+    EV_LOG(INFO) << "frameBursting: " << frameBursting << endl;
+    EV_LOG(INFO) << "slotTime: " << curEtherDescr->slotTime << endl;
+    EV_LOG(INFO) << "interFrameGap: " << INTERFRAME_GAP_BITS / curEtherDescr->txrate << endl;
+    EV_LOG(INFO) << endl;
 #endif
 }
 
@@ -105,7 +105,7 @@ MACAddressTable::AddressTable * MACAddressTable::getTableForVid(unsigned int vid
 
 int MACAddressTable::getPortForAddress(MACAddress& address, unsigned int vid)
 {
-    Enter_Method("MACAddressTable::getPortForAddress()");
+    Enter_Method_Lazy("MACAddressTable::getPortForAddress()");
 
     AddressTable * table = getTableForVid(vid);
     // VLAN ID vid does not exist
@@ -136,7 +136,7 @@ int MACAddressTable::getPortForAddress(MACAddress& address, unsigned int vid)
 
 bool MACAddressTable::updateTableWithAddress(int portno, MACAddress& address, unsigned int vid)
 {
-    Enter_Method("MACAddressTable::updateTableWithAddress()");
+    Enter_Method_Lazy("MACAddressTable::updateTableWithAddress()");
     if (address.isBroadcast())
         return false;
 
@@ -0,0 +1,86 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "Ieee80211AMPDUFrame.h"
+
+
+Register_Class(Ieee80211AMPDUFrame);
+
+Ieee80211AMPDUFrame& Ieee80211AMPDUFrame::operator=(const Ieee80211AMPDUFrame& other)
+{
+    if (this == &other) return *this;
+    clean();
+    Ieee80211AMPDUFrame_Base::operator=(other);
+    copy(other);
+    return *this;
+}
+
+void Ieee80211AMPDUFrame::copy(const Ieee80211AMPDUFrame& other)
+{
+    // the length was copied by the base class, so do not use addSubframe()
+    for (unsigned int i = 0; i < other.subframes.size(); i++)
+    {
+        Ieee80211DataOrMgmtFrame *frame = other.subframes[i] ? other.subframes[i]->dup() : NULL;
+        if (frame)
+            take(frame);
+        subframes.push_back(frame);
+    }
+}
+
+Ieee80211AMPDUFrame::~Ieee80211AMPDUFrame()
+{
+    clean();
+}
+
+void Ieee80211AMPDUFrame::clean()
+{
+    for (unsigned int i = 0; i < subframes.size(); i++)
+        if (subframes[i])
+            dropAndDelete(subframes[i]);
+    subframes.clear();
+}
+
+int64 Ieee80211AMPDUFrame::getSubframeByteLength(cPacket *frame)
+{
+    return (AMPDU_DELIMITER_BYTES + frame->getByteLength() + 3) & ~(int64)3;
+}
+
+void Ieee80211AMPDUFrame::addSubframe(Ieee80211DataOrMgmtFrame *frame)
+{
+    take(frame);
+    subframes.push_back(frame);
+    addByteLength(getSubframeByteLength(frame));
+}
+
+Ieee80211DataOrMgmtFrame *Ieee80211AMPDUFrame::getSubframe(unsigned int k) const
+{
+    if (k >= subframes.size())
+        throw cRuntimeError(this, "getSubframe(): index %u out of range", k);
+    return subframes[k];
+}
+
+Ieee80211DataOrMgmtFrame *Ieee80211AMPDUFrame::removeSubframe(unsigned int k)
+{
+    Ieee80211DataOrMgmtFrame *frame = getSubframe(k);
+    if (frame)
+    {
+        drop(frame);
+        subframes[k] = NULL;
+    }
+    return frame;
+}
+
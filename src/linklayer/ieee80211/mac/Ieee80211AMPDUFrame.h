@@ -0,0 +1,81 @@
+//
+// Copyright (C) 2013 OpenSim Ltd.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_IEEE80211AMPDUFRAME_H
+#define __INET_IEEE80211AMPDUFRAME_H
+
+#include <vector>
+#include "INETDefs.h"
+#include "Ieee80211Frame_m.h"
+
+
+/**
+ * Represents an A-MPDU: data frames for the same receiver that are sent
+ * in one PPDU. More info in the Ieee80211Frame.msg file (and the
+ * documentation generated from it).
+ *
+ * The aggregate owns its subframes. The receiver takes them out one by one
+ * with removeSubframe(), which leaves a NULL in their place so that the
+ * indices of the other subframes do not change.
+ */
+class INET_API Ieee80211AMPDUFrame : public Ieee80211AMPDUFrame_Base
+{
+  protected:
+    std::vector<Ieee80211DataOrMgmtFrame *> subframes;
+
+  private:
+    void copy(const Ieee80211AMPDUFrame& other);
+    void clean();
+
+  public:
+    Ieee80211AMPDUFrame(const char *name = NULL, int kind = 0) : Ieee80211AMPDUFrame_Base(name, kind) {}
+    Ieee80211AMPDUFrame(const Ieee80211AMPDUFrame& other) : Ieee80211AMPDUFrame_Base(other) { copy(other); }
+    ~Ieee80211AMPDUFrame();
+    Ieee80211AMPDUFrame& operator=(const Ieee80211AMPDUFrame& other);
+    virtual Ieee80211AMPDUFrame *dup() const {return new Ieee80211AMPDUFrame(*this);}
+
+    /**
+     * Returns the length of the frame as an A-MPDU subframe: delimiter,
+     * MPDU and padding to a multiple of 4 bytes.
+     */
+    static int64 getSubframeByteLength(cPacket *frame);
+
+    /**
+     * Takes ownership of the frame and appends it to the aggregate,
+     * increasing the length of the aggregate accordingly.
+     */
+    virtual void addSubframe(Ieee80211DataOrMgmtFrame *frame);
+
+    /**
+     * Returns the number of subframes, including the removed ones.
+     */
+    virtual unsigned int getNumSubframes() const {return subframes.size();}
+
+    /**
+     * Returns the kth subframe, or NULL if it has been removed.
+     */
+    virtual Ieee80211DataOrMgmtFrame *getSubframe(unsigned int k) const;
+
+    /**
+     * Removes the kth subframe from the aggregate and returns it; the
+     * caller becomes its owner. The length of the aggregate is unchanged.
+     */
+    virtual Ieee80211DataOrMgmtFrame *removeSubframe(unsigned int k);
+};
+
+#endif
+
@@ -24,9 +24,15 @@ const unsigned int LENGTH_CTS = 112; //bits
 const unsigned int LENGTH_ACK = 112; //bits
 const unsigned int LENGTH_MGMT = 28 * 8; //bits
 const unsigned int LENGTH_DATAHDR = 34 * 8; //bits
+const unsigned int LENGTH_BLOCKACK = 32 * 8; //bits, compressed Block Ack
 
 const unsigned int SNAP_HEADER_BYTES = 8;
 
+// A-MPDU subframes: each MPDU is preceded by a delimiter and padded to 4 bytes
+const unsigned int AMPDU_DELIMITER_BYTES = 4;
+// the Block Ack bitmap covers this many sequence numbers
+const int BLOCKACK_WINDOW_SIZE = 64;
+
 // time slot ST, short interframe space SIFS, distributed interframe
 // space DIFS, and extended interframe space EIFS
 
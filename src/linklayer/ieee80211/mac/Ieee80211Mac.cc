@@ -31,6 +31,12 @@
 // TODO: 9.3.2.1, If there are buffered multicast or broadcast frames, the PC shall transmit these prior to any unicast frames.
 // TODO: control frames must send before
 
+// module specific compile-time log level, see Compat.h
+#ifdef IEEE80211MAC_LOG_LEVEL
+#  undef INET_LOG_LEVEL
+#  define INET_LOG_LEVEL  IEEE80211MAC_LOG_LEVEL
+#endif
+
 Define_Module(Ieee80211Mac);
 
 // don't forget to keep synchronized the C++ enum and the runtime enum definition
@@ -108,7 +114,7 @@ void Ieee80211Mac::initialize(int stage)
 
     if (stage == 0)
     {
-        EV << "Initializing stage 0\n";
+        EV_LOG(INFO) << "Initializing stage 0\n";
         int numQueues = 1;
         if (par("EDCA"))
         {
@@ -151,17 +157,23 @@ void Ieee80211Mac::initialize(int stage)
 
         prioritizeMulticast = par("prioritizeMulticast");
 
-        EV<<"Operating mode: 802.11"<<opMode;
+        EV_LOG(INFO) <<"Operating mode: 802.11"<<opMode;
         maxQueueSize = par("maxQueueSize");
         rtsThreshold = par("rtsThresholdBytes");
 
+        aggregation = par("aggregation");
+        maxAggregateFrames = par("maxAggregateFrames");
+        maxAggregateBytes = par("maxAggregateBytes");
+        if (aggregation && (maxAggregateFrames < 2 || maxAggregateFrames > BLOCKACK_WINDOW_SIZE))
+            error("maxAggregateFrames must be between 2 and %d", BLOCKACK_WINDOW_SIZE);
+
         // the variable is renamed due to a confusion in the standard
         // the name retry limit would be misleading, see the header file comment
         transmissionLimit = par("retryLimit");
         if (transmissionLimit == -1) transmissionLimit = 7;
         ASSERT(transmissionLimit >= 0);
 
-        EV<<" retryLimit="<<transmissionLimit;
+        EV_LOG(INFO) <<" retryLimit="<<transmissionLimit;
 
         cwMinData = par("cwMinData");
         if (cwMinData == -1) cwMinData = CW_MIN;
@@ -174,7 +186,7 @@ void Ieee80211Mac::initialize(int stage)
         cwMinMulticast = par("cwMinMulticast");
         if (cwMinMulticast == -1) cwMinMulticast = 31;
         ASSERT(cwMinMulticast >= 0);
-        EV<<" cwMinMulticast="<<cwMinMulticast;
+        EV_LOG(INFO) <<" cwMinMulticast="<<cwMinMulticast;
 
         defaultAC = par("defaultAC");
         if (classifier && dynamic_cast<Ieee80211eClassifier*>(classifier))
@@ -245,7 +257,6 @@ void Ieee80211Mac::initialize(int stage)
             Ieee80211Descriptor::getIdx(opMode, basicBitrate);
 
         controlBitRate = par("controlBitrate").doubleValue();
-        EV<<" slotTime = "<<getSlotTime()*1e6<<"us DIFS = "<< getDIFS()*1e6<<"us";
 
         if (controlBitRate == -1)
         {
@@ -259,12 +270,21 @@ void Ieee80211Mac::initialize(int stage)
             controlFrameModulationType = Ieee80211Descriptor::getDescriptor(basicBitrateIdx).modulationType;
         }
 
+        // frame durations are computed once per bucket, see DurationTable
+        durationTables.resize(Ieee80211Descriptor::size());
+        for (int idx = Ieee80211Descriptor::getMinIdx(opMode); idx <= Ieee80211Descriptor::getMaxIdx(opMode); idx++)
+            initDurationTable(durationTables[idx], Ieee80211Descriptor::getDescriptor(idx).modulationType);
+        initDurationTable(controlFrameDurationTable, controlFrameModulationType);
+
+        updateTimingParameters();
+        EV_LOG(INFO) <<" slotTime = "<<getSlotTime()*1e6<<"us DIFS = "<< getDIFS()*1e6<<"us";
+
 
         // configure AutoBit Rate
         configureAutoBitRate();
         //end auto rate code
-        EV<<" basicBitrate="<<basicBitrate/1e6<<"Mb ";
-        EV<<" bitrate="<<bitrate/1e6<<"Mb IDLE="<<IDLE<<" RECEIVE="<<RECEIVE<<endl;
+        EV_LOG(INFO) <<" basicBitrate="<<basicBitrate/1e6<<"Mb ";
+        EV_LOG(INFO) <<" bitrate="<<bitrate/1e6<<"Mb IDLE="<<IDLE<<" RECEIVE="<<RECEIVE<<endl;
 
 
         const char *addressString = par("address");
@@ -282,6 +302,16 @@ void Ieee80211Mac::initialize(int stage)
                 address.setAddress(addressString);
         }
 
+        headerOnlyOverhearing = par("headerOnlyOverhearing");
+        if (headerOnlyOverhearing)
+        {
+            PhyControlInfo *phyCtrl = new PhyControlInfo();
+            phyCtrl->setAddress(address);
+            cMessage *msg = new cMessage("configureAddress", PHY_C_CONFIGUREADDRESS);
+            msg->setControlInfo(phyCtrl);
+            sendDown(msg);
+        }
+
         // subscribe for the information of the carrier sense
         nb->subscribe(this, NF_RADIOSTATE_CHANGED);
 
@@ -318,6 +348,8 @@ void Ieee80211Mac::initialize(int stage)
             numDropped(i) = 0;
         nav = false;
         txop = false;
+        numAggregatedFrames = 0;
+        aggregateTxDuration = 0;
         last = 0;
 
         contI = 0;
@@ -348,6 +380,8 @@ void Ieee80211Mac::initialize(int stage)
         numSentTXOP = 0;
         numReceivedOther = 0;
         numAckSend = 0;
+        numSentAggregates = 0;
+        numBlockAckSend = 0;
         successCounter = 0;
         failedCounter = 0;
         recovery = 0;
@@ -417,6 +451,7 @@ void Ieee80211Mac::initWatches()
          WATCH(edcCAF[i].numSent);
      WATCH(numBits);
      WATCH(numSentTXOP);
+     WATCH(numSentAggregates);
      WATCH(numReceived);
      WATCH(numSentMulticast);
      WATCH(numReceivedMulticast);
@@ -438,18 +473,18 @@ void Ieee80211Mac::configureAutoBitRate()
     {
     case 0:
         rateControlMode = RATE_CR;
-        EV<<"MAC Transmission algorithm : Constant Rate"  <<endl;
+        EV_LOG(DETAIL) <<"MAC Transmission algorithm : Constant Rate"  <<endl;
         break;
     case 1:
         rateControlMode = RATE_ARF;
-        EV<<"MAC Transmission algorithm : ARF Rate"  <<endl;
+        EV_LOG(DETAIL) <<"MAC Transmission algorithm : ARF Rate"  <<endl;
         break;
     case 2:
         rateControlMode = RATE_AARF;
         successCoeff = par("successCoeff");
         timerCoeff = par("timerCoeff");
         maxSuccessThreshold = par("maxSuccessThreshold");
-        EV<<"MAC Transmission algorithm : AARF Rate"  <<endl;
+        EV_LOG(DETAIL) <<"MAC Transmission algorithm : AARF Rate"  <<endl;
         break;
     default:
         throw cRuntimeError("Invalid autoBitrate parameter: '%d'", autoBitrate);
@@ -478,6 +513,8 @@ void Ieee80211Mac::finish()
         recordScalar(th.c_str(), numSent(i));
     }
     recordScalar("sent in TXOP ", numSentTXOP );
+    recordScalar("sent A-MPDUs", numSentAggregates);
+    recordScalar("sent Block Acks", numBlockAckSend);
     for (int i=0; i<numCategories(); i++)
     {
         std::stringstream os;
@@ -531,7 +568,7 @@ void Ieee80211Mac::initializeQueueModule()
         cModule *module = getParentModule()->getSubmodule(par("queueModule").stringValue());
         queueModule = check_and_cast<IPassiveQueue *>(module);
 
-        EV << "Requesting first two frames from queue module\n";
+        EV_LOG(INFO) << "Requesting first two frames from queue module\n";
         queueModule->requestPacket();
         // needed for backoff: mandatory if next message is already present
         queueModule->requestPacket();
@@ -551,7 +588,7 @@ void Ieee80211Mac::handleSelfMsg(cMessage *msg)
         return;
     }
 
-    EV << "received self message: " << msg << "(kind: " << msg->getKind() << ")" << endl;
+    EV_LOG(DETAIL) << "received self message: " << msg << "(kind: " << msg->getKind() << ")" << endl;
 
     if (msg == endReserve)
         nav = false;
@@ -561,7 +598,7 @@ void Ieee80211Mac::handleSelfMsg(cMessage *msg)
 
     if ( !strcmp(msg->getName(), "AIFS") || !strcmp(msg->getName(), "Backoff") )
     {
-        EV << "Changing currentAC to " << msg->getKind() << endl;
+        EV_LOG(DETAIL) << "Changing currentAC to " << msg->getKind() << endl;
         currentAC = msg->getKind();
     }
     //check internal collision
@@ -571,25 +608,25 @@ void Ieee80211Mac::handleSelfMsg(cMessage *msg)
         kind = msg->getKind();
         if (kind<0)
             kind = 0;
-        EV <<" kind is " << kind << ",name is " << msg->getName() <<endl;
+        EV_LOG(DETAIL) <<" kind is " << kind << ",name is " << msg->getName() <<endl;
         for (unsigned int i = numCategories()-1; (int)i > kind; i--)  //mozna prochaze jen 3..kind XXX
         {
             if (((endBackoff(i)->isScheduled() && endBackoff(i)->getArrivalTime() == simTime())
                     || (endAIFS(i)->isScheduled() && !backoff(i) && endAIFS(i)->getArrivalTime() == simTime()))
                     && !transmissionQueue(i)->empty())
             {
-                EV << "Internal collision AC" << kind << " with AC" << i << endl;
+                EV_LOG(DETAIL) << "Internal collision AC" << kind << " with AC" << i << endl;
                 numInternalCollision++;
-                EV << "Cancel backoff event and schedule new one for AC" << kind << endl;
+                EV_LOG(DETAIL) << "Cancel backoff event and schedule new one for AC" << kind << endl;
                 cancelEvent(endBackoff(kind));
                 if (retryCounter() == transmissionLimit - 1)
                 {
-                    EV << "give up transmission for AC" << currentAC << endl;
+                    EV_LOG(DETAIL) << "give up transmission for AC" << currentAC << endl;
                     giveUpCurrentTransmission();
                 }
                 else
                 {
-                    EV << "retry transmission for AC" << currentAC << endl;
+                    EV_LOG(DETAIL) << "retry transmission for AC" << currentAC << endl;
                     retryCurrentTransmission();
                 }
                 return;
@@ -603,10 +640,11 @@ void Ieee80211Mac::handleSelfMsg(cMessage *msg)
 
 void Ieee80211Mac::handleUpperMsg(cPacket *msg)
 {
-    if (queueModule && numCategories()>1 && (int)transmissionQueueSize() < maxQueueSize)
+    // with EDCA or aggregation, frames are fetched ahead so that they can be prioritized or aggregated
+    if (queueModule && (numCategories()>1 || aggregation) && (int)transmissionQueueSize() < maxQueueSize)
     {
         // the module are continuously asking for packets, except if the queue is full
-        EV << "requesting another frame from queue module\n";
+        EV_LOG(DETAIL) << "requesting another frame from queue module\n";
         queueModule->requestPacket();
     }
 
@@ -622,7 +660,7 @@ void Ieee80211Mac::handleUpperMsg(cPacket *msg)
     if (frame->getByteLength() > fragmentationThreshold)
         error("message from higher layer (%s)%s is too long for 802.11b, %d bytes (fragmentation is not supported yet)",
               msg->getClassName(), msg->getName(), (int)(msg->getByteLength()));
-    EV << "frame " << frame << " received from higher layer, receiver = " << frame->getReceiverAddress() << endl;
+    EV_LOG(DETAIL) << "frame " << frame << " received from higher layer, receiver = " << frame->getReceiverAddress() << endl;
 
     // if you get error from this assert check if is client associated to AP
     ASSERT(!frame->getReceiverAddress().isUnspecified());
@@ -650,7 +688,7 @@ int Ieee80211Mac::mappingAccessCategory(Ieee80211DataOrMgmtFrame *frame)
     // check for queue overflow
     if (isDataFrame && maxQueueSize && (int)transmissionQueueSize() >= maxQueueSize)
     {
-        EV << "message " << frame << " received from higher layer but AC queue is full, dropping message\n";
+        EV_LOG(DETAIL) << "message " << frame << " received from higher layer but AC queue is full, dropping message\n";
         numDropped()++;
         delete frame;
         return 200;
@@ -693,12 +731,16 @@ int Ieee80211Mac::mappingAccessCategory(Ieee80211DataOrMgmtFrame *frame)
             //so for sure we placed it on second place
             p = transmissionQueue()->begin();
             p++;
+            // nor between the frames of an A-MPDU waiting for the Block Ack
+            if (currentAC == oldcurrentAC)
+                for (int i = 1; i < numAggregatedFrames && p != transmissionQueue()->end(); i++)
+                    p++;
             while ((dynamic_cast<Ieee80211DataFrame *> (*p) == NULL) && (p != transmissionQueue()->end())) // search the first not management frame
                 p++;
             transmissionQueue()->insert(p, frame);
         }
     }
-    EV << "frame classified as access category "<< currentAC <<" (0 background, 1 best effort, 2 video, 3 voice)\n";
+    EV_LOG(DETAIL) << "frame classified as access category "<< currentAC <<" (0 background, 1 best effort, 2 video, 3 voice)\n";
     return true;
 }
 
@@ -706,7 +748,7 @@ void Ieee80211Mac::handleCommand(cMessage *msg)
 {
     if (msg->getKind()==PHY_C_CONFIGURERADIO)
     {
-        EV << "Passing on command " << msg->getName() << " to physical layer\n";
+        EV_LOG(DETAIL) << "Passing on command " << msg->getName() << " to physical layer\n";
         if (pendingRadioConfigMsg != NULL)
         {
             // merge contents of the old command into the new one, then delete it
@@ -722,7 +764,7 @@ void Ieee80211Mac::handleCommand(cMessage *msg)
 
         if (fsm.getState() == IDLE || fsm.getState() == DEFER || fsm.getState() == BACKOFF)
         {
-            EV << "Sending it down immediately\n";
+            EV_LOG(DETAIL) << "Sending it down immediately\n";
 /*
 // Dynamic power
             PhyControlInfo *phyControlInfo = dynamic_cast<PhyControlInfo *>(msg->getControlInfo());
@@ -734,7 +776,7 @@ void Ieee80211Mac::handleCommand(cMessage *msg)
         }
         else
         {
-            EV << "Delaying " << msg->getName() << " until next IDLE or DEFER state\n";
+            EV_LOG(DETAIL) << "Delaying " << msg->getName() << " until next IDLE or DEFER state\n";
             pendingRadioConfigMsg = msg;
         }
     }
@@ -746,8 +788,8 @@ void Ieee80211Mac::handleCommand(cMessage *msg)
 
 void Ieee80211Mac::handleLowerMsg(cPacket *msg)
 {
-    EV<<"->Enter handleLowerMsg...\n";
-    EV << "received message from lower layer: " << msg << endl;
+    EV_LOG(DETAIL) <<"->Enter handleLowerMsg...\n";
+    EV_LOG(DETAIL) << "received message from lower layer: " << msg << endl;
     Radio80211aControlInfo * cinfo = dynamic_cast<Radio80211aControlInfo *>(msg->getControlInfo());
     if (cinfo && cinfo->getAirtimeMetric())
     {
@@ -812,13 +854,13 @@ void Ieee80211Mac::handleLowerMsg(cPacket *msg)
 
     if (!frame)
     {
-        EV << "message from physical layer (%s)%s is not a subclass of Ieee80211Frame" << msg->getClassName() << " " << msg->getName() <<  endl;
+        EV_LOG(DETAIL) << "message from physical layer (%s)%s is not a subclass of Ieee80211Frame" << msg->getClassName() << " " << msg->getName() <<  endl;
         delete msg;
         return;
         // error("message from physical layer (%s)%s is not a subclass of Ieee80211Frame",msg->getClassName(), msg->getName());
     }
 
-    EV << "Self address: " << address
+    EV_LOG(DETAIL) << "Self address: " << address
     << ", receiver address: " << frame->getReceiverAddress()
     << ", received frame is for us: " << isForUs(frame)
     << ", received frame was sent by us: " << isSentByUs(frame)<<endl;
@@ -831,7 +873,7 @@ void Ieee80211Mac::handleLowerMsg(cPacket *msg)
     // if we are the owner then we did not send this message up
     if (msg->getOwner() == this)
         delete msg;
-    EV<<"Leave handleLowerMsg...\n";
+    EV_LOG(DETAIL) <<"Leave handleLowerMsg...\n";
 }
 
 void Ieee80211Mac::receiveChangeNotification(int category, const cObject *details)
@@ -888,14 +930,14 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
             scheduleAt(endBackoff(numCategories()-1)->getArrivalTime(), endBackoff(currentAC));
             cancelEvent(endBackoff(numCategories()-1));
         }
-        EV << "deferring upper message transmission in " << fsm.getStateName() << " state\n";
+        EV_LOG(DETAIL) << "deferring upper message transmission in " << fsm.getStateName() << " state\n";
         return;
     }
 
     // Special case, is  endTimeout ACK and the radio state  is RECV, the system must wait until end reception (9.3.2.8 ACK procedure)
     if (msg == endTimeout && radioState == RadioState::RECV && useModulationParameters && fsm.getState() == WAITACK)
     {
-        EV << "Re-schedule WAITACK timeout \n";
+        EV_LOG(DETAIL) << "Re-schedule WAITACK timeout \n";
         scheduleAt(simTime() + controlFrameTxTime(LENGTH_ACK), endTimeout);
         return;
     }
@@ -1172,6 +1214,29 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                                   if (endTXOP->isScheduled()) cancelEvent(endTXOP);
                                  );
 #endif
+            FSMA_Event_Transition(Receive-BlockAck-Failed,
+                                  isLowerMsg(msg) && isForUs(frame) && frameType == ST_BLOCKACK && numAggregatedFrames > 0
+                                  && retryCounter(oldcurrentAC) == transmissionLimit - 1
+                                  && !isAggregateAcked(check_and_cast<Ieee80211BlockAckFrame *>(frame)),
+                                  IDLE,
+                                  currentAC = oldcurrentAC;
+                                  cancelTimeoutPeriod();
+                                  finishAggregateTransmission(check_and_cast<Ieee80211BlockAckFrame *>(frame));
+                                  giveUpCurrentTransmission();
+                                 );
+            FSMA_Event_Transition(Receive-BlockAck,
+                                  isLowerMsg(msg) && isForUs(frame) && frameType == ST_BLOCKACK && numAggregatedFrames > 0,
+                                  DEFER,
+                                  currentAC = oldcurrentAC;
+                                  cancelTimeoutPeriod();
+                                  if (finishAggregateTransmission(check_and_cast<Ieee80211BlockAckFrame *>(frame)))
+                                  {
+                                      resetStateVariables();
+                                      resetCurrentBackOff();
+                                  }
+                                  else
+                                      retryCurrentTransmission();
+                                 );
             FSMA_Event_Transition(Receive-ACK-TXOP-Empty,
                                   isLowerMsg(msg) && isForUs(frame) && frameType == ST_ACK && txop && transmissionQueue(oldcurrentAC)->size() == 1,
                                   DEFER,
@@ -1186,7 +1251,7 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                                       maxJitter() = simTime() - fr->getMACArrive();
                                   if (minJitter() == SIMTIME_ZERO || minJitter() > (simTime() - fr->getMACArrive()))
                                       minJitter() = simTime() - fr->getMACArrive();
-                                  EV << "record macDelay AC" << currentAC << " value " << simTime() - fr->getMACArrive() <<endl;
+                                  EV_LOG(DETAIL) << "record macDelay AC" << currentAC << " value " << simTime() - fr->getMACArrive() <<endl;
                                   numSentTXOP++;
                                   cancelTimeoutPeriod();
                                   finishCurrentTransmission();
@@ -1210,7 +1275,7 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                                       maxJitter() = simTime() - fr->getMACArrive();
                                   if (minJitter() == SIMTIME_ZERO || minJitter() > (simTime() - fr->getMACArrive()))
                                       minJitter() = simTime() - fr->getMACArrive();
-                                  EV << "record macDelay AC" << currentAC << " value " << simTime() - fr->getMACArrive() <<endl;
+                                  EV_LOG(DETAIL) << "record macDelay AC" << currentAC << " value " << simTime() - fr->getMACArrive() <<endl;
                                   numSentTXOP++;
                                   cancelTimeoutPeriod();
                                   finishCurrentTransmission();
@@ -1229,7 +1294,7 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                                   macDelay[currentAC].record(simTime() - fr->getMACArrive());
                                   if (maxjitter[currentAC] == 0 || maxjitter[currentAC] < (simTime() - fr->getMACArrive())) maxjitter[currentAC]=simTime() - fr->getMACArrive();
                                       if (minjitter[currentAC] == 0 || minjitter[currentAC] > (simTime() - fr->getMACArrive())) minjitter[currentAC]=simTime() - fr->getMACArrive();
-                                          EV << "record macDelay AC" << currentAC << " value " << simTime() - fr->getMACArrive() <<endl;
+                                          EV_LOG(DETAIL) << "record macDelay AC" << currentAC << " value " << simTime() - fr->getMACArrive() <<endl;
 
                                           cancelTimeoutPeriod();
                                           finishCurrentTransmission();
@@ -1253,7 +1318,7 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                                       maxJitter() = simTime() - fr->getMACArrive();
                                   if (minJitter() == SIMTIME_ZERO || minJitter() > (simTime() - fr->getMACArrive()))
                                       minJitter() = simTime() - fr->getMACArrive();
-                                  EV << "record macDelay AC" << currentAC << " value " << simTime() - fr->getMACArrive() <<endl;
+                                  EV_LOG(DETAIL) << "record macDelay AC" << currentAC << " value " << simTime() - fr->getMACArrive() <<endl;
                                   cancelTimeoutPeriod();
                                   finishCurrentTransmission();
                                   resetCurrentBackOff();
@@ -1378,6 +1443,12 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                                   sendDataFrameOnEndSIFS(getCurrentTransmission());
                                   oldcurrentAC = currentAC;
                                  );
+            FSMA_Event_Transition(Transmit-BlockAck,
+                                  msg == endSIFS && getFrameReceivedBeforeSIFS()->getType() == ST_AMPDU,
+                                  IDLE,
+                                  sendBlockAckFrameOnEndSIFS();
+                                  finishReception();
+                                  );
             FSMA_Event_Transition(Transmit-ACK,
                                   msg == endSIFS && isDataOrMgmtFrame(getFrameReceivedBeforeSIFS()),
                                   IDLE,
@@ -1391,7 +1462,7 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
             FSMA_No_Event_Transition(Immediate-Receive-Error,
                                      isLowerMsg(msg) && (msgKind == COLLISION || msgKind == BITERROR),
                                      IDLE,
-                                     EV << "received frame contains bit errors or collision, next wait period is EIFS\n";
+                                     EV_LOG(DETAIL) << "received frame contains bit errors or collision, next wait period is EIFS\n";
                                      numCollision++;
                                      finishReception();
                                      );
@@ -1402,6 +1473,11 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                                      numReceivedMulticast++;
                                      finishReception();
                                      );
+            FSMA_No_Event_Transition(Immediate-Receive-Aggregate,
+                                     isLowerMsg(msg) && isForUs(frame) && frameType == ST_AMPDU,
+                                     WAITSIFS,
+                                     receiveAggregateFrame(check_and_cast<Ieee80211AMPDUFrame *>(frame));
+                                    );
             FSMA_No_Event_Transition(Immediate-Receive-Data,
                                      isLowerMsg(msg) && isForUs(frame) && isDataOrMgmtFrame(frame),
                                      WAITSIFS,
@@ -1432,7 +1508,7 @@ void Ieee80211Mac::handleWithFSM(cMessage *msg)
                                      );
         }
     }
-    EV<<"leaving handleWithFSM\n\t";
+    EV_LOG(DETAIL) <<"leaving handleWithFSM\n\t";
     logState();
     stateVector.record(fsm.getState());
     if (simTime() - last > 0.1)
@@ -1468,29 +1544,39 @@ void Ieee80211Mac::finishReception()
 /****************************************************************
  * Timing functions.
  */
-simtime_t Ieee80211Mac::getSIFS()
+void Ieee80211Mac::updateTimingParameters()
 {
-// TODO:   return aRxRFDelay() + aRxPLCPDelay() + aMACProcessingDelay() + aRxTxTurnaroundTime();
+// TODO:   SIFS = aRxRFDelay() + aRxPLCPDelay() + aMACProcessingDelay() + aRxTxTurnaroundTime();
+// TODO:   slot time = aCCATime() + aRxTxTurnaroundTime + aAirPropagationTime() + aMACProcessingDelay();
     if (useModulationParameters)
     {
         ModulationType modType;
         modType = WifiModulationType::getModulationType(opMode, bitrate);
-        return WifiModulationType::getSifsTime(modType,wifiPreambleType);
+        sifs = WifiModulationType::getSifsTime(modType,wifiPreambleType);
+        slotTime = WifiModulationType::getSlotDuration(modType,wifiPreambleType);
+    }
+    else
+    {
+        sifs = SIFS;
+        slotTime = ST;
     }
 
-    return SIFS;
+    aifs.resize(numCategories());
+    for (int i = 0; i < numCategories(); i++)
+        aifs[i] = sifs + ((double)AIFSN(i)) * slotTime;
+
+// FIXME:   EIFS = SIFS + DIFS + (8 * ACKSize + aPreambleLength + aPLCPHeaderLength) / lowestDatarate;
+    eifs = sifs + getDIFS() + controlFrameTxTime(LENGTH_ACK);
+}
+
+simtime_t Ieee80211Mac::getSIFS()
+{
+    return sifs;
 }
 
 simtime_t Ieee80211Mac::getSlotTime()
 {
-// TODO:   return aCCATime() + aRxTxTurnaroundTime + aAirPropagationTime() + aMACProcessingDelay();
-    if (useModulationParameters)
-    {
-        ModulationType modType;
-        modType = WifiModulationType::getModulationType(opMode, bitrate);
-        return WifiModulationType::getSlotDuration(modType,wifiPreambleType);
-    }
-    return ST;
+    return slotTime;
 }
 
 simtime_t Ieee80211Mac::getPIFS()
@@ -1501,42 +1587,31 @@ simtime_t Ieee80211Mac::getPIFS()
 simtime_t Ieee80211Mac::getDIFS(int category)
 {
     if (category<0 || category>(numCategories()-1))
-    {
-        int index = numCategories()-1;
-        if (index<0)
-            index = 0;
-        return getSIFS() + ((double)AIFSN(index) * getSlotTime());
-    }
+        return aifs.back();
     else
-    {
-        return getSIFS() + ((double)AIFSN(category)) * getSlotTime();
-    }
-
+        return aifs[category];
 }
 
 simtime_t Ieee80211Mac::getHeaderTime(double bitrate)
 {
-    ModulationType modType;
-    modType = WifiModulationType::getModulationType(opMode, bitrate);
-    return WifiModulationType::getPreambleAndHeader(modType, wifiPreambleType);
+    return getDurationTable(bitrate).headerTime;
 }
 
 simtime_t Ieee80211Mac::getAIFS(int AccessCategory)
 {
-    return AIFSN(AccessCategory) * getSlotTime() + getSIFS();
+    return aifs[AccessCategory];
 }
 
 simtime_t Ieee80211Mac::getEIFS()
 {
-// FIXME:   return getSIFS() + getDIFS() + (8 * ACKSize + aPreambleLength + aPLCPHeaderLength) / lowestDatarate;
-    return getSIFS() + getDIFS() + controlFrameTxTime(LENGTH_ACK);
+    return eifs;
 }
 
 simtime_t Ieee80211Mac::computeBackoffPeriod(Ieee80211Frame *msg, int r)
 {
     int cw;
 
-    EV << "generating backoff slot number for retry: " << r << endl;
+    EV_LOG(DETAIL) << "generating backoff slot number for retry: " << r << endl;
     if (msg && isMulticast(msg))
         cw = cwMinMulticast;
     else
@@ -1551,7 +1626,7 @@ simtime_t Ieee80211Mac::computeBackoffPeriod(Ieee80211Frame *msg, int r)
 
     int c = intrand(cw + 1);
 
-    EV << "generated backoff slot number: " << c << " , cw: " << cw << " ,cwMin:cwMax = " << cwMin() << ":" << cwMax() << endl;
+    EV_LOG(DETAIL) << "generated backoff slot number: " << c << " , cw: " << cw << " ,cwMin:cwMax = " << cwMin() << ":" << cwMax() << endl;
 
     return ((double)c) * getSlotTime();
 }
@@ -1561,7 +1636,7 @@ simtime_t Ieee80211Mac::computeBackoffPeriod(Ieee80211Frame *msg, int r)
  */
 void Ieee80211Mac::scheduleSIFSPeriod(Ieee80211Frame *frame)
 {
-    EV << "scheduling SIFS period\n";
+    EV_LOG(DETAIL) << "scheduling SIFS period\n";
     endSIFS->setContextPointer(frame->dup());
     scheduleAt(simTime() + getSIFS(), endSIFS);
 }
@@ -1570,19 +1645,19 @@ void Ieee80211Mac::scheduleDIFSPeriod()
 {
     if (lastReceiveFailed)
     {
-        EV << "reception of last frame failed, scheduling EIFS period\n";
+        EV_LOG(DETAIL) << "reception of last frame failed, scheduling EIFS period\n";
         scheduleAt(simTime() + getEIFS(), endDIFS);
     }
     else
     {
-        EV << "scheduling DIFS period\n";
+        EV_LOG(DETAIL) << "scheduling DIFS period\n";
         scheduleAt(simTime() + getDIFS(), endDIFS);
     }
 }
 
 void Ieee80211Mac::cancelDIFSPeriod()
 {
-    EV << "canceling DIFS period\n";
+    EV_LOG(DETAIL) << "canceling DIFS period\n";
     cancelEvent(endDIFS);
 }
 
@@ -1596,12 +1671,12 @@ void Ieee80211Mac::scheduleAIFSPeriod()
 
             if (lastReceiveFailed)
             {
-                EV << "reception of last frame failed, scheduling EIFS-DIFS+AIFS period (" << i << ")\n";
+                EV_LOG(DETAIL) << "reception of last frame failed, scheduling EIFS-DIFS+AIFS period (" << i << ")\n";
                 scheduleAt(simTime() + getEIFS() - getDIFS() + getAIFS(i), endAIFS(i));
             }
             else
             {
-                EV << "scheduling AIFS period (" << i << ")\n";
+                EV_LOG(DETAIL) << "scheduling AIFS period (" << i << ")\n";
                 scheduleAt(simTime() + getAIFS(i), endAIFS(i));
             }
 
@@ -1620,14 +1695,14 @@ void Ieee80211Mac::scheduleAIFSPeriod()
 void Ieee80211Mac::rescheduleAIFSPeriod(int AccessCategory)
 {
     ASSERT(1);
-    EV << "rescheduling AIFS[" << AccessCategory << "]\n";
+    EV_LOG(DETAIL) << "rescheduling AIFS[" << AccessCategory << "]\n";
     cancelEvent(endAIFS(AccessCategory));
     scheduleAt(simTime() + getAIFS(AccessCategory), endAIFS(AccessCategory));
 }
 
 void Ieee80211Mac::cancelAIFSPeriod()
 {
-    EV << "canceling AIFS period\n";
+    EV_LOG(DETAIL) << "canceling AIFS period\n";
     for (int i = 0; i<numCategories(); i++)
         cancelEvent(endAIFS(i));
     cancelEvent(endDIFS);
@@ -1651,20 +1726,20 @@ void Ieee80211Mac::scheduleDataTimeoutPeriod(Ieee80211DataOrMgmtFrame *frameToSe
     }
     if (!endTimeout->isScheduled())
     {
-        EV << "scheduling data timeout period\n";
+        EV_LOG(DETAIL) << "scheduling data timeout period\n";
+        // an A-MPDU is answered by a Block Ack instead of an ACK
+        bool isAggregate = numAggregatedFrames > 0;
         if (useModulationParameters)
         {
-            ModulationType modType;
-            modType = WifiModulationType::getModulationType(opMode, bitRate);
-            double duration = computeFrameDuration(frameToSend);
-            double slot = SIMTIME_DBL(WifiModulationType::getSlotDuration(modType,wifiPreambleType));
-            double sifs =  SIMTIME_DBL(WifiModulationType::getSifsTime(modType,wifiPreambleType));
-            double PHY_RX_START = SIMTIME_DBL(WifiModulationType::get_aPHY_RX_START_Delay (modType,wifiPreambleType));
-            tim = duration + slot + sifs + PHY_RX_START;
+            const DurationTable& table = getDurationTable(bitRate);
+            double duration = isAggregate ? aggregateTxDuration : computeFrameDuration(frameToSend);
+            tim = duration + table.slotTime + table.sifs + table.phyRxStartDelay;
         }
+        else if (isAggregate)
+            tim = aggregateTxDuration + SIMTIME_DBL(getSlotTime()) + SIMTIME_DBL(getSIFS()) + controlFrameTxTime(LENGTH_BLOCKACK) + MAX_PROPAGATION_DELAY * 2;
         else
             tim = computeFrameDuration(frameToSend) + SIMTIME_DBL( getSlotTime()) +SIMTIME_DBL( getSIFS()) + controlFrameTxTime(LENGTH_ACK) + MAX_PROPAGATION_DELAY * 2;
-        EV<<" time out="<<tim*1e6<<"us"<<endl;
+        EV_LOG(DETAIL) <<" time out="<<tim*1e6<<"us"<<endl;
         scheduleAt(simTime() + tim, endTimeout);
     }
 }
@@ -1673,14 +1748,14 @@ void Ieee80211Mac::scheduleMulticastTimeoutPeriod(Ieee80211DataOrMgmtFrame *fram
 {
     if (!endTimeout->isScheduled())
     {
-        EV << "scheduling multicast timeout period\n";
+        EV_LOG(DETAIL) << "scheduling multicast timeout period\n";
         scheduleAt(simTime() + computeFrameDuration(frameToSend), endTimeout);
     }
 }
 
 void Ieee80211Mac::cancelTimeoutPeriod()
 {
-    EV << "canceling timeout period\n";
+    EV_LOG(DETAIL) << "canceling timeout period\n";
     cancelEvent(endTimeout);
 }
 
@@ -1688,7 +1763,7 @@ void Ieee80211Mac::scheduleCTSTimeoutPeriod()
 {
     if (!endTimeout->isScheduled())
     {
-        EV << "scheduling CTS timeout period\n";
+        EV_LOG(DETAIL) << "scheduling CTS timeout period\n";
         scheduleAt(simTime() + controlFrameTxTime(LENGTH_RTS) + getSIFS()
                    + controlFrameTxTime(LENGTH_CTS) + MAX_PROPAGATION_DELAY * 2, endTimeout);
     }
@@ -1717,7 +1792,7 @@ void Ieee80211Mac::scheduleReservePeriod(Ieee80211Frame *frame)
             scheduleAt(simTime(), mediumStateChange);
         }
 
-        EV << "scheduling reserve period for: " << reserve << endl;
+        EV_LOG(DETAIL) << "scheduling reserve period for: " << reserve << endl;
 
         ASSERT(reserve > 0);
 
@@ -1740,7 +1815,7 @@ void Ieee80211Mac::generateBackoffPeriod()
 {
     backoffPeriod() = computeBackoffPeriod(getCurrentTransmission(), retryCounter());
     ASSERT(backoffPeriod() >= SIMTIME_ZERO);
-    EV << "backoff period set to " << backoffPeriod()<< endl;
+    EV_LOG(DETAIL) << "backoff period set to " << backoffPeriod()<< endl;
 }
 
 void Ieee80211Mac::decreaseBackoffPeriod()
@@ -1752,26 +1827,26 @@ void Ieee80211Mac::decreaseBackoffPeriod()
     {
         if (backoff(i) && endBackoff(i)->isScheduled())
         {
-            EV<< "old backoff[" << i << "] is " << backoffPeriod(i) << ", sim time is " << simTime()
+            EV_LOG(DETAIL) << "old backoff[" << i << "] is " << backoffPeriod(i) << ", sim time is " << simTime()
             << ", endbackoff sending period is " << endBackoff(i)->getSendingTime() << endl;
             simtime_t elapsedBackoffTime = simTime() - endBackoff(i)->getSendingTime();
             backoffPeriod(i) -= ((int)(elapsedBackoffTime / getSlotTime())) * getSlotTime();
-            EV << "actual backoff[" << i << "] is " <<backoffPeriod(i) << ", elapsed is " << elapsedBackoffTime << endl;
+            EV_LOG(DETAIL) << "actual backoff[" << i << "] is " <<backoffPeriod(i) << ", elapsed is " << elapsedBackoffTime << endl;
             ASSERT(backoffPeriod(i) >= SIMTIME_ZERO);
-            EV << "backoff[" << i << "] period decreased to " << backoffPeriod(i) << endl;
+            EV_LOG(DETAIL) << "backoff[" << i << "] period decreased to " << backoffPeriod(i) << endl;
         }
     }
 }
 
 void Ieee80211Mac::scheduleBackoffPeriod()
 {
-    EV << "scheduling backoff period\n";
+    EV_LOG(DETAIL) << "scheduling backoff period\n";
     scheduleAt(simTime() + backoffPeriod(), endBackoff());
 }
 
 void Ieee80211Mac::cancelBackoffPeriod()
 {
-    EV << "cancelling Backoff period - only if some is scheduled\n";
+    EV_LOG(DETAIL) << "cancelling Backoff period - only if some is scheduled\n";
     for (int i = 0; i<numCategories(); i++)
         cancelEvent(endBackoff(i));
 }
@@ -1789,7 +1864,7 @@ void Ieee80211Mac::sendACKFrameOnEndSIFS()
 
 void Ieee80211Mac::sendACKFrame(Ieee80211DataOrMgmtFrame *frameToACK)
 {
-    EV << "sending ACK frame\n";
+    EV_LOG(DETAIL) << "sending ACK frame\n";
     numAckSend++;
     sendDown(setControlBitrate(buildACKFrame(frameToACK)));
 }
@@ -1810,6 +1885,19 @@ void Ieee80211Mac::sendDataFrame(Ieee80211DataOrMgmtFrame *frameToSend)
 
     frame = transmissionQueue()->begin();
     ASSERT(*frame==frameToSend);
+    numAggregatedFrames = 0;
+    if (aggregation && !txop)
+    {
+        // an A-MPDU takes the place of the TXOP burst
+        Ieee80211AMPDUFrame *aggregate = buildAggregateFrame();
+        if (aggregate)
+        {
+            EV_LOG(DETAIL) << "sending A-MPDU with " << numAggregatedFrames << " frames\n";
+            numSentAggregates++;
+            sendDown(aggregate);
+            return;
+        }
+    }
     if (!txop && TXOP() > 0 && transmissionQueue()->size() >= 2 )
     {
         //we start packet burst within TXOP time period
@@ -1819,11 +1907,11 @@ void Ieee80211Mac::sendDataFrame(Ieee80211DataOrMgmtFrame *frameToSend)
         {
             count++;
             t = computeFrameDuration(*frame) + 2 * getSIFS() + controlFrameTxTime(LENGTH_ACK);
-            EV << "t is " << t << endl;
+            EV_LOG(DETAIL) << "t is " << t << endl;
             if (TXOP()>time+t)
             {
                 time += t;
-                EV << "adding t \n";
+                EV_LOG(DETAIL) << "adding t \n";
             }
             else
             {
@@ -1832,27 +1920,57 @@ void Ieee80211Mac::sendDataFrame(Ieee80211DataOrMgmtFrame *frameToSend)
         }
         //to be sure we get endTXOP earlier then receive ACK and we have to minus SIFS time from first packet
         time -= getSIFS()/2 + getSIFS();
-        EV << "scheduling TXOP for AC" << currentAC << ", duration is " << time << ",count is " << count << endl;
+        EV_LOG(DETAIL) << "scheduling TXOP for AC" << currentAC << ", duration is " << time << ",count is " << count << endl;
         scheduleAt(simTime() + time, endTXOP);
     }
-    EV << "sending Data frame\n";
+    EV_LOG(DETAIL) << "sending Data frame\n";
     sendDown(buildDataFrame(dynamic_cast<Ieee80211DataOrMgmtFrame*>(setBitrateFrame(frameToSend))));
 }
 
 void Ieee80211Mac::sendRTSFrame(Ieee80211DataOrMgmtFrame *frameToSend)
 {
-    EV << "sending RTS frame\n";
+    EV_LOG(DETAIL) << "sending RTS frame\n";
     sendDown(setControlBitrate(buildRTSFrame(frameToSend)));
 }
 
 void Ieee80211Mac::sendMulticastFrame(Ieee80211DataOrMgmtFrame *frameToSend)
 {
-    EV << "sending Multicast frame\n";
+    EV_LOG(DETAIL) << "sending Multicast frame\n";
     if (frameToSend->getControlInfo())
         delete frameToSend->removeControlInfo();
     sendDown(buildDataFrame(dynamic_cast<Ieee80211DataOrMgmtFrame*>(setBasicBitrate(frameToSend))));
 }
 
+void Ieee80211Mac::sendDown(cMessage *msg)
+{
+    // the channel delivers unicast frames header-only to radios with another address
+    Ieee80211Frame *frame = headerOnlyOverhearing ? dynamic_cast<Ieee80211Frame *>(msg) : NULL;
+    if (frame && !isMulticast(frame))
+    {
+        if (!frame->getControlInfo())
+            frame->setControlInfo(new PhyControlInfo());
+        PhyControlInfo *ctrl = dynamic_cast<PhyControlInfo *>(frame->getControlInfo());
+        if (ctrl)
+            ctrl->setReceiverAddress(frame->getReceiverAddress());
+    }
+    WirelessMacBase::sendDown(msg);
+}
+
+void Ieee80211Mac::sendBlockAckFrameOnEndSIFS()
+{
+    Ieee80211Frame *aggregate = (Ieee80211Frame *)endSIFS->getContextPointer();
+    endSIFS->setContextPointer(NULL);
+    sendBlockAckFrame(check_and_cast<Ieee80211AMPDUFrame*>(aggregate));
+    delete aggregate;
+}
+
+void Ieee80211Mac::sendBlockAckFrame(Ieee80211AMPDUFrame *aggregate)
+{
+    EV_LOG(DETAIL) << "sending Block Ack frame\n";
+    numBlockAckSend++;
+    sendDown(setControlBitrate(buildBlockAckFrame(aggregate)));
+}
+
 void Ieee80211Mac::sendCTSFrameOnEndSIFS()
 {
     Ieee80211Frame *rtsFrame = (Ieee80211Frame *)endSIFS->getContextPointer();
@@ -1863,7 +1981,7 @@ void Ieee80211Mac::sendCTSFrameOnEndSIFS()
 
 void Ieee80211Mac::sendCTSFrame(Ieee80211RTSFrame *rtsFrame)
 {
-    EV << "sending CTS frame\n";
+    EV_LOG(DETAIL) << "sending CTS frame\n";
     sendDown(setControlBitrate(buildCTSFrame(rtsFrame)));
 }
 
@@ -1956,7 +2074,7 @@ Ieee80211DataOrMgmtFrame *Ieee80211Mac::buildMulticastFrame(Ieee80211DataOrMgmtF
     PhyControlInfo *phyControlInfo_old = dynamic_cast<PhyControlInfo *>( frameToSend->getControlInfo() );
     if (phyControlInfo_old)
     {
-        EV<<"Per frame1 params"<<endl;
+        EV_LOG(DETAIL) <<"Per frame1 params"<<endl;
         PhyControlInfo *phyControlInfo_new = new PhyControlInfo;
         *phyControlInfo_new = *phyControlInfo_old;
         //EV<<"PhyControlInfo bitrate "<<phyControlInfo->getBitrate()/1e6<<"Mbps txpower "<<phyControlInfo->txpower()<<"mW"<<endl;
@@ -1967,6 +2085,71 @@ Ieee80211DataOrMgmtFrame *Ieee80211Mac::buildMulticastFrame(Ieee80211DataOrMgmtF
     return frame;
 }
 
+Ieee80211AMPDUFrame *Ieee80211Mac::buildAggregateFrame()
+{
+    Ieee80211DataOrMgmtFrame *head = transmissionQueue()->front();
+    if (isMulticast(head) || head->getMoreFragments())
+        return NULL;
+
+    // take the data frames from the front of the queue while they go to the
+    // same receiver and fit into the Block Ack window and the size limits
+    int count = 0;
+    int64 length = 0;
+    for (Ieee80211DataOrMgmtFrameList::iterator it = transmissionQueue()->begin(); it != transmissionQueue()->end() && count < maxAggregateFrames; ++it)
+    {
+        Ieee80211DataOrMgmtFrame *frame = *it;
+        if (frame->getType() != ST_DATA || frame->getReceiverAddress() != head->getReceiverAddress())
+            break;
+        if ((frame->getSequenceNumber() - head->getSequenceNumber() + 4096) % 4096 >= BLOCKACK_WINDOW_SIZE)
+            break;
+        int64 subframeLength = Ieee80211AMPDUFrame::getSubframeByteLength(frame);
+        if (length + subframeLength > maxAggregateBytes)
+            break;
+        length += subframeLength;
+        count++;
+    }
+    if (count < 2)
+        return NULL;
+
+    Ieee80211AMPDUFrame *aggregate = new Ieee80211AMPDUFrame("wlan-ampdu");
+    aggregate->setReceiverAddress(head->getReceiverAddress());
+    aggregate->setTransmitterAddress(address);
+    aggregate->setStartingSequenceNumber(head->getSequenceNumber());
+    aggregate->setDuration(getSIFS() + controlFrameTxTime(LENGTH_BLOCKACK));
+    Ieee80211DataOrMgmtFrameList::iterator it = transmissionQueue()->begin();
+    for (int i = 0; i < count; i++, ++it)
+    {
+        // dup() does not copy the control info
+        Ieee80211DataOrMgmtFrame *frame = (*it)->dup();
+        frame->setDuration(aggregate->getDuration());
+        aggregate->addSubframe(frame);
+    }
+    setBitrateFrame(aggregate);
+
+    double bitRate = bitrate;
+    PhyControlInfo *ctrl = dynamic_cast<PhyControlInfo *>(aggregate->getControlInfo());
+    if (ctrl && ctrl->getBitrate() != 0)
+        bitRate = ctrl->getBitrate();
+    aggregateTxDuration = computeFrameDuration(aggregate->getBitLength(), bitRate);
+    numAggregatedFrames = count;
+    return aggregate;
+}
+
+Ieee80211BlockAckFrame *Ieee80211Mac::buildBlockAckFrame(Ieee80211AMPDUFrame *aggregate)
+{
+    Ieee80211BlockAckFrame *frame = new Ieee80211BlockAckFrame("wlan-blockack");
+    frame->setReceiverAddress(aggregate->getTransmitterAddress());
+    frame->setTransmitterAddress(address);
+    frame->setDuration(0);
+
+    BlockAckRecordMap::iterator it = blockAckRecords.find(aggregate->getTransmitterAddress());
+    ASSERT(it != blockAckRecords.end());
+    frame->setStartingSequenceNumber(it->second.startingSequenceNumber);
+    frame->setBitmap(it->second.bitmap);
+
+    return frame;
+}
+
 Ieee80211Frame *Ieee80211Mac::setBasicBitrate(Ieee80211Frame *frame)
 {
     ASSERT(frame->getControlInfo()==NULL);
@@ -2018,17 +2201,26 @@ void Ieee80211Mac::finishCurrentTransmission()
 
 void Ieee80211Mac::giveUpCurrentTransmission()
 {
-    Ieee80211DataOrMgmtFrame *temp = (Ieee80211DataOrMgmtFrame*) transmissionQueue()->front();
-    nb->fireChangeNotification(NF_LINK_BREAK, temp);
-    popTransmissionQueue();
+    // the other frames of an A-MPDU have been tried as many times as the first one
+    int numFrames = numAggregatedFrames > 0 ? numAggregatedFrames : 1;
+    numAggregatedFrames = 0;
+    for (int i = 0; i < numFrames; i++)
+    {
+        Ieee80211DataOrMgmtFrame *temp = (Ieee80211DataOrMgmtFrame*) transmissionQueue()->front();
+        nb->fireChangeNotification(NF_LINK_BREAK, temp);
+        popTransmissionQueue();
+        numGivenUp()++;
+    }
     resetStateVariables();
-    numGivenUp()++;
 }
 
 void Ieee80211Mac::retryCurrentTransmission()
 {
     ASSERT(retryCounter() < transmissionLimit - 1);
     getCurrentTransmission()->setRetry(true);
+    Ieee80211DataOrMgmtFrameList::iterator it = transmissionQueue()->begin();
+    for (int i = 0; i < numAggregatedFrames; i++, ++it)
+        (*it)->setRetry(true);
     if (rateControlMode == RATE_AARF || rateControlMode == RATE_ARF)
         reportDataFailed();
     else
@@ -2038,6 +2230,99 @@ void Ieee80211Mac::retryCurrentTransmission()
     generateBackoffPeriod();
 }
 
+bool Ieee80211Mac::isAckedByBlockAck(Ieee80211DataOrMgmtFrame *frame, Ieee80211BlockAckFrame *blockAck)
+{
+    int offset = (frame->getSequenceNumber() - blockAck->getStartingSequenceNumber() + 4096) % 4096;
+    return offset < BLOCKACK_WINDOW_SIZE && ((blockAck->getBitmap() >> offset) & 1) != 0;
+}
+
+bool Ieee80211Mac::isAggregateAcked(Ieee80211BlockAckFrame *blockAck)
+{
+    Ieee80211DataOrMgmtFrameList::iterator it = transmissionQueue(oldcurrentAC)->begin();
+    for (int i = 0; i < numAggregatedFrames; i++, ++it)
+        if (!isAckedByBlockAck(*it, blockAck))
+            return false;
+    return true;
+}
+
+bool Ieee80211Mac::finishAggregateTransmission(Ieee80211BlockAckFrame *blockAck)
+{
+    int numLeft = 0;
+    Ieee80211DataOrMgmtFrameList::iterator it = transmissionQueue()->begin();
+    for (int i = 0; i < numAggregatedFrames; i++)
+    {
+        Ieee80211DataOrMgmtFrame *frame = *it;
+        if (!isAckedByBlockAck(frame, blockAck))
+        {
+            // stays in the queue, in front of the frames not sent yet
+            numLeft++;
+            ++it;
+            continue;
+        }
+        if (retryCounter() == 0)
+            numSentWithoutRetry()++;
+        numSent()++;
+        numBits += frame->getBitLength();
+        bits() += frame->getBitLength();
+        simtime_t delay = simTime() - frame->getMACArrive();
+        macDelay()->record(delay);
+        if (maxJitter() == SIMTIME_ZERO || maxJitter() < delay)
+            maxJitter() = delay;
+        if (minJitter() == SIMTIME_ZERO || minJitter() > delay)
+            minJitter() = delay;
+        removeFromTransmissionQueue(it++);
+    }
+    EV_LOG(DETAIL) << "Block Ack acknowledged " << numAggregatedFrames - numLeft << " of " << numAggregatedFrames << " frames\n";
+    numAggregatedFrames = numLeft;
+    return numLeft == 0;
+}
+
+void Ieee80211Mac::receiveAggregateFrame(Ieee80211AMPDUFrame *aggregate)
+{
+    // the originator never sends frames before the starting sequence number
+    // again, so the window is moved there and older bits are dropped
+    int startingSequenceNumber = aggregate->getStartingSequenceNumber();
+    BlockAckRecordMap::iterator it = blockAckRecords.find(aggregate->getTransmitterAddress());
+    if (it == blockAckRecords.end())
+    {
+        BlockAckRecord record;
+        record.startingSequenceNumber = startingSequenceNumber;
+        record.bitmap = 0;
+        it = blockAckRecords.insert(std::make_pair(aggregate->getTransmitterAddress(), record)).first;
+    }
+    else
+    {
+        BlockAckRecord& record = it->second;
+        int shift = (startingSequenceNumber - record.startingSequenceNumber + 4096) % 4096;
+        record.bitmap = shift < BLOCKACK_WINDOW_SIZE ? record.bitmap >> shift : 0;
+        record.startingSequenceNumber = startingSequenceNumber;
+    }
+
+    BlockAckRecord& record = it->second;
+    for (unsigned int i = 0; i < aggregate->getNumSubframes(); i++)
+    {
+        Ieee80211DataOrMgmtFrame *frame = aggregate->removeSubframe(i);
+        int offset = (frame->getSequenceNumber() - startingSequenceNumber + 4096) % 4096;
+        if (offset < BLOCKACK_WINDOW_SIZE)
+        {
+            uint64 bit = (uint64)1 << offset;
+            if (record.bitmap & bit)
+            {
+                // acknowledged before, but the Block Ack was lost
+                EV_LOG(DETAIL) << "dropping duplicate A-MPDU subframe " << frame << endl;
+                delete frame;
+                continue;
+            }
+            record.bitmap |= bit;
+        }
+        sendUp(frame);
+        // if we are the owner then we did not send this frame up
+        if (frame->getOwner() == this)
+            delete frame;
+        numReceived++;
+    }
+}
+
 Ieee80211DataOrMgmtFrame *Ieee80211Mac::getCurrentTransmission()
 {
     return transmissionQueue()->empty() ? NULL : (Ieee80211DataOrMgmtFrame *)transmissionQueue()->front();
@@ -2110,7 +2395,7 @@ bool Ieee80211Mac::isSentByUs(Ieee80211Frame *frame)
             return 1;
     }
     else
-        EV<<"Cast failed"<<endl;
+        EV_LOG(DETAIL) <<"Cast failed"<<endl;
 
     return 0;
 
@@ -2136,23 +2421,28 @@ Ieee80211Frame *Ieee80211Mac::getFrameReceivedBeforeSIFS()
 
 void Ieee80211Mac::popTransmissionQueue()
 {
-    EV << "dropping frame from transmission queue\n";
-    Ieee80211Frame *temp = dynamic_cast<Ieee80211Frame *>(transmissionQueue()->front());
+    EV_LOG(DETAIL) << "dropping frame from transmission queue\n";
     ASSERT(!transmissionQueue()->empty());
-    transmissionQueue()->pop_front();
+    removeFromTransmissionQueue(transmissionQueue()->begin());
+}
+
+void Ieee80211Mac::removeFromTransmissionQueue(Ieee80211DataOrMgmtFrameList::iterator it)
+{
+    Ieee80211Frame *temp = *it;
+    transmissionQueue()->erase(it);
     if (queueModule)
     {
-        if (numCategories()==1)
+        if (numCategories()==1 && !aggregation)
         {
         // the module are continuously asking for packets
-            EV << "requesting another frame from queue module\n";
+            EV_LOG(DETAIL) << "requesting another frame from queue module\n";
             queueModule->requestPacket();
          }
-         else if (numCategories()>1 && (int)transmissionQueueSize()==maxQueueSize-1)
+         else if ((numCategories()>1 || aggregation) && (int)transmissionQueueSize()==maxQueueSize-1)
          {
          // Now exist a empty frame space
          // the module are continuously asking for packets
-            EV << "requesting another frame from queue module\n";
+            EV_LOG(DETAIL) << "requesting another frame from queue module\n";
             queueModule->requestPacket();
          }
     }
@@ -2164,11 +2454,11 @@ double Ieee80211Mac::computeFrameDuration(Ieee80211Frame *msg)
 
     PhyControlInfo *ctrl;
     double duration;
-    EV<<*msg;
+    EV_LOG(DETAIL) <<*msg;
     ctrl = dynamic_cast<PhyControlInfo*> ( msg->removeControlInfo() );
     if ( ctrl )
     {
-        EV<<"Per frame2 params bitrate "<<ctrl->getBitrate()/1e6<<endl;
+        EV_LOG(DETAIL) <<"Per frame2 params bitrate "<<ctrl->getBitrate()/1e6<<endl;
         duration = computeFrameDuration(msg->getBitLength(), ctrl->getBitrate());
         delete ctrl;
         return duration;
@@ -2180,47 +2470,109 @@ double Ieee80211Mac::computeFrameDuration(Ieee80211Frame *msg)
 
 double Ieee80211Mac::computeFrameDuration(int bits, double bitrate)
 {
-    double duration;
-    ModulationType modType;
-    modType = WifiModulationType::getModulationType(opMode, bitrate);
+    double duration = lookupFrameDuration(getDurationTable(bitrate), bits);
+    EV_LOG(DETAIL) <<" duration="<<duration*1e6<<"us("<<bits<<"bits "<<bitrate/1e6<<"Mbps)"<<endl;
+    return duration;
+}
+
+double Ieee80211Mac::calculateFrameDuration(int bits, const ModulationType& modType)
+{
     if (PHY_HEADER_LENGTH<0)
-        duration = SIMTIME_DBL(WifiModulationType::calculateTxDuration(bits, modType, wifiPreambleType));
+        return SIMTIME_DBL(WifiModulationType::calculateTxDuration(bits, modType, wifiPreambleType));
     else
-        duration = SIMTIME_DBL(WifiModulationType::getPayloadDuration(bits, modType)) + PHY_HEADER_LENGTH;
+        return SIMTIME_DBL(WifiModulationType::getPayloadDuration(bits, modType)) + PHY_HEADER_LENGTH;
+}
 
-    EV<<" duration="<<duration*1e6<<"us("<<bits<<"bits "<<bitrate/1e6<<"Mbps)"<<endl;
+void Ieee80211Mac::initDurationTable(DurationTable& table, const ModulationType& modType)
+{
+    table.modType = modType;
+    table.durations.clear();
+    table.headerTime = WifiModulationType::getPreambleAndHeader(modType, wifiPreambleType);
+    table.slotTime = SIMTIME_DBL(WifiModulationType::getSlotDuration(modType, wifiPreambleType));
+    table.sifs = SIMTIME_DBL(WifiModulationType::getSifsTime(modType, wifiPreambleType));
+    table.phyRxStartDelay = SIMTIME_DBL(WifiModulationType::get_aPHY_RX_START_Delay(modType, wifiPreambleType));
+
+    // the buckets follow WifiModulationType::getPayloadDuration()
+    table.bucketOffset = 0;
+    table.bucketNum = 1;
+    table.bucketDen = 0;
+    switch (modType.getModulationClass())
+    {
+        case MOD_CLASS_OFDM:
+        case MOD_CLASS_ERP_OFDM:
+        {
+            // one bucket per symbol: 16 service bits and 6 tail bits are added to the frame
+            int64 symbolDurationUs = modType.getBandwidth() == 10000000 ? 8 : modType.getBandwidth() == 5000000 ? 16 : 4;
+            int64 bitsPerSymbolTimes1e6 = (int64)modType.getDataRate() * symbolDurationUs;
+            if (bitsPerSymbolTimes1e6 % 1000000 == 0)
+            {
+                table.bucketOffset = 16 + 6;
+                table.bucketDen = bitsPerSymbolTimes1e6 / 1000000;
+            }
+            break;
+        }
+        case MOD_CLASS_DSSS:
+            // one bucket per microsecond, exact for multiples of 0.5Mbps
+            if (modType.getDataRate() > 0 && modType.getDataRate() % 500000 == 0)
+            {
+                table.bucketNum = 1000000;
+                table.bucketDen = modType.getDataRate();
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+Ieee80211Mac::DurationTable& Ieee80211Mac::getDurationTable(double bitrate)
+{
+    int idx = Ieee80211Descriptor::getIdx(opMode, bitrate);
+    return durationTables[idx];
+}
+
+double Ieee80211Mac::lookupFrameDuration(DurationTable& table, int bits)
+{
+    if (table.bucketDen == 0 || bits < 0)
+        return calculateFrameDuration(bits, table.modType);
+
+    size_t bucket = (size_t)(((bits + table.bucketOffset) * table.bucketNum + table.bucketDen - 1) / table.bucketDen);
+    if (bucket >= table.durations.size())
+        table.durations.resize(bucket + 1, -1);
+    double& duration = table.durations[bucket];
+    if (duration < 0)
+        duration = calculateFrameDuration(bits, table.modType);
     return duration;
 }
 
 void Ieee80211Mac::logState()
 {
     int numCategs = numCategories();
-    EV << "# state information: mode = " << modeName(mode) << ", state = " << fsm.getStateName();
-    EV << ", backoff 0.." << numCategs << " =";
+    EV_LOG(DETAIL) << "# state information: mode = " << modeName(mode) << ", state = " << fsm.getStateName();
+    EV_LOG(DETAIL) << ", backoff 0.." << numCategs << " =";
     for (int i=0; i<numCategs; i++)
-        EV << " " << edcCAF[i].backoff;
-    EV <<  "\n# backoffPeriod 0.." << numCategs << " =";
+        EV_LOG(DETAIL) << " " << edcCAF[i].backoff;
+    EV_LOG(DETAIL) <<  "\n# backoffPeriod 0.." << numCategs << " =";
     for (int i=0; i<numCategs; i++)
-        EV << " " << edcCAF[i].backoffPeriod;
-    EV << "\n# retryCounter 0.." << numCategs << " =";
+        EV_LOG(DETAIL) << " " << edcCAF[i].backoffPeriod;
+    EV_LOG(DETAIL) << "\n# retryCounter 0.." << numCategs << " =";
     for (int i=0; i<numCategs; i++)
-        EV << " " << edcCAF[i].retryCounter;
-    EV << ", radioState = " << radioState << ", nav = " << nav <<  ", txop is "<< txop << "\n";
-    EV << "#queue size 0.." << numCategs << " =";
+        EV_LOG(DETAIL) << " " << edcCAF[i].retryCounter;
+    EV_LOG(DETAIL) << ", radioState = " << radioState << ", nav = " << nav <<  ", txop is "<< txop << "\n";
+    EV_LOG(DETAIL) << "#queue size 0.." << numCategs << " =";
     for (int i=0; i<numCategs; i++)
-        EV << " " << transmissionQueue(i)->size();
-    EV << ", medium is " << (isMediumFree() ? "free" : "busy") << ", scheduled AIFS are";
+        EV_LOG(DETAIL) << " " << transmissionQueue(i)->size();
+    EV_LOG(DETAIL) << ", medium is " << (isMediumFree() ? "free" : "busy") << ", scheduled AIFS are";
     for (int i=0; i<numCategs; i++)
-        EV << " " << i << "(" << (edcCAF[i].endAIFS->isScheduled() ? "scheduled" : "") << ")";
-    EV << ", scheduled backoff are";
+        EV_LOG(DETAIL) << " " << i << "(" << (edcCAF[i].endAIFS->isScheduled() ? "scheduled" : "") << ")";
+    EV_LOG(DETAIL) << ", scheduled backoff are";
     for (int i=0; i<numCategs; i++)
-        EV << " " << i << "(" << (edcCAF[i].endBackoff->isScheduled() ? "scheduled" : "") << ")";
-    EV << "\n# currentAC: " << currentAC << ", oldcurrentAC: " << oldcurrentAC;
+        EV_LOG(DETAIL) << " " << i << "(" << (edcCAF[i].endBackoff->isScheduled() ? "scheduled" : "") << ")";
+    EV_LOG(DETAIL) << "\n# currentAC: " << currentAC << ", oldcurrentAC: " << oldcurrentAC;
     if (getCurrentTransmission() != NULL)
-        EV << "\n# current transmission: " << getCurrentTransmission()->getId();
+        EV_LOG(DETAIL) << "\n# current transmission: " << getCurrentTransmission()->getId();
     else
-        EV << "\n# current transmission: none";
-    EV << endl;
+        EV_LOG(DETAIL) << "\n# current transmission: none";
+    EV_LOG(DETAIL) << endl;
 }
 
 const char *Ieee80211Mac::modeName(int mode)
@@ -2263,6 +2615,7 @@ void Ieee80211Mac::flushQueue()
         queueModule->clear(); // clear request count
     }
 
+    numAggregatedFrames = 0;
     for (int i=0; i<numCategories(); i++)
     {
         while (!transmissionQueue(i)->empty())
@@ -2281,6 +2634,7 @@ void Ieee80211Mac::clearQueue()
         queueModule->clear(); // clear request count
     }
 
+    numAggregatedFrames = 0;
     for (int i=0; i<numCategories(); i++)
     {
         while (!transmissionQueue(i)->empty())
@@ -2428,7 +2782,11 @@ double Ieee80211Mac::getBitrate()
 
 void Ieee80211Mac::setBitrate(double rate)
 {
+    if (bitrate == rate)
+        return;
     bitrate = rate;
+    if (useModulationParameters)
+        updateTimingParameters();
 }
 
 
@@ -2728,7 +3086,7 @@ Ieee80211Mac::getControlAnswerMode(ModulationType reqMode)
 // This methods implemet the duplicate filter
 void Ieee80211Mac::sendUp(cMessage *msg)
 {
-    EV << "sending up " << msg << "\n";
+    EV_LOG(DETAIL) << "sending up " << msg << "\n";
 
     if (!isDuplicated(msg)) // duplicate detection filter
     {
@@ -2828,12 +3186,8 @@ bool Ieee80211Mac::isBackoffPending()
 
 double Ieee80211Mac::controlFrameTxTime(int bits)
 {
-     double duration;
-     if (PHY_HEADER_LENGTH<0)
-         duration = SIMTIME_DBL(WifiModulationType::calculateTxDuration(bits, controlFrameModulationType, wifiPreambleType));
-     else
-         duration = SIMTIME_DBL(WifiModulationType::getPayloadDuration(bits, controlFrameModulationType))+PHY_HEADER_LENGTH;
+     double duration = lookupFrameDuration(controlFrameDurationTable, bits);
 
-     EV<<" duration="<<duration*1e6<<"us("<<bits<<"bits "<<controlFrameModulationType.getPhyRate()/1e6<<"Mbps)"<<endl;
+     EV_LOG(DETAIL) <<" duration="<<duration*1e6<<"us("<<bits<<"bits "<<controlFrameModulationType.getPhyRate()/1e6<<"Mbps)"<<endl;
      return duration;
 }
@@ -29,6 +29,7 @@
 #include "WirelessMacBase.h"
 #include "IPassiveQueue.h"
 #include "Ieee80211Frame_m.h"
+#include "Ieee80211AMPDUFrame.h"
 #include "Ieee80211Consts.h"
 #include "NotificationBoard.h"
 #include "RadioState.h"
@@ -181,6 +182,18 @@ class INET_API Ieee80211Mac : public WirelessMacBase
     /** Contention window size for multicast messages. */
     int cwMinMulticast;
 
+    /** If true, unicast data frames for the same receiver are sent as A-MPDUs */
+    bool aggregation;
+
+    /** Maximum number of frames in an A-MPDU, at most BLOCKACK_WINDOW_SIZE */
+    int maxAggregateFrames;
+
+    /** Maximum length of an A-MPDU in bytes */
+    int maxAggregateBytes;
+
+    /** If true, the radio receives overheard unicast frames header-only */
+    bool headerOnlyOverhearing;
+
     /** Messages longer than this threshold will be sent in multiple fragments. see spec 361 */
     static const int fragmentationThreshold = 2346;
     //@}
@@ -241,6 +254,40 @@ class INET_API Ieee80211Mac : public WirelessMacBase
 
     std::vector<Edca> edcCAF;
     std::vector<EdcaOutVector> edcCAFOutVector;
+
+    /**
+     * Frame durations of one bitrate. Frames whose payload occupies the same
+     * number of OFDM symbols (or DSSS microseconds) take the same time to
+     * send, so the durations are kept per bucket, computed on first use.
+     * The bucket of a frame is ceil((bits + bucketOffset) * bucketNum / bucketDen);
+     * bucketDen is 0 if the modulation does not allow exact bucketing.
+     */
+    struct DurationTable {
+        ModulationType modType;
+        int64 bucketOffset;
+        int64 bucketNum;
+        int64 bucketDen;
+        std::vector<double> durations;  // -1 where not computed yet
+        simtime_t headerTime;
+        double slotTime;
+        double sifs;
+        double phyRxStartDelay;
+    };
+    /** Indexed by Ieee80211Descriptor index, only the entries of opMode are filled in */
+    std::vector<DurationTable> durationTables;
+    DurationTable controlFrameDurationTable;
+
+    /**
+     * @name Interframe spaces
+     * Cached by updateTimingParameters(), because they depend on the bitrate
+     * if useModulationParameters is set.
+     */
+    //@{
+    simtime_t sifs;
+    simtime_t slotTime;
+    simtime_t eifs;
+    std::vector<simtime_t> aifs;  // per access category, DIFS is the AIFS of the last one
+    //@}
     //
     // methods for access to the current AC data
     //
@@ -328,6 +375,29 @@ class INET_API Ieee80211Mac : public WirelessMacBase
     /** True if we are in txop bursting packets. */
     bool txop;
 
+    /**
+     * Number of frames at the front of the transmission queue that were sent
+     * in the last A-MPDU, 0 if the last data transmission was a single frame.
+     */
+    int numAggregatedFrames;
+
+    /** Transmission time of the last A-MPDU, used for the Block Ack timeout */
+    double aggregateTxDuration;
+
+    /**
+     * Block Ack scoreboard kept for each originator we receive A-MPDUs from:
+     * bit i of the bitmap is set if the frame with sequence number
+     * startingSequenceNumber+i has been received. The Block Ack agreement
+     * is implicit, there is no ADDBA exchange.
+     */
+    struct BlockAckRecord
+    {
+        int startingSequenceNumber;
+        uint64 bitmap;
+    };
+    typedef std::map<MACAddress, BlockAckRecord> BlockAckRecordMap;
+    BlockAckRecordMap blockAckRecords;
+
     /** Indicates which queue is acite. Depends on access category. */
     int currentAC;
 
@@ -411,6 +481,8 @@ class INET_API Ieee80211Mac : public WirelessMacBase
     // long numDropped[4];
     long numReceivedOther;
     long numAckSend;
+    long numSentAggregates;
+    long numBlockAckSend;
     cOutVector stateVector;
     simtime_t  last;
     // long bits[4];
@@ -487,6 +559,9 @@ class INET_API Ieee80211Mac : public WirelessMacBase
     virtual simtime_t computeBackoffPeriod(Ieee80211Frame *msg, int r);
     virtual simtime_t getHeaderTime(double bitrate);
     virtual double controlFrameTxTime(int bits);
+
+    /** @brief Recomputes the cached interframe spaces, call it when the bitrate or the EDCA parameters change */
+    virtual void updateTimingParameters();
     //@}
 
   protected:
@@ -537,6 +612,11 @@ class INET_API Ieee80211Mac : public WirelessMacBase
     virtual void sendDataFrameOnEndSIFS(Ieee80211DataOrMgmtFrame *frameToSend);
     virtual void sendDataFrame(Ieee80211DataOrMgmtFrame *frameToSend);
     virtual void sendMulticastFrame(Ieee80211DataOrMgmtFrame *frameToSend);
+    virtual void sendBlockAckFrameOnEndSIFS();
+    virtual void sendBlockAckFrame(Ieee80211AMPDUFrame *aggregate);
+
+    /** @brief Tells the radio the receiver of unicast frames if headerOnlyOverhearing is set */
+    virtual void sendDown(cMessage *msg);
     //@}
 
   protected:
@@ -549,6 +629,13 @@ class INET_API Ieee80211Mac : public WirelessMacBase
     virtual Ieee80211RTSFrame *buildRTSFrame(Ieee80211DataOrMgmtFrame *frameToSend);
     virtual Ieee80211CTSFrame *buildCTSFrame(Ieee80211RTSFrame *rtsFrame);
     virtual Ieee80211DataOrMgmtFrame *buildMulticastFrame(Ieee80211DataOrMgmtFrame *frameToSend);
+
+    /**
+     * @brief Builds an A-MPDU from the frames at the front of the current
+     * transmission queue, or returns NULL if less than two frames qualify.
+     */
+    virtual Ieee80211AMPDUFrame *buildAggregateFrame();
+    virtual Ieee80211BlockAckFrame *buildBlockAckFrame(Ieee80211AMPDUFrame *aggregate);
     //@}
 
     /**
@@ -566,6 +653,22 @@ class INET_API Ieee80211Mac : public WirelessMacBase
     virtual void finishCurrentTransmission();
     virtual void giveUpCurrentTransmission();
     virtual void retryCurrentTransmission();
+
+    /** @brief Returns true if the Block Ack acknowledges the frame */
+    virtual bool isAckedByBlockAck(Ieee80211DataOrMgmtFrame *frame, Ieee80211BlockAckFrame *blockAck);
+
+    /** @brief Returns true if the Block Ack acknowledges all frames of the last A-MPDU */
+    virtual bool isAggregateAcked(Ieee80211BlockAckFrame *blockAck);
+
+    /**
+     * @brief Removes the frames acknowledged by the Block Ack from the
+     * transmission queue, the others stay at the front of the queue to be
+     * retransmitted. Returns true if no frame is left to retransmit.
+     */
+    virtual bool finishAggregateTransmission(Ieee80211BlockAckFrame *blockAck);
+
+    /** @brief Updates the scoreboard and sends up the new frames of the A-MPDU */
+    virtual void receiveAggregateFrame(Ieee80211AMPDUFrame *aggregate);
     virtual bool transmissionQueueEmpty();
     virtual unsigned int transmissionQueueSize();
     virtual void flushQueue();
@@ -614,6 +717,9 @@ class INET_API Ieee80211Mac : public WirelessMacBase
     /** @brief Deletes frame at the front of queue. */
     virtual void popTransmissionQueue();
 
+    /** @brief Deletes the given frame of the current queue. */
+    virtual void removeFromTransmissionQueue(Ieee80211DataOrMgmtFrameList::iterator it);
+
     /**
      * @brief Computes the duration (in seconds) of the transmission of a frame
      * over the physical channel. 'bits' should be the total length of the MAC frame
@@ -622,6 +728,18 @@ class INET_API Ieee80211Mac : public WirelessMacBase
     virtual double computeFrameDuration(Ieee80211Frame *msg);
     virtual double computeFrameDuration(int bits, double bitrate);
 
+    /** @brief Computes the duration without the tables, used to fill them */
+    virtual double calculateFrameDuration(int bits, const ModulationType& modType);
+
+    /** @brief Sets up an empty duration table for the modulation */
+    virtual void initDurationTable(DurationTable& table, const ModulationType& modType);
+
+    /** @brief Returns the duration table of the bitrate, throws an error if the bitrate is not valid in opMode */
+    virtual DurationTable& getDurationTable(double bitrate);
+
+    /** @brief Returns the duration of a frame of the given length from the table */
+    virtual double lookupFrameDuration(DurationTable& table, int bits);
+
     /** @brief Logs all state information */
     virtual void logState();
 
@@ -29,10 +29,10 @@ void DropTailQueue::initialize()
 {
     PassiveQueueBase::initialize();
 
-    queue.setName(par("queueName"));
+    WATCH(queue);
 
     //statistics
-    emit(queueLengthSignal, queue.length());
+    emit(queueLengthSignal, queue.getLength());
 
     outGate = gate("out");
 
@@ -42,28 +42,34 @@ void DropTailQueue::initialize()
 
 cMessage *DropTailQueue::enqueue(cMessage *msg)
 {
-    if (frameCapacity && queue.length() >= frameCapacity)
+    if (frameCapacity && queue.getLength() >= frameCapacity)
     {
         EV << "Queue full, dropping packet.\n";
         return msg;
     }
     else
     {
-        queue.insert(msg);
-        emit(queueLengthSignal, queue.length());
+        queue.insert(check_and_cast<cPacket *>(msg));
+        if (mayHaveListeners(queueLengthSignal))
+            emit(queueLengthSignal, queue.getLength());
+        if (ev.isGUI())
+            updateDisplayString();
         return NULL;
     }
 }
 
 cMessage *DropTailQueue::dequeue()
 {
-    if (queue.empty())
+    if (queue.isEmpty())
         return NULL;
 
-    cMessage *msg = (cMessage *)queue.pop();
+    cMessage *msg = queue.pop();
 
     // statistics
-    emit(queueLengthSignal, queue.length());
+    if (mayHaveListeners(queueLengthSignal))
+        emit(queueLengthSignal, queue.getLength());
+    if (ev.isGUI())
+        updateDisplayString();
 
     return msg;
 }
@@ -75,6 +81,13 @@ void DropTailQueue::sendOut(cMessage *msg)
 
 bool DropTailQueue::isEmpty()
 {
-    return queue.empty();
+    return queue.isEmpty();
 }
 
+void DropTailQueue::updateDisplayString()
+{
+    // the length is shown here, because the 'q' display string tag only works with a cQueue
+    char buf[32];
+    sprintf(buf, "q len: %d", queue.getLength());
+    getDisplayString().setTagArg("t", 0, buf);
+}
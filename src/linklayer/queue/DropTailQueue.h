@@ -22,18 +22,20 @@
 #include "INETDefs.h"
 
 #include "PassiveQueueBase.h"
+#include "IQueueAccess.h"
+#include "PacketQueue.h"
 
 /**
  * Drop-front queue. See NED for more info.
  */
-class INET_API DropTailQueue : public PassiveQueueBase
+class INET_API DropTailQueue : public PassiveQueueBase, public IQueueAccess
 {
   protected:
     // configuration
     int frameCapacity;
 
     // state
-    cQueue queue;
+    PacketQueue queue;
     cGate *outGate;
 
     // statistics
@@ -61,6 +63,19 @@ class INET_API DropTailQueue : public PassiveQueueBase
      * Redefined from IPassiveQueue.
      */
     virtual bool isEmpty();
+
+    /** Shows the queue length in the display string, under a GUI */
+    virtual void updateDisplayString();
+
+    /**
+     * Redefined from IQueueAccess.
+     */
+    virtual int getLength() const { return queue.getLength(); }
+
+    /**
+     * Redefined from IQueueAccess.
+     */
+    virtual int getByteLength() const { return (int)queue.getByteLength(); }
 };
 
 #endif
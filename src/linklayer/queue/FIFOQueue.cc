@@ -29,27 +29,30 @@ simsignal_t FIFOQueue::queueLengthSignal = registerSignal("queueLength");
 void FIFOQueue::initialize()
 {
     PassiveQueueBase::initialize();
-    queue.setName(par("queueName"));
+    WATCH(queue);
     outGate = gate("out");
 }
 
 cMessage *FIFOQueue::enqueue(cMessage *msg)
 {
-    cPacket *packet = check_and_cast<cPacket*>(msg);
-    queue.insert(packet);
-    byteLength += packet->getByteLength();
-    emit(queueLengthSignal, queue.length());
+    queue.insert(check_and_cast<cPacket*>(msg));
+    if (mayHaveListeners(queueLengthSignal))
+        emit(queueLengthSignal, queue.getLength());
+    if (ev.isGUI())
+        updateDisplayString();
     return NULL;
 }
 
 cMessage *FIFOQueue::dequeue()
 {
-    if (queue.empty())
+    if (queue.isEmpty())
         return NULL;
 
-    cPacket *packet = check_and_cast<cPacket*>(queue.pop());
-    byteLength -= packet->getByteLength();
-    emit(queueLengthSignal, queue.length());
+    cPacket *packet = queue.pop();
+    if (mayHaveListeners(queueLengthSignal))
+        emit(queueLengthSignal, queue.getLength());
+    if (ev.isGUI())
+        updateDisplayString();
     return packet;
 }
 
@@ -60,6 +63,13 @@ void FIFOQueue::sendOut(cMessage *msg)
 
 bool FIFOQueue::isEmpty()
 {
-    return queue.empty();
+    return queue.isEmpty();
 }
 
+void FIFOQueue::updateDisplayString()
+{
+    // the length is shown here, because the 'q' display string tag only works with a cQueue
+    char buf[32];
+    sprintf(buf, "q len: %d", queue.getLength());
+    getDisplayString().setTagArg("t", 0, buf);
+}
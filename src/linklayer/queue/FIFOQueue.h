@@ -23,6 +23,7 @@
 #include "INETDefs.h"
 #include "PassiveQueueBase.h"
 #include "IQueueAccess.h"
+#include "PacketQueue.h"
 
 /**
  * Passive FIFO Queue with unlimited buffer space.
@@ -31,15 +32,14 @@ class INET_API FIFOQueue : public PassiveQueueBase, public IQueueAccess
 {
   protected:
     // state
-    cQueue queue;
+    PacketQueue queue;
     cGate *outGate;
-    int byteLength;
 
     // statistics
     static simsignal_t queueLengthSignal;
 
   public:
-    FIFOQueue() : outGate(NULL), byteLength(0) {}
+    FIFOQueue() : outGate(NULL) {}
 
   protected:
     virtual void initialize();
@@ -52,9 +52,11 @@ class INET_API FIFOQueue : public PassiveQueueBase, public IQueueAccess
 
     virtual bool isEmpty();
 
+    virtual void updateDisplayString();
+
     virtual int getLength() const { return queue.getLength(); }
 
-    virtual int getByteLength() const { return byteLength; }
+    virtual int getByteLength() const { return (int)queue.getByteLength(); }
 };
 
 #endif
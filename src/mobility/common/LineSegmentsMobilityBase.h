@@ -53,6 +53,8 @@ class INET_API LineSegmentsMobilityBase : public MovingMobilityBase
      */
     virtual void setTargetPosition() = 0;
 
+    virtual bool isPiecewiseLinear() const { return true; }
+
   public:
     LineSegmentsMobilityBase();
 };
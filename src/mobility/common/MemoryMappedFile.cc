@@ -0,0 +1,86 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <stdio.h>
+
+#include "MemoryMappedFile.h"
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+#define USE_READ_INSTEAD_OF_MMAP
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+void MemoryMappedFile::open(const char *filename)
+{
+    close();
+#ifdef USE_READ_INSTEAD_OF_MMAP
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+        throw cRuntimeError("Cannot open file '%s'", filename);
+    fseek(f, 0, SEEK_END);
+    long length = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    buffer.resize(length);
+    if (length > 0 && fread(&buffer[0], 1, length, f) != (size_t)length)
+    {
+        fclose(f);
+        throw cRuntimeError("Cannot read file '%s'", filename);
+    }
+    fclose(f);
+    size = length;
+    data = length > 0 ? &buffer[0] : NULL;
+#else
+    int fd = ::open(filename, O_RDONLY);
+    if (fd < 0)
+        throw cRuntimeError("Cannot open file '%s'", filename);
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        throw cRuntimeError("Cannot stat file '%s'", filename);
+    }
+    size = st.st_size;
+    if (size > 0)
+    {
+        void *p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            ::close(fd);
+            size = 0;
+            throw cRuntimeError("Cannot map file '%s'", filename);
+        }
+        madvise(p, size, MADV_SEQUENTIAL);
+        data = (const char *)p;
+    }
+    ::close(fd);  // the mapping stays valid
+#endif
+}
+
+void MemoryMappedFile::close()
+{
+#ifdef USE_READ_INSTEAD_OF_MMAP
+    buffer.clear();
+#else
+    if (data)
+        munmap((void *)data, size);
+#endif
+    data = NULL;
+    size = 0;
+}
@@ -0,0 +1,66 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef MEMORY_MAPPED_FILE_H
+#define MEMORY_MAPPED_FILE_H
+
+#include <vector>
+
+#include "INETDefs.h"
+
+
+/**
+ * Read-only view of a file's contents. The file is memory-mapped where the
+ * platform supports it, so pages are only read from disk when accessed;
+ * elsewhere the contents are read into memory on open().
+ *
+ * Used by the trace file based mobility models to avoid copying large
+ * trace files into per-line containers.
+ *
+ * @ingroup mobility
+ */
+class INET_API MemoryMappedFile
+{
+  protected:
+    const char *data;
+    size_t size;
+    std::vector<char> buffer;  // used when mmap() is not available
+
+  private:
+    // not copyable
+    MemoryMappedFile(const MemoryMappedFile&);
+    MemoryMappedFile& operator=(const MemoryMappedFile&);
+
+  public:
+    MemoryMappedFile() : data(NULL), size(0) {}
+    ~MemoryMappedFile() { close(); }
+
+    /**
+     * Maps the given file; throws cRuntimeError if it cannot be opened.
+     */
+    void open(const char *filename);
+
+    /**
+     * Unmaps the file. Pointers returned by getData() become invalid.
+     */
+    void close();
+
+    const char *getData() const { return data; }
+    size_t getSize() const { return size; }
+    const char *getEnd() const { return data + size; }
+};
+
+#endif
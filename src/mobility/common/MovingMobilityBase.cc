@@ -28,6 +28,7 @@ MovingMobilityBase::MovingMobilityBase()
 {
     moveTimer = NULL;
     updateInterval = 0;
+    eventDriven = false;
     stationary = false;
     lastSpeed = Coord::ZERO;
     lastUpdate = 0;
@@ -47,6 +48,9 @@ void MovingMobilityBase::initialize(int stage)
     if (stage == 0) {
         moveTimer = new cMessage("move");
         updateInterval = par("updateInterval");
+        eventDriven = par("eventDriven");
+        if (eventDriven && !isPiecewiseLinear())
+            error("eventDriven updates are not supported by this mobility model");
     }
 }
 
@@ -60,10 +64,14 @@ void MovingMobilityBase::moveAndUpdate()
 {
     simtime_t now = simTime();
     if (nextChange == now || lastUpdate != now) {
+        bool isChange = nextChange == now;
         move();
         lastUpdate = simTime();
-        emitMobilityStateChangedSignal();
-        updateVisualRepresentation();
+        // in event driven mode positions between changes are only computed on demand
+        if (!eventDriven || isChange) {
+            emitMobilityStateChangedSignal();
+            updateVisualRepresentation();
+        }
     }
 }
 
@@ -76,7 +84,7 @@ void MovingMobilityBase::handleSelfMessage(cMessage *message)
 void MovingMobilityBase::scheduleUpdate()
 {
     cancelEvent(moveTimer);
-    if (!stationary && updateInterval != 0) {
+    if (!stationary && !eventDriven && updateInterval != 0) {
         // periodic update is needed
         simtime_t nextUpdate = simTime() + updateInterval;
         if (nextChange != -1 && nextChange < nextUpdate)
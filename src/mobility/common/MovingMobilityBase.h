@@ -45,6 +45,12 @@ class INET_API MovingMobilityBase : public MobilityBase
      * The 0 value turns off the signal. */
     simtime_t updateInterval;
 
+    /** @brief Signal mobility state changes only when the movement changes (e.g. at segment ends).
+     *
+     * The true value turns off periodic updates; positions in between are computed
+     * on demand, and listeners are expected to extrapolate using the reported speed. */
+    bool eventDriven;
+
     /** @brief A mobility model may decide to become stationary at any time.
      *
      * The true value disables sending self messages. */
@@ -85,12 +91,20 @@ class INET_API MovingMobilityBase : public MobilityBase
      */
     virtual void move() = 0;
 
+    /** @brief Returns true if the node moves with constant speed between two subsequent changes.
+     *
+     * Event driven updates are only supported by such mobility models. */
+    virtual bool isPiecewiseLinear() const { return false; }
+
   public:
     /** @brief Returns the current position at the current simulation time. */
     virtual Coord getCurrentPosition();
 
     /** @brief Returns the current speed at the current simulation time. */
     virtual Coord getCurrentSpeed();
+
+    /** @brief Returns true if the mobility state is only signalled when the movement changes. */
+    bool isEventDriven() const { return eventDriven; }
 };
 
 #endif
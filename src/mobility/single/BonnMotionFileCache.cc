@@ -16,17 +16,126 @@
 //
 
 
-#include <fstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
 #include <sstream>
 
+#if defined(_WIN32) && !defined(__CYGWIN__)
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
 #include "BonnMotionFileCache.h"
 
 
+// layout of the binary format: header, (numLines+1) uint64 line start
+// indices, then the values of all lines as doubles, in host byte order
+static const char BINARY_MAGIC[8] = {'I','N','E','T','B','M','B','1'};
+static const uint32 BINARY_BYTE_ORDER = 0x01020304;
+
+struct BinaryHeader
+{
+    char magic[8];
+    uint32 byteOrder;
+    uint32 numLines;
+};
+
+static const uint64 *getBinaryLineStarts(const MemoryMappedFile& file)
+{
+    return (const uint64 *)(file.getData() + sizeof(BinaryHeader));
+}
+
+static const double *getBinaryValues(const MemoryMappedFile& file, uint32 numLines)
+{
+    return (const double *)(file.getData() + sizeof(BinaryHeader) + (numLines + 1) * sizeof(uint64));
+}
+
+
+int BonnMotionFile::getNumLines() const
+{
+    if (binary)
+        return ((const BinaryHeader *)file.getData())->numLines;
+    buildIndex();
+    return lineOffsets.size() - 1;
+}
+
 const BonnMotionFile::Line *BonnMotionFile::getLine(int nodeId) const
 {
-    LineList::const_iterator it = lines.begin();
-    for (int i=0; i<nodeId && it!=lines.end(); i++) it++;
-    return (it==lines.end()) ? NULL : &(*it);
+    if (nodeId < 0 || nodeId >= getNumLines())
+        return NULL;
+    LineMap::iterator it = lines.find(nodeId);
+    if (it == lines.end())
+    {
+        it = lines.insert(std::make_pair(nodeId, Line())).first;
+        parseLine(nodeId, it->second);
+    }
+    return &it->second;
+}
+
+void BonnMotionFile::buildIndex() const
+{
+    if (indexed)
+        return;
+    indexed = true;
+    const char *begin = file.getData();
+    const char *end = file.getEnd();
+    lineOffsets.clear();
+    // like std::getline(): a final newline does not start another line
+    for (const char *p = begin; p < end; )
+    {
+        lineOffsets.push_back(p - begin);
+        const char *nl = (const char *)memchr(p, '\n', end - p);
+        p = nl ? nl + 1 : end;
+    }
+    lineOffsets.push_back(file.getSize());
+}
+
+void BonnMotionFile::parseLine(int lineIndex, Line& line) const
+{
+    line.clear();
+    if (binary)
+    {
+        uint32 numLines = ((const BinaryHeader *)file.getData())->numLines;
+        const uint64 *starts = getBinaryLineStarts(file);
+        const double *values = getBinaryValues(file, numLines);
+        line.assign(values + starts[lineIndex], values + starts[lineIndex + 1]);
+        return;
+    }
+
+    // the mapped file is not null-terminated, so strtod() works on a copy
+    size_t offset = lineOffsets[lineIndex];
+    std::string text(file.getData() + offset, lineOffsets[lineIndex + 1] - offset);
+    const char *p = text.c_str();
+    while (true)
+    {
+        char *endp;
+        double d = strtod(p, &endp);
+        if (endp == p)
+            break;
+        line.push_back(d);
+        p = endp;
+    }
+}
+
+bool BonnMotionFile::openBinary(const char *filename)
+{
+    file.open(filename);
+    binary = true;
+    size_t size = file.getSize();
+    if (size < sizeof(BinaryHeader))
+        return false;
+    const BinaryHeader *header = (const BinaryHeader *)file.getData();
+    if (memcmp(header->magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0 || header->byteOrder != BINARY_BYTE_ORDER)
+        return false;
+    size_t valuesOffset = sizeof(BinaryHeader) + (header->numLines + 1) * sizeof(uint64);
+    if (size < valuesOffset)
+        return false;
+    const uint64 *starts = getBinaryLineStarts(file);
+    return starts[0] == 0 && valuesOffset + starts[header->numLines] * sizeof(double) == size;
 }
 
 
@@ -48,35 +157,87 @@ void BonnMotionFileCache::deleteInstance()
     }
 }
 
-const BonnMotionFile *BonnMotionFileCache::getFile(const char *filename)
+BonnMotionFileCache::~BonnMotionFileCache()
+{
+    for (BMFileMap::iterator it = cache.begin(); it != cache.end(); ++it)
+        delete it->second;
+}
+
+const BonnMotionFile *BonnMotionFileCache::getFile(const char *filename, bool useBinary)
 {
+    std::string name = useBinary ? std::string(filename) + ".bin" : std::string(filename);
+
     // if found, return it from cache
-    BMFileMap::iterator it = cache.find(std::string(filename));
+    BMFileMap::iterator it = cache.find(name);
     if (it!=cache.end())
-        return &(it->second);
+        return it->second;
 
-    // load and store in cache
-    BonnMotionFile& bmFile = cache[filename];
-    parseFile(filename, bmFile);
-    return &bmFile;
+    // map and store in cache
+    BonnMotionFile *bmFile = new BonnMotionFile();
+    cache[name] = bmFile;
+    if (!useBinary)
+        bmFile->file.open(filename);
+    else
+    {
+        struct stat textStat, binaryStat;
+        if (stat(filename, &textStat) != 0)
+            throw cRuntimeError("Cannot open file '%s'", filename);
+        bool upToDate = stat(name.c_str(), &binaryStat) == 0 && binaryStat.st_mtime >= textStat.st_mtime;
+        if (!upToDate || !bmFile->openBinary(name.c_str()))
+        {
+            bmFile->file.close();
+            writeBinaryFile(filename, name.c_str());
+            if (!bmFile->openBinary(name.c_str()))
+                throw cRuntimeError("Invalid binary BonnMotion file '%s'", name.c_str());
+        }
+    }
+    return bmFile;
 }
 
-void BonnMotionFileCache::parseFile(const char *filename, BonnMotionFile& bmFile)
+void BonnMotionFileCache::writeBinaryFile(const char *textFilename, const char *binaryFilename)
 {
-    std::ifstream in(filename, std::ios::in);
-    if (in.fail())
-        throw cRuntimeError("Cannot open file '%s'", filename);
+    BonnMotionFile textFile;
+    textFile.file.open(textFilename);
+    uint32 numLines = textFile.getNumLines();
 
-    std::string line;
-    while (std::getline(in, line))
-    {
-        bmFile.lines.push_back(BonnMotionFile::Line());
-        BonnMotionFile::Line& vec = bmFile.lines.back();
+    // write to a temporary file first, so that concurrent runs never map a partial file
+    std::ostringstream tmpName;
+    tmpName << binaryFilename << ".tmp" << getpid();
+    FILE *f = fopen(tmpName.str().c_str(), "wb");
+    if (!f)
+        throw cRuntimeError("Cannot create file '%s'", tmpName.str().c_str());
+
+    BinaryHeader header;
+    memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.byteOrder = BINARY_BYTE_ORDER;
+    header.numLines = numLines;
+    std::vector<uint64> starts(numLines + 1, 0);
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    ok = ok && fwrite(&starts[0], sizeof(uint64), starts.size(), f) == starts.size();
 
-        std::stringstream linestream(line);
-        double d;
-        while (linestream >> d)
-            vec.push_back(d);
+    // values are streamed line by line; the line starts are filled in afterwards
+    BonnMotionFile::Line line;
+    for (uint32 i = 0; ok && i < numLines; i++)
+    {
+        textFile.parseLine(i, line);
+        starts[i + 1] = starts[i] + line.size();
+        if (!line.empty())
+            ok = fwrite(&line[0], sizeof(double), line.size(), f) == line.size();
+    }
+    ok = ok && fseek(f, sizeof(header), SEEK_SET) == 0;
+    ok = ok && fwrite(&starts[0], sizeof(uint64), starts.size(), f) == starts.size();
+    ok = (fclose(f) == 0) && ok;
+    if (!ok)
+    {
+        remove(tmpName.str().c_str());
+        throw cRuntimeError("Cannot write file '%s'", tmpName.str().c_str());
+    }
+#if defined(_WIN32) && !defined(__CYGWIN__)
+    remove(binaryFilename);  // rename() does not replace existing files here
+#endif
+    if (rename(tmpName.str().c_str(), binaryFilename) != 0)
+    {
+        remove(tmpName.str().c_str());
+        throw cRuntimeError("Cannot create file '%s'", binaryFilename);
     }
-    in.close();
 }
@@ -19,16 +19,28 @@
 #ifndef BONN_MOTION_FILE_CACHE_H
 #define BONN_MOTION_FILE_CACHE_H
 
-#include <list>
+#include <map>
 #include <vector>
 
 #include "INETDefs.h"
 
+#include "MemoryMappedFile.h"
+
 
 class BonnMotionFileCache;
 
 /**
  * Represents a BonnMotion file's contents.
+ *
+ * The file is memory-mapped instead of being read in. Line offsets are
+ * indexed on the first getLine() call, and each line is only parsed when
+ * it is first asked for, so nodes pay for their own waypoints only.
+ *
+ * The file may also be in the precompiled binary format written by
+ * BonnMotionFileCache::writeBinaryFile(): a header with the line count and
+ * the start index of every line, followed by all values as one column of
+ * doubles. That format needs neither indexing nor parsing.
+ *
  * @see BonnMotionFileCache, BonnMotionMobility
  */
 class INET_API BonnMotionFile
@@ -37,9 +49,19 @@ class INET_API BonnMotionFile
     typedef std::vector<double> Line;
   protected:
     friend class BonnMotionFileCache;
-    typedef std::list<Line> LineList;
-    LineList lines;
+    typedef std::map<int,Line> LineMap;
+    MemoryMappedFile file;
+    bool binary;
+    mutable bool indexed;
+    mutable std::vector<size_t> lineOffsets;  // start of each line, plus end of file
+    mutable LineMap lines;  // lines parsed so far
+  protected:
+    void buildIndex() const;
+    void parseLine(int lineIndex, Line& line) const;
+    bool openBinary(const char *filename);
   public:
+    BonnMotionFile() : binary(false), indexed(false) {}
+    int getNumLines() const;
     const Line *getLine(int nodeId) const;
 };
 
@@ -55,12 +77,11 @@ class INET_API BonnMotionFile
 class INET_API BonnMotionFileCache
 {
   protected:
-    typedef std::map<std::string,BonnMotionFile> BMFileMap;
+    typedef std::map<std::string,BonnMotionFile*> BMFileMap;
     BMFileMap cache;
     static BonnMotionFileCache *inst;
-    void parseFile(const char *filename, BonnMotionFile& bmFile);
     BonnMotionFileCache() {}
-    virtual ~BonnMotionFileCache() {}
+    virtual ~BonnMotionFileCache();
 
   public:
     /**
@@ -74,9 +95,16 @@ class INET_API BonnMotionFileCache
     static void deleteInstance();
 
     /**
-     * Returns the given document.
+     * Returns the given document. If useBinary is set, the binary file
+     * <filename>.bin is used instead, and (re)generated first if it is
+     * missing or older than the text file.
+     */
+    virtual const BonnMotionFile *getFile(const char *filename, bool useBinary = false);
+
+    /**
+     * Converts a BonnMotion text file to the binary format.
      */
-    virtual const BonnMotionFile *getFile(const char *filename);
+    static void writeBinaryFile(const char *textFilename, const char *binaryFilename);
 };
 
 #endif
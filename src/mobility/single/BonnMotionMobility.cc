@@ -48,7 +48,8 @@ void BonnMotionMobility::initialize(int stage)
         if (nodeId == -1)
             nodeId = getContainingNode(this)->getIndex();
         const char *fname = par("traceFile");
-        const BonnMotionFile *bmFile = BonnMotionFileCache::getInstance()->getFile(fname);
+        bool useBinaryTrace = par("useBinaryTrace").boolValue();
+        const BonnMotionFile *bmFile = BonnMotionFileCache::getInstance()->getFile(fname, useBinaryTrace);
         lines = bmFile->getLine(nodeId);
         if (!lines)
             throw cRuntimeError("Invalid nodeId %d -- no such line in file '%s'", nodeId, fname);
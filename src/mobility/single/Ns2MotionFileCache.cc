@@ -0,0 +1,151 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <cstdlib>
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+
+#include "Ns2MotionFileCache.h"
+
+
+static const char NODE_PREFIX[] = "$node_(";
+
+void Ns2MotionTraceFile::buildIndex() const
+{
+    if (indexed)
+        return;
+    indexed = true;
+    const char *begin = file.getData();
+    const char *end = file.getEnd();
+    const char *prefixEnd = NODE_PREFIX + strlen(NODE_PREFIX);
+    for (const char *p = begin; p < end; )
+    {
+        const char *nl = (const char *)memchr(p, '\n', end - p);
+        const char *lineEnd = nl ? nl : end;
+        if (*p != '#')
+        {
+            const char *found = std::search(p, lineEnd, NODE_PREFIX, prefixEnd);
+            if (found != lineEnd)
+            {
+                const char *digits = found + strlen(NODE_PREFIX);
+                int nodeId = 0;
+                bool negative = digits < lineEnd && *digits == '-';
+                if (negative)
+                    digits++;
+                while (digits < lineEnd && *digits >= '0' && *digits <= '9')
+                    nodeId = nodeId * 10 + (*digits++ - '0');
+                nodeLines[negative ? -nodeId : nodeId].push_back(p - begin);
+            }
+        }
+        p = nl ? nl + 1 : end;
+    }
+}
+
+std::string Ns2MotionTraceFile::getLineAt(size_t offset) const
+{
+    const char *p = file.getData() + offset;
+    const char *nl = (const char *)memchr(p, '\n', file.getEnd() - p);
+    return std::string(p, nl ? nl : file.getEnd());
+}
+
+bool Ns2MotionTraceFile::getNode(int nodeId, Ns2MotionFile& node) const
+{
+    buildIndex();
+    node.initial[0] = node.initial[1] = node.initial[2] = -1;
+    node.lines.clear();
+
+    NodeLineMap::const_iterator it = nodeLines.find(nodeId);
+    if (it != nodeLines.end())
+    {
+        const OffsetVector& offsets = it->second;
+        for (OffsetVector::const_iterator jt = offsets.begin(); jt != offsets.end(); ++jt)
+        {
+            std::string line = getLineAt(*jt);
+            std::string::size_type found = line.find('#');
+            if (found != std::string::npos)
+                line.erase(found);
+            found = line.find("set ");
+            if (found != std::string::npos)
+            {
+                // Initial position
+                found = line.find("X_");
+                if (found != std::string::npos)
+                    node.initial[0] = std::atof(line.substr(found+3, std::string::npos).c_str());
+                found = line.find("Y_");
+                if (found != std::string::npos)
+                    node.initial[1] = std::atof(line.substr(found+3, std::string::npos).c_str());
+                found = line.find("Z_");
+                if (found != std::string::npos)
+                    node.initial[2] = std::atof(line.substr(found+3, std::string::npos).c_str());
+            }
+            found = line.find("setdest");
+            if (found != std::string::npos)
+            {
+                node.lines.push_back(Ns2MotionFile::Line());
+                Ns2MotionFile::Line& vec = node.lines.back();
+                // initial time
+                found = line.find("at");
+                vec.push_back(std::atof(line.substr(found+3).c_str()));
+
+                std::string parameters = line.substr(line.find("setdest ")+8, std::string::npos);
+
+                std::stringstream linestream(parameters);
+                double d;
+                while (linestream >> d)
+                    vec.push_back(d);
+            }
+        }
+    }
+    return node.initial[0] != -1 && node.initial[1] != -1 && node.initial[2] != -1;
+}
+
+
+Ns2MotionFileCache *Ns2MotionFileCache::inst;
+
+Ns2MotionFileCache *Ns2MotionFileCache::getInstance()
+{
+    if (!inst)
+        inst = new Ns2MotionFileCache;
+    return inst;
+}
+
+void Ns2MotionFileCache::deleteInstance()
+{
+    if (inst)
+    {
+        delete inst;
+        inst = NULL;
+    }
+}
+
+Ns2MotionFileCache::~Ns2MotionFileCache()
+{
+    for (Ns2FileMap::iterator it = cache.begin(); it != cache.end(); ++it)
+        delete it->second;
+}
+
+const Ns2MotionTraceFile *Ns2MotionFileCache::getFile(const char *filename)
+{
+    // if found, return it from cache
+    Ns2FileMap::iterator it = cache.find(std::string(filename));
+    if (it != cache.end())
+        return it->second;
+
+    Ns2MotionTraceFile *traceFile = new Ns2MotionTraceFile();
+    cache[filename] = traceFile;
+    traceFile->file.open(filename);
+    return traceFile;
+}
@@ -0,0 +1,107 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+
+#ifndef NS2_MOTION_FILE_CACHE_H
+#define NS2_MOTION_FILE_CACHE_H
+
+#include <map>
+#include <vector>
+
+#include "INETDefs.h"
+
+#include "MemoryMappedFile.h"
+
+
+class Ns2MotionMobility;
+class Ns2MotionTraceFile;
+
+/**
+ * Represents the motion of one node in a ns2 motion file.
+ */
+class INET_API Ns2MotionFile
+{
+  public:
+    typedef std::vector<double> Line;
+    double initial[3];
+  protected:
+    friend class Ns2MotionMobility;
+    friend class Ns2MotionTraceFile;
+    typedef std::vector<Line> LineList;
+    LineList lines;
+};
+
+/**
+ * A memory-mapped ns2 motion file. The file is scanned once, on first
+ * access, to collect the offsets of the lines belonging to each node;
+ * getNode() then parses only the lines of the given node.
+ *
+ * @see Ns2MotionFileCache, Ns2MotionMobility
+ */
+class INET_API Ns2MotionTraceFile
+{
+  protected:
+    friend class Ns2MotionFileCache;
+    typedef std::vector<size_t> OffsetVector;
+    typedef std::map<int,OffsetVector> NodeLineMap;
+    MemoryMappedFile file;
+    mutable bool indexed;
+    mutable NodeLineMap nodeLines;  // line start offsets per node id
+  protected:
+    void buildIndex() const;
+    std::string getLineAt(size_t offset) const;
+  public:
+    Ns2MotionTraceFile() : indexed(false) {}
+
+    /**
+     * Fills in the initial position and the waypoints of the given node.
+     * Returns false if the file does not specify the initial position.
+     */
+    bool getNode(int nodeId, Ns2MotionFile& node) const;
+};
+
+/**
+ * Singleton object to map and index ns2 motion files, so that the file
+ * is read only once no matter how many nodes use it.
+ *
+ * @ingroup mobility
+ */
+class INET_API Ns2MotionFileCache
+{
+  protected:
+    typedef std::map<std::string,Ns2MotionTraceFile*> Ns2FileMap;
+    Ns2FileMap cache;
+    static Ns2MotionFileCache *inst;
+    Ns2MotionFileCache() {}
+    virtual ~Ns2MotionFileCache();
+
+  public:
+    /**
+     * Returns the singleton instance.
+     */
+    static Ns2MotionFileCache *getInstance();
+
+    /**
+     * Deletes the singleton instance.
+     */
+    static void deleteInstance();
+
+    /**
+     * Returns the given file, mapping it on first use.
+     */
+    virtual const Ns2MotionTraceFile *getFile(const char *filename);
+};
+
+#endif
@@ -18,17 +18,9 @@
 //
 
 
-#include <fstream>
-#include <sstream>
-#include <string>
-
 #include "Ns2MotionMobility.h"
 #include "FWMath.h"
 
-#ifndef atoi
-#include <cstdlib>
-#endif
-
 
 Define_Module(Ns2MotionMobility);
 
@@ -46,84 +38,7 @@ Ns2MotionMobility::~Ns2MotionMobility()
 {
     if (ns2File)
         delete ns2File;
-}
-
-void Ns2MotionMobility::parseFile(const char *filename)
-{
-
-    std::ifstream in(filename, std::ios::in);
-
-    if (in.fail())
-        throw cRuntimeError("Cannot open file '%s'", filename);
-    ns2File->initial[0] = ns2File->initial[1] = ns2File->initial[2] = -1;
-    std::string line;
-    std::string subline;
-
-    while (std::getline(in, line))
-    {
-        // '#' line
-        int num_node;
-        std::string::size_type found = line.find('#');
-        if (found == 0)
-            continue;
-        if (found != std::string::npos)
-            subline = line;
-        else
-            subline = line.substr(0, found);
-        found = subline.find("$node_");
-        if (found == std::string::npos)
-            continue;
-        // Node Id
-        std::string::size_type pos1 = subline.find('(');
-        std::string::size_type pos2 = subline.find(')');
-        if (pos2-pos1>1)
-            num_node = std::atoi(subline.substr(pos1+1, pos2-1).c_str());
-        if (num_node!=nodeId)
-            continue;
-        // Initial position
-        found = subline.find("set ");
-        if (found!=std::string::npos)
-        {
-            // Initial position
-            found = subline.find("X_");
-            if (found!=std::string::npos)
-            {
-                ns2File->initial[0] = std::atof(subline.substr(found+3, std::string::npos).c_str());
-            }
-            found = subline.find("Y_");
-            if (found!=std::string::npos)
-            {
-                ns2File->initial[1] = std::atof(subline.substr(found+3, std::string::npos).c_str());
-            }
-
-            found = subline.find("Z_");
-            if (found!=std::string::npos)
-            {
-                ns2File->initial[2] = std::atof(subline.substr(found+3, std::string::npos).c_str());
-            }
-        }
-        found = subline.find("setdest");
-        if (found!=std::string::npos)
-        {
-            ns2File->lines.push_back(Ns2MotionFile::Line());
-            Ns2MotionFile::Line& vec = ns2File->lines.back();
-            // initial time
-            found = subline.find("at");
-            vec.push_back(std::atof(subline.substr(found+3).c_str()));
-
-            std::string parameters = subline.substr(subline.find("setdest ")+8, std::string::npos);
-
-            std::stringstream linestream(parameters);
-            double d;
-            while (linestream >> d)
-                vec.push_back(d);
-        }
-    }
-    in.close();
-    // exist data?
-    if (ns2File->initial[0]==-1 || ns2File->initial[1]==-1 || ns2File->initial[2]==-1)
-        throw cRuntimeError("node '%d' Error ns2 motion file '%s'", nodeId, filename);
-
+    Ns2MotionFileCache::deleteInstance();
 }
 
 void Ns2MotionMobility::initialize(int stage)
@@ -140,7 +55,8 @@ void Ns2MotionMobility::initialize(int stage)
             nodeId = getContainingNode(this)->getIndex();
         const char *fname = par("traceFile");
         ns2File = new Ns2MotionFile;
-        parseFile(fname);
+        if (!Ns2MotionFileCache::getInstance()->getFile(fname)->getNode(nodeId, *ns2File))
+            throw cRuntimeError("node '%d' Error ns2 motion file '%s'", nodeId, fname);
         vecpos = 0;
         WATCH(nodeId);
     }
@@ -24,6 +24,7 @@
 #include "INETDefs.h"
 
 #include "LineSegmentsMobilityBase.h"
+#include "Ns2MotionFileCache.h"
 
 
 /**
@@ -32,23 +33,6 @@
  * @ingroup mobility
  * @author Alfonso Ariza
  */
-
-class Ns2MotionMobility;
-
-/**
- * Represents a ns2 motion file's contents.
- */
-class INET_API Ns2MotionFile
-{
-  public:
-    typedef std::vector<double> Line;
-    double initial[3];
-  protected:
-    friend class Ns2MotionMobility;
-    typedef std::vector<Line> LineList;
-    LineList lines;
-};
-
 class INET_API Ns2MotionMobility : public LineSegmentsMobilityBase
 {
   protected:
@@ -60,8 +44,6 @@ class INET_API Ns2MotionMobility : public LineSegmentsMobilityBase
     double scrollY;
 
   protected:
-    void parseFile(const char *filename);
-
     virtual int numInitStages() const { return 3; }
 
     /** @brief Initializes mobility model parameters.*/
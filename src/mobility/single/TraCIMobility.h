@@ -69,7 +69,7 @@ class INET_API TraCIMobility : public MobilityBase
                 void recordScalars(cSimpleModule& module);
         };
 
-        TraCIMobility() : MobilityBase(), isPreInitialized(false) {}
+        TraCIMobility() : MobilityBase(), isPreInitialized(false), lanePosition(-1), lanePositionValid(false) {}
         virtual int numInitStages() const { return 3; }
         virtual void initialize(int stage);
         virtual void setInitialPosition();
@@ -116,6 +116,20 @@ class INET_API TraCIMobility : public MobilityBase
             if (angle == M_PI) throw cRuntimeError("TraCIMobility::getAngleRad called with no angle set yet");
             return angle;
         }
+        /**
+         * position along the current lane, as reported with the last position update
+         */
+        virtual void setLanePosition(double lanePosition) {
+            this->lanePosition = lanePosition;
+            lanePositionValid = true;
+        }
+        virtual bool hasLanePosition() const {
+            return lanePositionValid;
+        }
+        virtual double getLanePosition() const {
+            if (!lanePositionValid) throw cRuntimeError("TraCIMobility::getLanePosition called with no lane position set yet");
+            return lanePosition;
+        }
         virtual TraCIScenarioManager* getManager() const {
             if (!manager) manager = TraCIScenarioManagerAccess().get();
             return manager;
@@ -123,6 +137,9 @@ class INET_API TraCIMobility : public MobilityBase
         void commandSetSpeedMode(int32_t bitset) {
             getManager()->commandSetSpeedMode(getExternalId(), bitset);
         }
+        double commandGetLanePosition() {
+            return getManager()->commandGetLanePosition(getExternalId());
+        }
         void commandSetSpeed(double speed) {
             getManager()->commandSetSpeed(getExternalId(), speed);
         }
@@ -180,6 +197,8 @@ class INET_API TraCIMobility : public MobilityBase
         double speed; /**< updated by nextPosition() */
         double angle; /**< updated by nextPosition() */
         TraCIScenarioManager::VehicleSignal signals; /**<updated by nextPosition() */
+        double lanePosition; /**< updated by setLanePosition() */
+        bool lanePositionValid;
 
         cMessage* startAccidentMsg;
         cMessage* stopAccidentMsg;
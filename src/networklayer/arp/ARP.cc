@@ -83,6 +83,9 @@ void ARP::initialize(int stage)
         respondToProxyARP = par("respondToProxyARP");
         globalARP = par("globalARP");
 
+        // request timeouts expire at their exact times, the granularity only affects bucketing
+        timerWheel.initialize(this, 0.01);
+
         netwOutGate = gate("netwOut");
 
         // init statistics
@@ -145,6 +148,8 @@ ARP::~ARP()
     while (!arpCache.empty())
     {
         ARPCache::iterator i = arpCache.begin();
+        if ((*i).second->timer)
+            delete timerWheel.cancel((*i).second->timer);
         delete (*i).second;
         arpCache.erase(i);
     }
@@ -171,9 +176,11 @@ void ARP::handleMessage(cMessage *msg)
         return;
     }
 
-    if (msg->isSelfMessage())
+    if (timerWheel.isTickEvent(msg))
     {
-        requestTimedOut(msg);
+        cMessage *timer;
+        while ((timer = timerWheel.popExpired()) != NULL)
+            requestTimedOut(timer);
     }
     else
     {
@@ -238,7 +245,7 @@ void ARP::flush()
         ARPCache::iterator i = arpCache.begin();
         ARPCacheEntry *entry = i->second;
         if (entry->timer) {
-            delete cancelEvent(entry->timer);
+            delete timerWheel.cancel(entry->timer);
             entry->timer = NULL;
         }
         delete entry;
@@ -274,7 +281,7 @@ void ARP::initiateARPResolution(ARPCacheEntry *entry)
     // start timer
     cMessage *msg = entry->timer = new cMessage("ARP timeout");
     msg->setContextPointer(entry);
-    scheduleAt(simTime()+retryTimeout, msg);
+    timerWheel.scheduleAt(simTime()+retryTimeout, msg);
 
     numResolutions++;
     Notification signal(nextHopAddr, MACAddress::UNSPECIFIED_ADDRESS, entry->ie);
@@ -327,7 +334,7 @@ void ARP::requestTimedOut(cMessage *selfmsg)
         IPv4Address nextHopAddr = entry->myIter->first;
         EV << "ARP request for " << nextHopAddr << " timed out, resending\n";
         sendARPRequest(entry->ie, nextHopAddr);
-        scheduleAt(simTime()+retryTimeout, selfmsg);
+        timerWheel.scheduleAt(simTime()+retryTimeout, selfmsg);
         return;
     }
 
@@ -503,7 +510,7 @@ void ARP::updateARPCache(ARPCacheEntry *entry, const MACAddress& macAddress)
     if (entry->pending)
     {
         entry->pending = false;
-        delete cancelEvent(entry->timer);
+        delete timerWheel.cancel(entry->timer);
         entry->timer = NULL;
         entry->numRetries = 0;
     }
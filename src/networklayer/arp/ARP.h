@@ -29,6 +29,7 @@
 #include "MACAddress.h"
 #include "ModuleAccess.h"
 #include "NotificationBoard.h"
+#include "TimerWheel.h"
 
 // Forward declarations:
 class ARPPacket;
@@ -87,6 +88,8 @@ class INET_API ARP : public cSimpleModule, public IARPCache, public ILifecycle,
 
     cGate *netwOutGate;
 
+    TimerWheel timerWheel;  // holds the request timeouts of pending entries
+
     IInterfaceTable *ift;
     IRoutingTable *rt;  // for answering ProxyARP requests
 
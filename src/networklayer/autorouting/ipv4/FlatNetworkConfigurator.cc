@@ -153,6 +153,11 @@ void FlatNetworkConfigurator::addDefaultRoutes(cTopology& topo, NodeInfoVector&
 
 void FlatNetworkConfigurator::fillRoutingTables(cTopology& topo, NodeInfoVector& nodeInfo)
 {
+    // every table receives a route per destination: update them as one batch each
+    for (int i=0; i<topo.getNumNodes(); i++)
+        if (nodeInfo[i].isIPNode)
+            nodeInfo[i].rt->beginBatch();
+
     // fill in routing tables with static routes
     for (int i=0; i<topo.getNumNodes(); i++)
     {
@@ -205,6 +210,10 @@ void FlatNetworkConfigurator::fillRoutingTables(cTopology& topo, NodeInfoVector&
             rt->addRoute(e);
         }
     }
+
+    for (int i=0; i<topo.getNumNodes(); i++)
+        if (nodeInfo[i].isIPNode)
+            nodeInfo[i].rt->commitBatch();
 }
 
 void FlatNetworkConfigurator::handleMessage(cMessage *msg)
@@ -205,6 +205,7 @@ void IPv4NetworkConfigurator::configureInterface(InterfaceInfo *interfaceInfo)
 
 void IPv4NetworkConfigurator::configureRoutingTable(Node *node)
 {
+    node->routingTable->beginBatch();
     for (int i = 0; i < (int)node->staticRoutes.size(); i++) {
         IPv4Route *original = node->staticRoutes[i];
         IPv4Route *clone = new IPv4Route();
@@ -217,6 +218,7 @@ void IPv4NetworkConfigurator::configureRoutingTable(Node *node)
         clone->setInterface(original->getInterface());
         node->routingTable->addRoute(clone);
     }
+    node->routingTable->commitBatch();
     for (int i = 0; i < (int)node->staticMulticastRoutes.size(); i++) {
         IPv4MulticastRoute *original = node->staticMulticastRoutes[i];
         IPv4MulticastRoute *clone = new IPv4MulticastRoute();
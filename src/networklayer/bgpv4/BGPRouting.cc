@@ -288,7 +288,10 @@ void BGPRouting::processMessage(const BGPUpdateMessage& msg)
     if (decisionProcessResult == BGP::ASLOOP_NO_DETECTED)
     {
         // RFC 4271, 9.1.  Decision Process
+        // replacing a route takes a delete and an add: re-sort and notify once
+        _rt->beginBatch();
         decisionProcessResult = decisionProcess(msg, entry, _currSessionId);
+        _rt->commitBatch();
         //RFC 4271, 9.2.  Update-Send Process
         if (decisionProcessResult != 0)
         {
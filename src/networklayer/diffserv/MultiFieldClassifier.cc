@@ -16,6 +16,10 @@
 // along with this program; if not, see <http://www.gnu.org/licenses/>.
 //
 
+#include <algorithm>
+#include <climits>
+#include <set>
+
 #include "INETDefs.h"
 #include "IPvXAddress.h"
 #include "IPvXAddressResolver.h"
@@ -125,6 +129,89 @@ bool MultiFieldClassifier::Filter::matches(IPv6Datagram *datagram)
 }
 #endif
 
+static bool increment(int& value)
+{
+    if (value == INT_MAX)
+        return false;
+    value++;
+    return true;
+}
+
+static bool increment(uint32& value)
+{
+    if (value == 0xffffffffu)
+        return false;
+    value++;
+    return true;
+}
+
+static bool increment(IPv6Address& value)
+{
+    uint32 *d = value.words();
+    for (int i = 3; i >= 0; i--)
+        if (++d[i] != 0)
+            return true;
+    return false;
+}
+
+template <typename T>
+void MultiFieldClassifier::FieldIndex<T>::build(const std::vector<std::pair<T, T> >& ranges, const T& minValue)
+{
+    numWords = (ranges.size() + 31) / 32;
+
+    // the intervals start at the lower bounds of the ranges and right after their upper bounds
+    std::set<T> bounds;
+    bounds.insert(minValue);
+    for (unsigned int i = 0; i < ranges.size(); i++)
+    {
+        if (ranges[i].second < ranges[i].first)
+            continue;
+        bounds.insert(ranges[i].first);
+        T next = ranges[i].second;
+        if (increment(next))
+            bounds.insert(next);
+    }
+    lowerBounds.assign(bounds.begin(), bounds.end());
+
+    bits.assign(lowerBounds.size() * numWords, 0);
+    for (unsigned int i = 0; i < ranges.size(); i++)
+    {
+        if (ranges[i].second < ranges[i].first)
+            continue;
+        unsigned int k = std::lower_bound(lowerBounds.begin(), lowerBounds.end(), ranges[i].first) - lowerBounds.begin();
+        for ( ; k < lowerBounds.size() && !(ranges[i].second < lowerBounds[k]); k++)
+            bits[k * numWords + i / 32] |= 1u << (i % 32);
+    }
+}
+
+template <typename T>
+const uint32 *MultiFieldClassifier::FieldIndex<T>::lookup(const T& value) const
+{
+    unsigned int k = std::upper_bound(lowerBounds.begin(), lowerBounds.end(), value) - lowerBounds.begin();
+    ASSERT(k > 0);
+    return &bits[(k - 1) * numWords];
+}
+
+static void getPorts(cPacket *packet, int& srcPort, int& destPort)
+{
+    srcPort = destPort = -1;
+#ifdef WITH_UDP
+    UDPPacket *udpPacket = dynamic_cast<UDPPacket*>(packet);
+    if (udpPacket)
+    {
+        srcPort = udpPacket->getSourcePort();
+        destPort = udpPacket->getDestinationPort();
+    }
+#endif
+#ifdef WITH_TCP_COMMON
+    TCPSegment *tcpSegment = dynamic_cast<TCPSegment*>(packet);
+    if (tcpSegment)
+    {
+        srcPort = tcpSegment->getSrcPort();
+        destPort = tcpSegment->getDestPort();
+    }
+#endif
+}
 
 Define_Module(MultiFieldClassifier);
 
@@ -146,6 +233,7 @@ void MultiFieldClassifier::initialize(int stage)
     {
         cXMLElement *config = par("filters").xmlValue();
         configureFilters(config);
+        buildIndex();
     }
 }
 
@@ -172,26 +260,45 @@ void MultiFieldClassifier::handleMessage(cMessage *msg)
 
 int MultiFieldClassifier::classifyPacket(cPacket *packet)
 {
+    if (filters.empty())
+        return -1;  // the indices are empty, there is nothing to look up
+
     for (; packet; packet = packet->getEncapsulatedPacket())
     {
 #ifdef WITH_IPv4
         IPv4Datagram *ipv4Datagram = dynamic_cast<IPv4Datagram*>(packet);
         if (ipv4Datagram)
         {
-            for (std::vector<Filter>::iterator it = filters.begin(); it != filters.end(); ++it)
-                if (it->matches(ipv4Datagram))
-                    return it->gateIndex;
-            return -1;
+            int srcPort = -1, destPort = -1;
+            if (usesPorts)
+                getPorts(ipv4Datagram->getEncapsulatedPacket(), srcPort, destPort);
+            const uint32 *fieldBits[] = {
+                srcAddrIndex4.lookup(ipv4Datagram->getSrcAddress().getInt()),
+                destAddrIndex4.lookup(ipv4Datagram->getDestAddress().getInt()),
+                protocolIndex.lookup(ipv4Datagram->getTransportProtocol()),
+                &tosBits[(ipv4Datagram->getTypeOfService() & 0xff) * numWords],
+                srcPortIndex.lookup(srcPort),
+                destPortIndex.lookup(destPort)
+            };
+            return findFirstMatch(fieldBits, 6);
         }
 #endif
 #ifdef WITH_IPv6
         IPv6Datagram *ipv6Datagram = dynamic_cast<IPv6Datagram *>(packet);
         if (ipv6Datagram)
         {
-            for (std::vector<Filter>::iterator it = filters.begin(); it != filters.end(); ++it)
-                if (it->matches(ipv6Datagram))
-                    return it->gateIndex;
-            return -1;
+            int srcPort = -1, destPort = -1;
+            if (usesPorts)
+                getPorts(ipv6Datagram->getEncapsulatedPacket(), srcPort, destPort);
+            const uint32 *fieldBits[] = {
+                srcAddrIndex6.lookup(ipv6Datagram->getSrcAddress()),
+                destAddrIndex6.lookup(ipv6Datagram->getDestAddress()),
+                protocolIndex.lookup(ipv6Datagram->getTransportProtocol()),
+                &tosBits[(ipv6Datagram->getTrafficClass() & 0xff) * numWords],
+                srcPortIndex.lookup(srcPort),
+                destPortIndex.lookup(destPort)
+            };
+            return findFirstMatch(fieldBits, 6);
         }
 #endif
     }
@@ -199,6 +306,110 @@ int MultiFieldClassifier::classifyPacket(cPacket *packet)
     return -1;
 }
 
+int MultiFieldClassifier::findFirstMatch(const uint32 *fieldBits[], int numFields)
+{
+    for (int w = 0; w < numWords; w++)
+    {
+        uint32 word = fieldBits[0][w];
+        for (int k = 1; k < numFields && word; k++)
+            word &= fieldBits[k][w];
+        if (word)
+        {
+            int i = w * 32;
+            while (!(word & 1))
+            {
+                word >>= 1;
+                i++;
+            }
+            return filters[i].gateIndex;
+        }
+    }
+    return -1;
+}
+
+void MultiFieldClassifier::buildIndex()
+{
+    typedef std::pair<uint32, uint32> Range4;
+    typedef std::pair<IPv6Address, IPv6Address> Range6;
+    typedef std::pair<int, int> IntRange;
+    const Range4 all4(0, 0xffffffffu), none4(1, 0);
+    const Range6 all6(IPv6Address(0, 0, 0, 0), IPv6Address(0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu));
+    const Range6 none6(IPv6Address(0, 0, 0, 1), IPv6Address(0, 0, 0, 0));
+    const IntRange allInts(INT_MIN, INT_MAX);
+
+    std::vector<Range4> srcRanges4, destRanges4;
+    std::vector<Range6> srcRanges6, destRanges6;
+    std::vector<IntRange> protocolRanges, srcPortRanges, destPortRanges;
+    usesPorts = false;
+    for (std::vector<Filter>::iterator it = filters.begin(); it != filters.end(); ++it)
+    {
+        // address filters of one IP version never match datagrams of the other version
+        if (it->srcPrefixLength == 0)
+        {
+            srcRanges4.push_back(all4);
+            srcRanges6.push_back(all6);
+        }
+        else if (it->srcAddr.isIPv6())
+        {
+            srcRanges4.push_back(none4);
+            IPv6Address prefix = it->srcAddr.get6().getPrefix(it->srcPrefixLength);
+            IPv6Address mask = IPv6Address::constructMask(it->srcPrefixLength);
+            const uint32 *p = prefix.words(), *m = mask.words();
+            srcRanges6.push_back(Range6(prefix, IPv6Address(p[0] | ~m[0], p[1] | ~m[1], p[2] | ~m[2], p[3] | ~m[3])));
+        }
+        else
+        {
+            uint32 mask = IPv4Address::makeNetmask(it->srcPrefixLength).getInt();
+            uint32 prefix = it->srcAddr.get4().getInt() & mask;
+            srcRanges4.push_back(Range4(prefix, prefix | ~mask));
+            srcRanges6.push_back(none6);
+        }
+
+        if (it->destPrefixLength == 0)
+        {
+            destRanges4.push_back(all4);
+            destRanges6.push_back(all6);
+        }
+        else if (it->destAddr.isIPv6())
+        {
+            destRanges4.push_back(none4);
+            IPv6Address prefix = it->destAddr.get6().getPrefix(it->destPrefixLength);
+            IPv6Address mask = IPv6Address::constructMask(it->destPrefixLength);
+            const uint32 *p = prefix.words(), *m = mask.words();
+            destRanges6.push_back(Range6(prefix, IPv6Address(p[0] | ~m[0], p[1] | ~m[1], p[2] | ~m[2], p[3] | ~m[3])));
+        }
+        else
+        {
+            uint32 mask = IPv4Address::makeNetmask(it->destPrefixLength).getInt();
+            uint32 prefix = it->destAddr.get4().getInt() & mask;
+            destRanges4.push_back(Range4(prefix, prefix | ~mask));
+            destRanges6.push_back(none6);
+        }
+
+        protocolRanges.push_back(it->protocol >= 0 ? IntRange(it->protocol, it->protocol) : allInts);
+        // packets without ports are looked up with port -1, which is outside of every port range
+        srcPortRanges.push_back(it->srcPortMin >= 0 ? IntRange(it->srcPortMin, it->srcPortMax) : allInts);
+        destPortRanges.push_back(it->destPortMin >= 0 ? IntRange(it->destPortMin, it->destPortMax) : allInts);
+        if (it->srcPortMin >= 0 || it->destPortMin >= 0)
+            usesPorts = true;
+    }
+
+    numWords = (filters.size() + 31) / 32;
+    srcAddrIndex4.build(srcRanges4, 0);
+    destAddrIndex4.build(destRanges4, 0);
+    srcAddrIndex6.build(srcRanges6, IPv6Address(0, 0, 0, 0));
+    destAddrIndex6.build(destRanges6, IPv6Address(0, 0, 0, 0));
+    protocolIndex.build(protocolRanges, INT_MIN);
+    srcPortIndex.build(srcPortRanges, INT_MIN);
+    destPortIndex.build(destPortRanges, INT_MIN);
+
+    tosBits.assign(256 * numWords, 0);
+    for (int tos = 0; tos < 256; tos++)
+        for (unsigned int i = 0; i < filters.size(); i++)
+            if (filters[i].tosMask == 0 || (filters[i].tos & filters[i].tosMask) == (tos & filters[i].tosMask))
+                tosBits[tos * numWords + i / 32] |= 1u << (i % 32);
+}
+
 void MultiFieldClassifier::addFilter(const Filter &filter)
 {
     if (filter.gateIndex < 0 || filter.gateIndex >= numOutGates)
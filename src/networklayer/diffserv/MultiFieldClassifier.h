@@ -20,7 +20,10 @@
 #ifndef __INET_MULTIFIELDCLASSIFIER_H
 #define __INET_MULTIFIELDCLASSIFIER_H
 
+#include <vector>
+
 #include "INETDefs.h"
+#include "IPvXAddress.h"
 
 /**
  * Absolute dropper.
@@ -55,10 +58,50 @@ class INET_API MultiFieldClassifier : public cSimpleModule
     #endif
         };
 
+        /**
+         * One field of the packet compiled into elementary intervals of
+         * its value range. Every interval has a bit vector of the filters
+         * that accept all values in it: bit i%32 of word i/32 is set for
+         * the ith filter.
+         */
+        template <typename T>
+        class FieldIndex
+        {
+          protected:
+            int numWords;
+            std::vector<T> lowerBounds;  // sorted, interval k is [lowerBounds[k], lowerBounds[k+1])
+            std::vector<uint32> bits;  // numWords words per interval
+
+          public:
+            FieldIndex() : numWords(0) {}
+
+            /**
+             * ranges[i] is the inclusive range of values accepted by the ith
+             * filter, or an empty range (second < first) if it accepts none.
+             * minValue is the smallest possible value of the field.
+             */
+            void build(const std::vector<std::pair<T, T> >& ranges, const T& minValue);
+
+            /** Returns the bit vector of the filters that accept the value */
+            const uint32 *lookup(const T& value) const;
+        };
+
   protected:
     int numOutGates;
     std::vector<Filter> filters;
 
+    // filters compiled into one index per field, see buildIndex()
+    int numWords;
+    FieldIndex<uint32> srcAddrIndex4;
+    FieldIndex<uint32> destAddrIndex4;
+    FieldIndex<IPv6Address> srcAddrIndex6;
+    FieldIndex<IPv6Address> destAddrIndex6;
+    FieldIndex<int> protocolIndex;
+    FieldIndex<int> srcPortIndex;
+    FieldIndex<int> destPortIndex;
+    std::vector<uint32> tosBits;  // numWords words for each of the 256 ToS/traffic class values
+    bool usesPorts;  // whether any filter checks ports; if not, the transport header is not looked at
+
     int numRcvd;
 
     static simsignal_t pkClassSignal;
@@ -67,8 +110,19 @@ class INET_API MultiFieldClassifier : public cSimpleModule
     void addFilter(const Filter &filter);
     void configureFilters(cXMLElement *config);
 
+    /**
+     * Compiles the filters into the field indices. The first filter that
+     * matches a packet is the first bit set in the intersection of the bit
+     * vectors of its fields, so classification does not depend on the
+     * number of filters, only on the number of words in the bit vectors.
+     */
+    virtual void buildIndex();
+
+    /** Returns the gate index of the first filter found in all bit vectors, or -1 */
+    int findFirstMatch(const uint32 *fieldBits[], int numFields);
+
   public:
-    MultiFieldClassifier() {}
+    MultiFieldClassifier() : numWords(0), usesPorts(false) {}
 
   protected:
     virtual int numInitStages() const { return 4; }
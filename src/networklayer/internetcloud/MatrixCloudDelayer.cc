@@ -17,6 +17,8 @@
 // @author Zoltan Bojthe
 //
 
+#include <algorithm>
+
 #include "MatrixCloudDelayer.h"
 
 #include "InterfaceTableAccess.h"
@@ -50,6 +52,55 @@ bool getBoolAttribute(const cXMLElement &element, const char *name, const bool *
     throw cRuntimeError("Invalid boolean attribute %s = '%s' at %s", name, s, element.getSourceLocation());
 }
 
+std::string removeWhitespace(const char *s)
+{
+    std::string result;
+    for ( ; *s; s++)
+        if (!isspace((unsigned char)*s))
+            result += *s;
+    return result;
+}
+
+/**
+ * Splits text at the separator characters that are outside parentheses.
+ * Returns false if the parentheses are unbalanced.
+ */
+bool splitTopLevel(const std::string& text, char separator, std::vector<std::string>& parts)
+{
+    int depth = 0;
+    std::string::size_type start = 0;
+    for (std::string::size_type i = 0; i < text.size(); i++)
+    {
+        char c = text[i];
+        if (c == '(')
+            depth++;
+        else if (c == ')' && --depth < 0)
+            return false;
+        else if (c == separator && depth == 0)
+        {
+            parts.push_back(text.substr(start, i - start));
+            start = i + 1;
+        }
+    }
+    parts.push_back(text.substr(start));
+    return depth == 0;
+}
+
+/**
+ * Splits "name(args)" into name and the top-level arguments.
+ */
+bool splitCall(const std::string& text, std::string& name, std::vector<std::string>& args)
+{
+    std::string::size_type paren = text.find('(');
+    if (paren == std::string::npos || paren == 0 || text[text.size() - 1] != ')')
+        return false;
+    name = text.substr(0, paren);
+    for (std::string::size_type i = 0; i < name.size(); i++)
+        if (!isalnum((unsigned char)name[i]) && name[i] != '_')
+            return false;
+    return splitTopLevel(text.substr(paren + 1, text.size() - paren - 2), ',', args);
+}
+
 } // namespace
 
 
@@ -91,23 +142,195 @@ bool MatrixCloudDelayer::Matcher::matches(const char *s)
 }
 
 
-MatrixCloudDelayer::MatrixEntry::MatrixEntry(cXMLElement *trafficEntity, bool defaultSymmetric) :
-        srcMatcher(trafficEntity->getAttribute("src")), destMatcher(trafficEntity->getAttribute("dest"))
+void MatrixCloudDelayer::TrafficParameter::parse(const char *text, const char *unit, cComponent *context)
+{
+    this->unit = unit;
+    expression.parse(text);
+    type = EXPRESSION;
+    try
+    {
+        if (expression.isAConstant())
+        {
+            constant = unit ? expression.doubleValue(context, unit) : expression.boolValue(context);
+            type = CONSTANT;
+        }
+        else if (!parseFastPath(removeWhitespace(text), context))
+            type = EXPRESSION;
+    }
+    catch (std::exception&)
+    {
+        // leave the error to the per-packet evaluation, like before
+        type = EXPRESSION;
+    }
+}
+
+bool MatrixCloudDelayer::TrafficParameter::parseFastPath(const std::string& text, cComponent *context)
+{
+    if (unit)
+        return parseMax(text, context);
+
+    // bool parameter: "random < C"
+    std::string::size_type pos = text.find('<');
+    if (pos == std::string::npos || text.find_first_of("<>=!&|?", pos + 1) != std::string::npos
+            || text.find_first_of(">=!&|?") < pos)
+        return false;
+    std::vector<std::string> parts;
+    if (!splitTopLevel(text, '<', parts) || parts.size() != 2)
+        return false;
+    if (!evaluateConstant(parts[1], context, NULL, threshold) || !parseMax(parts[0], context))
+        return false;
+    if (type == CONSTANT)
+        constant = constant < threshold;
+    else
+        hasThreshold = true;
+    return true;
+}
+
+bool MatrixCloudDelayer::TrafficParameter::parseMax(const std::string& text, cComponent *context)
+{
+    std::string name;
+    std::vector<std::string> args;
+    if (splitCall(text, name, args) && name == "max" && args.size() == 2)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            if (evaluateConstant(args[i], context, unit, lowerBound) && parseSum(args[1 - i], context))
+            {
+                if (type == CONSTANT)
+                    constant = std::max(constant, lowerBound);
+                else
+                    hasLowerBound = true;
+                return true;
+            }
+        }
+        return false;
+    }
+    return parseSum(text, context);
+}
+
+bool MatrixCloudDelayer::TrafficParameter::parseSum(const std::string& text, cComponent *context)
+{
+    std::vector<std::string> terms;
+    if (!splitTopLevel(text, '+', terms))
+        return false;
+
+    // constant terms are folded, at most one term may be a distribution
+    double sum = 0;
+    int randomTerm = -1;
+    for (int i = 0; i < (int)terms.size(); i++)
+    {
+        double value;
+        if (evaluateConstant(terms[i], context, unit, value))
+            sum += value;
+        else if (randomTerm == -1)
+            randomTerm = i;
+        else
+            return false;
+    }
+    if (randomTerm == -1)
+        type = CONSTANT;
+    else if (!parseDistribution(terms[randomTerm], context))
+        return false;
+    constant = sum;
+    return true;
+}
+
+bool MatrixCloudDelayer::TrafficParameter::parseDistribution(const std::string& text, cComponent *context)
+{
+    std::string name;
+    std::vector<std::string> args;
+    if (!splitCall(text, name, args))
+        return false;
+    Type t;
+    if (name == "uniform" && args.size() == 2)
+        t = UNIFORM;
+    else if (name == "exponential" && args.size() == 1)
+        t = EXPONENTIAL;
+    else if (name == "normal" && args.size() == 2)
+        t = NORMAL;
+    else if (name == "truncnormal" && args.size() == 2)
+        t = TRUNCNORMAL;
+    else
+        return false;   // unknown function, or explicit rng argument
+    // the arguments of the random in "random < C" are dimensionless like C
+    if (!evaluateConstant(args[0], context, unit, a))
+        return false;
+    if (args.size() == 2 && !evaluateConstant(args[1], context, unit, b))
+        return false;
+    type = t;
+    return true;
+}
+
+bool MatrixCloudDelayer::TrafficParameter::evaluateConstant(const std::string& text, cComponent *context, const char *unit, double& value)
+{
+    try
+    {
+        cDynamicExpression e;
+        e.parse(text.c_str());
+        if (!e.isAConstant())
+            return false;
+        value = e.doubleValue(context, unit);
+        return true;
+    }
+    catch (std::exception&)
+    {
+        return false;
+    }
+}
+
+double MatrixCloudDelayer::TrafficParameter::randomValue(cComponent *context)
+{
+    double value;
+    switch (type)
+    {
+        case CONSTANT: return constant;
+        case UNIFORM: value = constant + uniform(a, b); break;
+        case EXPONENTIAL: value = constant + exponential(a); break;
+        case NORMAL: value = constant + normal(a, b); break;
+        case TRUNCNORMAL: value = constant + truncnormal(a, b); break;
+        default: return expression.doubleValue(context, unit);
+    }
+    if (hasLowerBound && value < lowerBound)
+        value = lowerBound;
+    return value;
+}
+
+double MatrixCloudDelayer::TrafficParameter::doubleValue(cComponent *context)
+{
+    ASSERT(unit);
+    return randomValue(context);
+}
+
+bool MatrixCloudDelayer::TrafficParameter::boolValue(cComponent *context)
+{
+    ASSERT(!unit);
+    switch (type)
+    {
+        case CONSTANT: return constant != 0;
+        case EXPRESSION: return expression.boolValue(context);
+        default: return randomValue(context) < threshold;
+    }
+}
+
+
+MatrixCloudDelayer::MatrixEntry::MatrixEntry(cXMLElement *trafficEntity, bool defaultSymmetric, cComponent *context) :
+        srcMatcher(trafficEntity->getAttribute("src")), destMatcher(trafficEntity->getAttribute("dest")),
+        entity(trafficEntity)
 {
     const char *delayAttr = trafficEntity->getAttribute("delay");
     const char *datarateAttr = trafficEntity->getAttribute("datarate");
     const char *dropAttr = trafficEntity->getAttribute("drop");
     symmetric = getBoolAttribute(*trafficEntity, "symmetric", &defaultSymmetric);
     try {
-        delayPar.parse(delayAttr);
+        delayPar.parse(delayAttr, "s", context);
     } catch (std::exception& e) { throw cRuntimeError("parser error '%s' in 'delay' attribute of '%s' entity at %s", e.what(), trafficEntity->getTagName(), trafficEntity->getSourceLocation()); }
 
     try {
-        dataratePar.parse(datarateAttr);
+        dataratePar.parse(datarateAttr, "bps", context);
     } catch (std::exception& e) { throw cRuntimeError("parser error '%s' in 'datarate' attribute of '%s' entity at %s", e.what(), trafficEntity->getTagName(), trafficEntity->getSourceLocation()); }
 
     try {
-        dropPar.parse(dropAttr);
+        dropPar.parse(dropAttr, NULL, context);
     } catch (std::exception& e) { throw cRuntimeError("parser error '%s' in 'drop' attribute of '%s' entity at %s", e.what(), trafficEntity->getTagName(), trafficEntity->getSourceLocation()); }
 }
 
@@ -147,7 +370,7 @@ void MatrixCloudDelayer::initialize(int stage)
         for (int i = 0; i < (int) trafficEntities.size(); i++)
         {
             cXMLElement *trafficEntity = trafficEntities[i];
-            MatrixEntry *matrixEntry = new MatrixEntry(trafficEntity, defaultSymmetric);
+            MatrixEntry *matrixEntry = new MatrixEntry(trafficEntity, defaultSymmetric, this);
             matrixEntries.push_back(matrixEntry);
         }
     }
@@ -161,8 +384,8 @@ void MatrixCloudDelayer::calculateDropAndDelay(const cMessage *msg, int srcID, i
     outDelay = SIMTIME_ZERO;
     if (!outDrop)
     {
-        outDelay = descriptor->delayPar->doubleValue(this, "s");
-        double datarate = descriptor->dataratePar->doubleValue(this, "bps");
+        outDelay = descriptor->delayPar->doubleValue(this);
+        double datarate = descriptor->dataratePar->doubleValue(this);
         ASSERT(outDelay >= 0);
         ASSERT(datarate > 0.0);
         simtime_t curTime = simTime();
@@ -177,12 +400,29 @@ void MatrixCloudDelayer::calculateDropAndDelay(const cMessage *msg, int srcID, i
     }
 }
 
+int MatrixCloudDelayer::getMatrixIndex(int id)
+{
+    unsigned int k = id + 1;  // id is -1 for packets sent by the node itself
+    if (k >= idToMatrixIndex.size())
+        idToMatrixIndex.resize(k + 1, -1);
+    if (idToMatrixIndex[k] == -1)
+    {
+        int index = descriptorMatrix.size();
+        idToMatrixIndex[k] = index;
+        descriptorMatrix.push_back(DescriptorVector());
+        for (unsigned int i = 0; i < descriptorMatrix.size(); i++)
+            descriptorMatrix[i].resize(index + 1);
+    }
+    return idToMatrixIndex[k];
+}
+
 MatrixCloudDelayer::Descriptor* MatrixCloudDelayer::getOrCreateDescriptor(int srcID, int destID)
 {
-    IDPair idPair(srcID, destID);
-    IDPairToDescriptorMap::iterator it = idPairToDescriptorMap.find(idPair);
-    if (it != idPairToDescriptorMap.end())
-        return &(it->second);
+    int srcIndex = getMatrixIndex(srcID);
+    int destIndex = getMatrixIndex(destID);
+    Descriptor *descriptor = &descriptorMatrix[srcIndex][destIndex];
+    if (descriptor->delayPar)
+        return descriptor;
 
     std::string src = getPathOfConnectedNodeOnIfaceID(srcID);
     std::string dest = getPathOfConnectedNodeOnIfaceID(destID);
@@ -194,22 +434,19 @@ MatrixCloudDelayer::Descriptor* MatrixCloudDelayer::getOrCreateDescriptor(int sr
         MatrixEntry *matrixEntry = matrixEntries[i];
         if (matrixEntry->matches(src.c_str(), dest.c_str()))
         {
-            MatrixCloudDelayer::Descriptor& descriptor = idPairToDescriptorMap[idPair];
-            descriptor.delayPar = &matrixEntry->delayPar;
-            descriptor.dataratePar = &matrixEntry->dataratePar;
-            descriptor.dropPar = &matrixEntry->dropPar;
-            descriptor.lastSent = simTime();
+            descriptor->delayPar = &matrixEntry->delayPar;
+            descriptor->dataratePar = &matrixEntry->dataratePar;
+            descriptor->dropPar = &matrixEntry->dropPar;
+            descriptor->lastSent = simTime();
             if (matrixEntry->symmetric)
             {
                 if (reverseMatrixEntry) // existing previous asymmetric entry which matching to (dest,src)
                     throw cRuntimeError("Inconsistent xml config between '%s' and '%s' nodes (at %s and %s)",
                             src.c_str(), dest.c_str(), matrixEntry->entity->getSourceLocation(),
                             reverseMatrixEntry->entity->getSourceLocation());
-                IDPair reverseIdPair(destID, srcID);
-                MatrixCloudDelayer::Descriptor& rdescriptor = idPairToDescriptorMap[reverseIdPair];
-                rdescriptor = descriptor;
+                descriptorMatrix[destIndex][srcIndex] = *descriptor;
             }
-            return &descriptor;
+            return descriptor;
         }
         else if (!matrixEntry->symmetric && !reverseMatrixEntry && matrixEntry->matches(dest.c_str(), src.c_str()))
         {
@@ -47,18 +47,56 @@ class INET_API MatrixCloudDelayer : public CloudDelayerBase
         bool matchesAny() { return matchesany; }
     };
 
+    /**
+     * A delay, datarate or drop attribute of a traffic entity. Constants,
+     * sums of constants and the common forms "[C +] dist(args)",
+     * "max(C, dist(args))" and "dist(args) < C" (dist is uniform,
+     * exponential, normal or truncnormal with constant arguments) are
+     * resolved at parse time, so that evaluation costs at most one random
+     * number; everything else is evaluated as an expression for each packet.
+     */
+    class TrafficParameter
+    {
+      public:
+        enum Type { EXPRESSION, CONSTANT, UNIFORM, EXPONENTIAL, NORMAL, TRUNCNORMAL };
+      protected:
+        Type type;
+        const char *unit;   // NULL for bool parameters
+        double constant;    // the value of CONSTANT, otherwise added to the random value
+        double a, b;        // parameters of the distribution
+        double lowerBound;  // from max(C, ...)
+        bool hasLowerBound;
+        double threshold;   // from "... < C", for bool parameters
+        bool hasThreshold;
+        cDynamicExpression expression;
+      protected:
+        bool parseFastPath(const std::string& text, cComponent *context);
+        bool parseMax(const std::string& text, cComponent *context);
+        bool parseSum(const std::string& text, cComponent *context);
+        bool parseDistribution(const std::string& text, cComponent *context);
+        bool evaluateConstant(const std::string& text, cComponent *context, const char *unit, double& value);
+        double randomValue(cComponent *context);
+      public:
+        TrafficParameter() : type(EXPRESSION), unit(NULL), constant(0), a(0), b(0), lowerBound(0),
+                hasLowerBound(false), threshold(0), hasThreshold(false) {}
+        void parse(const char *text, const char *unit, cComponent *context);
+        Type getType() const { return type; }
+        double doubleValue(cComponent *context);
+        bool boolValue(cComponent *context);
+    };
+
     class MatrixEntry
     {
       public:
         Matcher srcMatcher;
         Matcher destMatcher;
         bool symmetric;
-        cDynamicExpression delayPar;
-        cDynamicExpression dataratePar;
-        cDynamicExpression dropPar;
+        TrafficParameter delayPar;
+        TrafficParameter dataratePar;
+        TrafficParameter dropPar;
         cXMLElement *entity;
       public:
-        MatrixEntry(cXMLElement *trafficEntity, bool defaultSymmetric);
+        MatrixEntry(cXMLElement *trafficEntity, bool defaultSymmetric, cComponent *context);
         ~MatrixEntry() {}
         bool matches(const char *src, const char *dest);
     };
@@ -66,20 +104,20 @@ class INET_API MatrixCloudDelayer : public CloudDelayerBase
     class Descriptor
     {
       public:
-        cDynamicExpression *delayPar;
-        cDynamicExpression *dataratePar;
-        cDynamicExpression *dropPar;
+        TrafficParameter *delayPar;
+        TrafficParameter *dataratePar;
+        TrafficParameter *dropPar;
         simtime_t lastSent;
       public:
         Descriptor() : delayPar(NULL), dataratePar(NULL), dropPar(NULL), lastSent(SIMTIME_ZERO) {}
     };
 
-    typedef std::pair<int,int> IDPair;
-    typedef std::map<IDPair,Descriptor> IDPairToDescriptorMap;
+    typedef std::vector<Descriptor> DescriptorVector;
     typedef std::vector<MatrixEntry*> MatrixEntryPtrVector;
 
     MatrixEntryPtrVector matrixEntries;
-    IDPairToDescriptorMap idPairToDescriptorMap;
+    std::vector<int> idToMatrixIndex;  // interface id + 1 -> row/column of descriptorMatrix, or -1
+    std::vector<DescriptorVector> descriptorMatrix;  // [src][dest], delayPar is NULL until the pair is first seen
 
     IInterfaceTable *ift;
     cModule *host;
@@ -96,6 +134,9 @@ class INET_API MatrixCloudDelayer : public CloudDelayerBase
 
     MatrixCloudDelayer::Descriptor* getOrCreateDescriptor(int srcID, int destID);
 
+    /// returns the row/column of descriptorMatrix for the interface id, extending the matrix if needed
+    int getMatrixIndex(int id);
+
     /// returns path of connected node for the interface specified by 'id'
     std::string getPathOfConnectedNodeOnIfaceID(int id);
 };
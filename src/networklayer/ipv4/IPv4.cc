@@ -36,6 +36,12 @@
 #include "NodeStatus.h"
 #include "NotificationBoard.h"
 
+// module specific compile-time log level, see Compat.h
+#ifdef IPV4_LOG_LEVEL
+#  undef INET_LOG_LEVEL
+#  define INET_LOG_LEVEL  IPV4_LOG_LEVEL
+#endif
+
 Define_Module(IPv4);
 
 //TODO TRANSLATE
@@ -122,7 +128,7 @@ void IPv4::handleMessage(cMessage *msg)
 void IPv4::endService(cPacket *packet)
 {
     if (!isUp) {
-        EV << "IPv4 is down -- discarding message\n";
+        EV_LOG(DETAIL) << "IPv4 is down -- discarding message\n";
         delete packet;
         return;
     }
@@ -172,13 +178,13 @@ void IPv4::handleIncomingDatagram(IPv4Datagram *datagram, const InterfaceEntry *
         double relativeHeaderLength = datagram->getHeaderLength() / (double)datagram->getByteLength();
         if (dblrand() <= relativeHeaderLength)
         {
-            EV << "bit error found, sending ICMP_PARAMETER_PROBLEM\n";
+            EV_LOG(DETAIL) << "bit error found, sending ICMP_PARAMETER_PROBLEM\n";
             icmpAccess.get()->sendErrorMessage(datagram, fromIE->getInterfaceId(), ICMP_PARAMETER_PROBLEM, 0);
             return;
         }
     }
 
-    EV << "Received datagram `" << datagram->getName() << "' with dest=" << datagram->getDestAddress() << "\n";
+    EV_LOG(DETAIL) << "Received datagram `" << datagram->getName() << "' with dest=" << datagram->getDestAddress() << "\n";
 
     const InterfaceEntry *destIE = NULL;
     IPv4Address nextHop(IPv4Address::UNSPECIFIED_ADDRESS);
@@ -207,17 +213,17 @@ void IPv4::preroutingFinish(IPv4Datagram *datagram, const InterfaceEntry *fromIE
                 (rt->isMulticastForwardingEnabled() && datagram->getTransportProtocol() == IP_PROT_IGMP))
             reassembleAndDeliver(datagram->dup());
         else
-            EV << "Skip local delivery of multicast datagram (input interface not in multicast group)\n";
+            EV_LOG(DETAIL) << "Skip local delivery of multicast datagram (input interface not in multicast group)\n";
 
         // don't forward if IP forwarding is off, or if dest address is link-scope
         if (!rt->isIPForwardingEnabled() || destAddr.isLinkLocalMulticast())
         {
-            EV << "Skip forwarding of multicast datagram (packet is link-local or forwarding disabled)\n";
+            EV_LOG(DETAIL) << "Skip forwarding of multicast datagram (packet is link-local or forwarding disabled)\n";
             delete datagram;
         }
         else if (datagram->getTimeToLive() == 0)
         {
-            EV << "Skip forwarding of multicast datagram (TTL reached 0)\n";
+            EV_LOG(DETAIL) << "Skip forwarding of multicast datagram (TTL reached 0)\n";
             delete datagram;
         }
         else
@@ -239,12 +245,12 @@ void IPv4::preroutingFinish(IPv4Datagram *datagram, const InterfaceEntry *fromIE
             if (broadcastIE && fromIE != broadcastIE && rt->isIPForwardingEnabled())
                 fragmentPostRouting(datagram->dup(), broadcastIE, IPv4Address::ALLONES_ADDRESS);
 
-            EV << "Broadcast received\n";
+            EV_LOG(DETAIL) << "Broadcast received\n";
             reassembleAndDeliver(datagram);
         }
         else if (!rt->isIPForwardingEnabled())
         {
-            EV << "forwarding off, dropping packet\n";
+            EV_LOG(DETAIL) << "forwarding off, dropping packet\n";
             numDropped++;
             delete datagram;
         }
@@ -291,7 +297,7 @@ void IPv4::handlePacketFromHL(cPacket *packet)
     // if no interface exists, do not send datagram
     if (ift->getNumInterfaces() == 0)
     {
-        EV << "No interfaces exist, dropping packet\n";
+        EV_LOG(DETAIL) << "No interfaces exist, dropping packet\n";
         numDropped++;
         delete packet;
         return;
@@ -341,7 +347,7 @@ void IPv4::datagramLocalOut(IPv4Datagram* datagram, const InterfaceEntry* destIE
     // send
     IPv4Address &destAddr = datagram->getDestAddress();
 
-    EV << "Sending datagram `" << datagram->getName() << "' with dest=" << destAddr << "\n";
+    EV_LOG(DETAIL) << "Sending datagram `" << datagram->getName() << "' with dest=" << destAddr << "\n";
 
     if (datagram->getDestAddress().isMulticast())
     {
@@ -362,7 +368,7 @@ void IPv4::datagramLocalOut(IPv4Datagram* datagram, const InterfaceEntry* destIE
         }
         else
         {
-            EV << "No multicast interface, packet dropped\n";
+            EV_LOG(DETAIL) << "No multicast interface, packet dropped\n";
             numUnroutable++;
             delete datagram;
         }
@@ -372,10 +378,10 @@ void IPv4::datagramLocalOut(IPv4Datagram* datagram, const InterfaceEntry* destIE
         // check for local delivery
         if (rt->isLocalAddress(destAddr))
         {
-            EV << "local delivery\n";
+            EV_LOG(DETAIL) << "local delivery\n";
             if (destIE && !destIE->isLoopback())
             {
-                EV << "datagram destination address is local, ignoring destination interface specified in the control info\n";
+                EV_LOG(DETAIL) << "datagram destination address is local, ignoring destination interface specified in the control info\n";
                 destIE = NULL;
             }
             if (!destIE)
@@ -402,7 +408,7 @@ const InterfaceEntry *IPv4::determineOutgoingInterfaceForMulticastDatagram(IPv4D
     if (multicastIFOption)
     {
         ie = multicastIFOption;
-        EV << "multicast packet routed by socket option via output interface " << ie->getName() << "\n";
+        EV_LOG(DETAIL) << "multicast packet routed by socket option via output interface " << ie->getName() << "\n";
     }
     if (!ie)
     {
@@ -410,19 +416,19 @@ const InterfaceEntry *IPv4::determineOutgoingInterfaceForMulticastDatagram(IPv4D
         if (route)
             ie = route->getInterface();
         if (ie)
-            EV << "multicast packet routed by routing table via output interface " << ie->getName() << "\n";
+            EV_LOG(DETAIL) << "multicast packet routed by routing table via output interface " << ie->getName() << "\n";
     }
     if (!ie)
     {
         ie = rt->getInterfaceByAddress(datagram->getSrcAddress());
         if (ie)
-            EV << "multicast packet routed by source address via output interface " << ie->getName() << "\n";
+            EV_LOG(DETAIL) << "multicast packet routed by source address via output interface " << ie->getName() << "\n";
     }
     if (!ie)
     {
         ie = ift->getFirstMulticastInterface();
         if (ie)
-            EV << "multicast packet routed via the first multicast interface " << ie->getName() << "\n";
+            EV_LOG(DETAIL) << "multicast packet routed via the first multicast interface " << ie->getName() << "\n";
     }
     return ie;
 }
@@ -432,13 +438,13 @@ void IPv4::routeUnicastPacket(IPv4Datagram *datagram, const InterfaceEntry *from
 {
     IPv4Address destAddr = datagram->getDestAddress();
 
-    EV << "Routing datagram `" << datagram->getName() << "' with dest=" << destAddr << ": ";
+    EV_LOG(DETAIL) << "Routing datagram `" << datagram->getName() << "' with dest=" << destAddr << ": ";
 
     IPv4Address nextHopAddr;
     // if output port was explicitly requested, use that, otherwise use IPv4 routing
     if (destIE)
     {
-        EV << "using manually specified output interface " << destIE->getName() << "\n";
+        EV_LOG(DETAIL) << "using manually specified output interface " << destIE->getName() << "\n";
         // and nextHopAddr remains unspecified
         if (!requestedNextHopAddress.isUnspecified())
             nextHopAddr = requestedNextHopAddress;
@@ -464,7 +470,7 @@ void IPv4::routeUnicastPacket(IPv4Datagram *datagram, const InterfaceEntry *from
 
     if (!destIE) // no route found
     {
-        EV << "unroutable, sending ICMP_DESTINATION_UNREACHABLE\n";
+        EV_LOG(DETAIL) << "unroutable, sending ICMP_DESTINATION_UNREACHABLE\n";
         numUnroutable++;
         icmpAccess.get()->sendErrorMessage(datagram, fromIE ? fromIE->getInterfaceId() : -1, ICMP_DESTINATION_UNREACHABLE, 0);
     }
@@ -482,7 +488,7 @@ void IPv4::routeUnicastPacket(IPv4Datagram *datagram, const InterfaceEntry *from
 
 void IPv4::routeUnicastPacketFinish(IPv4Datagram *datagram, const InterfaceEntry *fromIE, const InterfaceEntry *destIE, IPv4Address nextHopAddr)
 {
-    EV << "output interface is " << destIE->getName() << ", next-hop address: " << nextHopAddr << "\n";
+    EV_LOG(DETAIL) << "output interface is " << destIE->getName() << ", next-hop address: " << nextHopAddr << "\n";
     numForwarded++;
     fragmentPostRouting(datagram, destIE, nextHopAddr);
 }
@@ -526,14 +532,14 @@ void IPv4::forwardMulticastPacket(IPv4Datagram *datagram, const InterfaceEntry *
     ASSERT(destAddr.isMulticast());
     ASSERT(!destAddr.isLinkLocalMulticast());
 
-    EV << "Forwarding multicast datagram `" << datagram->getName() << "' with dest=" << destAddr << "\n";
+    EV_LOG(DETAIL) << "Forwarding multicast datagram `" << datagram->getName() << "' with dest=" << destAddr << "\n";
 
     numMulticast++;
 
     const IPv4MulticastRoute *route = rt->findBestMatchingMulticastRoute(srcAddr, destAddr);
     if (!route)
     {
-        EV << "Multicast route does not exist, try to add.\n";
+        EV_LOG(DETAIL) << "Multicast route does not exist, try to add.\n";
         nb->fireChangeNotification(NF_IPv4_NEW_MULTICAST, datagram);
 
         // read new record
@@ -541,7 +547,7 @@ void IPv4::forwardMulticastPacket(IPv4Datagram *datagram, const InterfaceEntry *
 
         if (!route)
         {
-            EV << "No route, packet dropped.\n";
+            EV_LOG(DETAIL) << "No route, packet dropped.\n";
             numUnroutable++;
             delete datagram;
             return;
@@ -550,7 +556,7 @@ void IPv4::forwardMulticastPacket(IPv4Datagram *datagram, const InterfaceEntry *
 
     if (route->getInInterface() && fromIE != route->getInInterface()->getInterface())
     {
-        EV << "Did not arrive on input interface, packet dropped.\n";
+        EV_LOG(DETAIL) << "Did not arrive on input interface, packet dropped.\n";
         nb->fireChangeNotification(NF_IPv4_DATA_ON_NONRPF, datagram);
         numDropped++;
         delete datagram;
@@ -558,7 +564,7 @@ void IPv4::forwardMulticastPacket(IPv4Datagram *datagram, const InterfaceEntry *
     // backward compatible: no parent means shortest path interface to source (RPB routing)
     else if (!route->getInInterface() && fromIE != getShortestPathInterfaceToSource(datagram))
     {
-        EV << "Did not arrive on shortest path, packet dropped.\n";
+        EV_LOG(DETAIL) << "Did not arrive on shortest path, packet dropped.\n";
         numDropped++;
         delete datagram;
     }
@@ -576,12 +582,12 @@ void IPv4::forwardMulticastPacket(IPv4Datagram *datagram, const InterfaceEntry *
             {
                 int ttlThreshold = destIE->ipv4Data()->getMulticastTtlThreshold();
                 if (datagram->getTimeToLive() <= ttlThreshold)
-                    EV << "Not forwarding to " << destIE->getName() << " (ttl treshold reached)\n";
+                    EV_LOG(DETAIL) << "Not forwarding to " << destIE->getName() << " (ttl treshold reached)\n";
                 else if (outInterface->isLeaf() && !destIE->ipv4Data()->hasMulticastListener(destAddr))
-                    EV << "Not forwarding to " << destIE->getName() << " (no listeners)\n";
+                    EV_LOG(DETAIL) << "Not forwarding to " << destIE->getName() << " (no listeners)\n";
                 else
                 {
-                    EV << "Forwarding to " << destIE->getName() << "\n";
+                    EV_LOG(DETAIL) << "Forwarding to " << destIE->getName() << "\n";
                     fragmentPostRouting(datagram->dup(), destIE, destAddr);
                 }
             }
@@ -596,15 +602,15 @@ void IPv4::forwardMulticastPacket(IPv4Datagram *datagram, const InterfaceEntry *
 
 void IPv4::reassembleAndDeliver(IPv4Datagram *datagram)
 {
-    EV << "Local delivery\n";
+    EV_LOG(DETAIL) << "Local delivery\n";
 
     if (datagram->getSrcAddress().isUnspecified())
-        EV << "Received datagram '" << datagram->getName() << "' without source address filled in\n";
+        EV_LOG(DETAIL) << "Received datagram '" << datagram->getName() << "' without source address filled in\n";
 
     // reassemble the packet (if fragmented)
     if (datagram->getFragmentOffset()!=0 || datagram->getMoreFragments())
     {
-        EV << "Datagram fragment: offset=" << datagram->getFragmentOffset()
+        EV_LOG(DETAIL) << "Datagram fragment: offset=" << datagram->getFragmentOffset()
            << ", MORE=" << (datagram->getMoreFragments() ? "true" : "false") << ".\n";
 
         // erase timed out fragments in fragmentation buffer; check every 10 seconds max
@@ -617,10 +623,10 @@ void IPv4::reassembleAndDeliver(IPv4Datagram *datagram)
         datagram = fragbuf.addFragment(datagram, simTime());
         if (!datagram)
         {
-            EV << "No complete datagram yet.\n";
+            EV_LOG(DETAIL) << "No complete datagram yet.\n";
             return;
         }
-        EV << "This fragment completes the datagram.\n";
+        EV_LOG(DETAIL) << "This fragment completes the datagram.\n";
     }
 
     if (datagramLocalInHook(datagram, getSourceInterfaceFrom(datagram)) != INetfilter::IHook::ACCEPT)
@@ -662,7 +668,7 @@ void IPv4::reassembleAndDeliverFinish(IPv4Datagram *datagram)
             }
         }
 
-        EV << "Transport protocol ID=" << protocol << " not connected, discarding packet\n";
+        EV_LOG(DETAIL) << "Transport protocol ID=" << protocol << " not connected, discarding packet\n";
         int inputInterfaceId = getSourceInterfaceFrom(datagram)->getInterfaceId();
         icmpAccess.get()->sendErrorMessage(datagram, inputInterfaceId, ICMP_DESTINATION_UNREACHABLE, ICMP_DU_PROTOCOL_UNREACHABLE);
     }
@@ -712,7 +718,7 @@ void IPv4::fragmentAndSend(IPv4Datagram *datagram, const InterfaceEntry *ie, IPv
     if (datagram->getTimeToLive() < 0)
     {
         // drop datagram, destruction responsibility in ICMP
-        EV << "datagram TTL reached zero, sending ICMP_TIME_EXCEEDED\n";
+        EV_LOG(DETAIL) << "datagram TTL reached zero, sending ICMP_TIME_EXCEEDED\n";
         icmpAccess.get()->sendErrorMessage(datagram, -1 /*TODO*/, ICMP_TIME_EXCEEDED, 0);
         numDropped++;
         return;
@@ -730,7 +736,7 @@ void IPv4::fragmentAndSend(IPv4Datagram *datagram, const InterfaceEntry *ie, IPv
     // if "don't fragment" bit is set, throw datagram away and send ICMP error message
     if (datagram->getDontFragment())
     {
-        EV << "datagram larger than MTU and don't fragment bit set, sending ICMP_DESTINATION_UNREACHABLE\n";
+        EV_LOG(DETAIL) << "datagram larger than MTU and don't fragment bit set, sending ICMP_DESTINATION_UNREACHABLE\n";
         icmpAccess.get()->sendErrorMessage(datagram, -1 /*TODO*/, ICMP_DESTINATION_UNREACHABLE,
                 ICMP_DU_FRAGMENTATION_NEEDED);
         numDropped++;
@@ -746,7 +752,7 @@ void IPv4::fragmentAndSend(IPv4Datagram *datagram, const InterfaceEntry *ie, IPv
         throw cRuntimeError("Cannot fragment datagram: MTU=%d too small for header size (%d bytes)", mtu, headerLength); // exception and not ICMP because this is likely a simulation configuration error, not something one wants to simulate
 
     int noOfFragments = (payloadLength + fragmentLength - 1) / fragmentLength;
-    EV << "Breaking datagram into " << noOfFragments << " fragments\n";
+    EV_LOG(DETAIL) << "Breaking datagram into " << noOfFragments << " fragments\n";
 
     // create and send fragments
     std::string fragMsgName = datagram->getName();
@@ -841,7 +847,7 @@ void IPv4::sendDatagramToOutput(IPv4Datagram *datagram, const InterfaceEntry *ie
             if (nextHopAddr.isUnspecified()) {
                 if (useProxyARP) {
                     nextHopAddr = datagram->getDestAddress();
-                    EV << "no next-hop address, using destination address " << nextHopAddr << " (proxy ARP)\n";
+                    EV_LOG(DETAIL) << "no next-hop address, using destination address " << nextHopAddr << " (proxy ARP)\n";
                 }
                 else {
                     throw cRuntimeError(datagram, "Cannot send datagram on broadcast interface: no next-hop address and Proxy ARP is disabled");
@@ -871,13 +877,13 @@ void IPv4::arpResolutionCompleted(IARPCache::Notification *entry)
     if (it != pendingPackets.end())
     {
         cPacketQueue& packetQueue = it->second;
-        EV << "ARP resolution completed for " << entry->ipv4Address << ". Sending " << packetQueue.getLength()
+        EV_LOG(DETAIL) << "ARP resolution completed for " << entry->ipv4Address << ". Sending " << packetQueue.getLength()
                 << " waiting packets from the queue\n";
 
         while (!packetQueue.empty())
         {
             cPacket *msg = packetQueue.pop();
-            EV << "Sending out queued packet " << msg << "\n";
+            EV_LOG(DETAIL) << "Sending out queued packet " << msg << "\n";
             sendPacketToIeee802NIC(msg, entry->ie, entry->macAddress, ETHERTYPE_IPv4);
         }
         pendingPackets.erase(it);
@@ -890,7 +896,7 @@ void IPv4::arpResolutionTimedOut(IARPCache::Notification *entry)
     if (it != pendingPackets.end())
     {
         cPacketQueue& packetQueue = it->second;
-        EV << "ARP resolution failed for " << entry->ipv4Address << ",  dropping " << packetQueue.getLength() << " packets\n";
+        EV_LOG(DETAIL) << "ARP resolution failed for " << entry->ipv4Address << ",  dropping " << packetQueue.getLength() << " packets\n";
         packetQueue.clear();
         pendingPackets.erase(it);
     }
@@ -900,14 +906,14 @@ MACAddress IPv4::resolveNextHopMacAddress(cPacket *packet, IPv4Address nextHopAd
 {
     if (nextHopAddr.isLimitedBroadcastAddress() || nextHopAddr == destIE->ipv4Data()->getNetworkBroadcastAddress())
     {
-        EV << "destination address is broadcast, sending packet to broadcast MAC address\n";
+        EV_LOG(DETAIL) << "destination address is broadcast, sending packet to broadcast MAC address\n";
         return MACAddress::BROADCAST_ADDRESS;
     }
 
     if (nextHopAddr.isMulticast())
     {
         MACAddress macAddr = MACAddress::makeMulticastAddress(nextHopAddr);
-        EV << "destination address is multicast, sending packet to MAC address " << macAddr << "\n";
+        EV_LOG(DETAIL) << "destination address is multicast, sending packet to MAC address " << macAddr << "\n";
         return macAddr;
     }
 
@@ -930,7 +936,7 @@ void IPv4::sendPacketToIeee802NIC(cPacket *packet, const InterfaceEntry *ie, con
 
 void IPv4::sendPacketToNIC(cPacket *packet, const InterfaceEntry *ie)
 {
-    EV << "Sending out packet to interface " << ie->getName() << endl;
+    EV_LOG(DETAIL) << "Sending out packet to interface " << ie->getName() << endl;
     send(packet, queueOutGateBaseId + ie->getNetworkLayerGateIndex());
 }
 
@@ -61,8 +61,10 @@ IPv4Datagram *IPv4FragBuf::addFragment(IPv4Datagram *datagram, simtime_t now)
     if (i == bufs.end())
     {
         // this is the first fragment of that datagram, create reassembly buffer for it
-        buf = &bufs[key];
+        i = bufs.insert(std::make_pair(key, DatagramBuffer())).first;
+        buf = &(i->second);
         buf->datagram = NULL;
+        buf->expiryPos = expiryList.insert(expiryList.end(), key);
     }
     else
     {
@@ -101,6 +103,7 @@ IPv4Datagram *IPv4FragBuf::addFragment(IPv4Datagram *datagram, simtime_t now)
         ret->setByteLength(ret->getHeaderLength()+buf->buf.getTotalLength());
         ret->setFragmentOffset(0);
         ret->setMoreFragments(false);
+        expiryList.erase(buf->expiryPos);
         bufs.erase(i);
         return ret;
     }
@@ -108,38 +111,33 @@ IPv4Datagram *IPv4FragBuf::addFragment(IPv4Datagram *datagram, simtime_t now)
     {
         // there are still missing fragments
         buf->lastupdate = now;
+        expiryList.splice(expiryList.end(), expiryList, buf->expiryPos);
         return NULL;
     }
 }
 
 void IPv4FragBuf::purgeStaleFragments(simtime_t lastupdate)
 {
-    // this method shouldn't be called too often because iteration on
-    // an std::map is *very* slow...
-
     ASSERT(icmpModule);
 
-    for (Buffers::iterator i = bufs.begin(); i != bufs.end(); )
+    // expiryList is ordered by last update, so stop at the first fresh buffer
+    while (!expiryList.empty())
     {
-        // if too old, remove it
+        Buffers::iterator i = bufs.find(expiryList.front());
+        ASSERT(i != bufs.end());
         DatagramBuffer& buf = i->second;
-        if (buf.lastupdate < lastupdate)
-        {
-            // send ICMP error.
-            // Note: receiver MUST NOT call decapsulate() on the datagram fragment,
-            // because its length (being a fragment) is smaller than the encapsulated
-            // packet, resulting in "length became negative" error. Use getEncapsulatedPacket().
-            EV << "datagram fragment timed out in reassembly buffer, sending ICMP_TIME_EXCEEDED\n";
-            icmpModule->sendErrorMessage(buf.datagram, -1 /*TODO*/, ICMP_TIME_EXCEEDED, 0);
-
-            // delete
-            Buffers::iterator oldi = i++;
-            bufs.erase(oldi);
-        }
-        else
-        {
-            ++i;
-        }
+        if (buf.lastupdate >= lastupdate)
+            break;
+
+        // send ICMP error.
+        // Note: receiver MUST NOT call decapsulate() on the datagram fragment,
+        // because its length (being a fragment) is smaller than the encapsulated
+        // packet, resulting in "length became negative" error. Use getEncapsulatedPacket().
+        EV << "datagram fragment timed out in reassembly buffer, sending ICMP_TIME_EXCEEDED\n";
+        icmpModule->sendErrorMessage(buf.datagram, -1 /*TODO*/, ICMP_TIME_EXCEEDED, 0);
+
+        // delete
+        expiryList.pop_front();
+        bufs.erase(i);
     }
 }
-
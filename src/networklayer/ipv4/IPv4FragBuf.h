@@ -19,6 +19,7 @@
 #define __INET_IPv4FRAGBUF_H
 
 
+#include <list>
 #include <map>
 
 #include "INETDefs.h"
@@ -51,6 +52,9 @@ class INET_API IPv4FragBuf
         }
     };
 
+    // buffer keys in order of their last update, oldest first
+    typedef std::list<Key> ExpiryList;
+
     //
     // Reassembly buffer for the datagram
     //
@@ -59,6 +63,7 @@ class INET_API IPv4FragBuf
         ReassemblyBuffer buf;  // reassembly buffer
         IPv4Datagram *datagram;  // the actual datagram
         simtime_t lastupdate;  // last time a new fragment arrived
+        ExpiryList::iterator expiryPos;  // position in expiryList
     };
 
     // we use std::map for fast lookup by datagram Id
@@ -67,6 +72,10 @@ class INET_API IPv4FragBuf
     // the reassembly buffers
     Buffers bufs;
 
+    // a buffer is moved to the end whenever a fragment arrives, so
+    // purgeStaleFragments() only needs to look at the front
+    ExpiryList expiryList;
+
     // needed for TIME_EXCEEDED errors
     ICMP *icmpModule;
 
@@ -101,7 +110,8 @@ class INET_API IPv4FragBuf
      *
      * Timeout should be between 60 seconds and 120 seconds (RFC1122).
      * This method should be called more frequently, maybe every
-     * 10..30 seconds or so.
+     * 10..30 seconds or so. Its cost is proportional to the number of
+     * purged buffers, not to the number of buffers.
      */
     void purgeStaleFragments(simtime_t lastupdate);
 };
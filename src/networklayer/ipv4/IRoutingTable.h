@@ -236,6 +236,30 @@ class INET_API IRoutingTable
      * notifications.
      */
     virtual void multicastRouteChanged(IPv4MulticastRoute *entry, int fieldCode) = 0;
+
+    /**
+     * Starts a batch of unicast route changes. Until the matching commitBatch(),
+     * addRoute(), removeRoute(), deleteRoute() and routeChanged() only update
+     * the route list: re-sorting, cache invalidation and change notifications
+     * are deferred to commitBatch(). Lookups made during the batch already see
+     * its changes, but getRoute() lists the routes added or changed in the batch
+     * after the others, in no particular order. A route taken out with
+     * removeRoute() during the batch must not be deleted before commitBatch(),
+     * because the deferred notifications still refer to it.
+     * Batches may be nested; only the outermost commitBatch() takes effect.
+     * A batch must be committed before control returns to the simulation kernel.
+     */
+    virtual void beginBatch() = 0;
+
+    /**
+     * Ends a batch started with beginBatch(). The routing table is re-sorted
+     * and its caches invalidated once, then the deferred NF_IPv4_ROUTE_ADDED,
+     * NF_IPv4_ROUTE_DELETED and NF_IPv4_ROUTE_CHANGED notifications are fired
+     * in the order of the changes (routes added and removed within the same
+     * batch are not reported), followed by a single NF_IPv4_ROUTE_BATCH_COMMITTED
+     * if anything changed. Routes deleted during the batch are disposed of here.
+     */
+    virtual void commitBatch() = 0;
     //@}
 };
 
@@ -20,6 +20,7 @@
 //  Cleanup and rewrite: Andras Varga, 2004
 
 #include <algorithm>
+#include <map>
 #include <sstream>
 
 #include "RoutingTable.h"
@@ -56,12 +57,16 @@ RoutingTable::RoutingTable()
 {
     ift = NULL;
     nb = NULL;
+    numSortedRoutes = 0;
+    batchDepth = 0;
 }
 
 RoutingTable::~RoutingTable()
 {
     for (unsigned int i=0; i<routes.size(); i++)
         delete routes[i];
+    for (unsigned int i=0; i<pendingDeletes.size(); i++)
+        delete pendingDeletes[i];
     for (unsigned int i=0; i<multicastRoutes.size(); i++)
         delete multicastRoutes[i];
 }
@@ -227,12 +232,14 @@ void RoutingTable::deleteInterfaceRoutes(InterfaceEntry *entry)
     bool changed = false;
 
     // delete unicast routes using this interface
+    ensureRoutesSorted();
     for (RouteVector::iterator it = routes.begin(); it != routes.end(); )
     {
         IPv4Route *route = *it;
         if (route->getInterface() == entry)
         {
             it = routes.erase(it);
+            numSortedRoutes--;
             ASSERT(route->getRoutingTable() == this); // still filled in, for the listeners' benefit
             nb->fireChangeNotification(NF_IPv4_ROUTE_DELETED, route);
             delete route;
@@ -357,7 +364,7 @@ void RoutingTable::configureInterfaceForIPv4(InterfaceEntry *ie)
 
 InterfaceEntry *RoutingTable::getInterfaceByAddress(const IPv4Address& addr) const
 {
-    Enter_Method("getInterfaceByAddress(%u.%u.%u.%u)", addr.getDByte(0), addr.getDByte(1), addr.getDByte(2), addr.getDByte(3)); // note: str().c_str() too slow here
+    Enter_Method_Query("getInterfaceByAddress(%u.%u.%u.%u)", addr.getDByte(0), addr.getDByte(1), addr.getDByte(2), addr.getDByte(3)); // note: str().c_str() too slow here
 
     if (addr.isUnspecified())
         return NULL;
@@ -389,7 +396,7 @@ void RoutingTable::configureLoopbackForIPv4()
 
 bool RoutingTable::isLocalAddress(const IPv4Address& dest) const
 {
-    Enter_Method("isLocalAddress(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
+    Enter_Method_Query("isLocalAddress(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
 
     if (localAddresses.empty())
     {
@@ -408,7 +415,7 @@ bool RoutingTable::isLocalAddress(const IPv4Address& dest) const
 // JcM add: check if the dest addr is local network broadcast
 bool RoutingTable::isLocalBroadcastAddress(const IPv4Address& dest) const
 {
-    Enter_Method("isLocalBroadcastAddress(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
+    Enter_Method_Query("isLocalBroadcastAddress(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
 
     if (localBroadcastAddresses.empty())
     {
@@ -443,7 +450,7 @@ InterfaceEntry *RoutingTable::findInterfaceByLocalBroadcastAddress(const IPv4Add
 
 bool RoutingTable::isLocalMulticastAddress(const IPv4Address& dest) const
 {
-    Enter_Method("isLocalMulticastAddress(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
+    Enter_Method_Query("isLocalMulticastAddress(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
 
     for (int i=0; i<ift->getNumInterfaces(); i++)
     {
@@ -459,6 +466,7 @@ void RoutingTable::purge()
     bool deleted = false;
 
     // purge unicast routes
+    ensureRoutesSorted();
     for (RouteVector::iterator it = routes.begin(); it != routes.end(); )
     {
         IPv4Route *route = *it;
@@ -467,6 +475,7 @@ void RoutingTable::purge()
         else
         {
             it = routes.erase(it);
+            numSortedRoutes--;
             ASSERT(route->getRoutingTable() == this); // still filled in, for the listeners' benefit
             nb->fireChangeNotification(NF_IPv4_ROUTE_DELETED, route);
             delete route;
@@ -499,7 +508,7 @@ void RoutingTable::purge()
 
 IPv4Route *RoutingTable::findBestMatchingRoute(const IPv4Address& dest) const
 {
-    Enter_Method("findBestMatchingRoute(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
+    Enter_Method_Query("findBestMatchingRoute(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
 
     RoutingCache::iterator it = routingCache.find(dest);
     if (it != routingCache.end())
@@ -511,7 +520,8 @@ IPv4Route *RoutingTable::findBestMatchingRoute(const IPv4Address& dest) const
     // find best match (one with longest prefix)
     // default route has zero prefix length, so (if exists) it'll be selected as last resort
     IPv4Route *bestRoute = NULL;
-    for (RouteVector::const_iterator i=routes.begin(); i!=routes.end(); ++i)
+    RouteVector::const_iterator sortedEnd = routes.begin() + numSortedRoutes;
+    for (RouteVector::const_iterator i=routes.begin(); i!=sortedEnd; ++i)
     {
         IPv4Route *e = *i;
         if (e->isValid())
@@ -524,13 +534,23 @@ IPv4Route *RoutingTable::findBestMatchingRoute(const IPv4Address& dest) const
         }
     }
 
+    // routes appended during a batch are not sorted yet: check all of them,
+    // a better one must come before bestRoute in the sorted order
+    for (RouteVector::const_iterator i=sortedEnd; i!=routes.end(); ++i)
+    {
+        IPv4Route *e = *i;
+        if (e->isValid() && IPv4Address::maskedAddrAreEqual(dest, e->getDestination(), e->getNetmask()))
+            if (!bestRoute || routeLessThan(e, bestRoute))
+                bestRoute = e;
+    }
+
     routingCache[dest] = bestRoute;
     return bestRoute;
 }
 
 InterfaceEntry *RoutingTable::getInterfaceForDestAddr(const IPv4Address& dest) const
 {
-    Enter_Method("getInterfaceForDestAddr(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
+    Enter_Method_Query("getInterfaceForDestAddr(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
 
     const IPv4Route *e = findBestMatchingRoute(dest);
     return e ? e->getInterface() : NULL;
@@ -538,7 +558,7 @@ InterfaceEntry *RoutingTable::getInterfaceForDestAddr(const IPv4Address& dest) c
 
 IPv4Address RoutingTable::getGatewayForDestAddr(const IPv4Address& dest) const
 {
-    Enter_Method("getGatewayForDestAddr(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
+    Enter_Method_Query("getGatewayForDestAddr(%u.%u.%u.%u)", dest.getDByte(0), dest.getDByte(1), dest.getDByte(2), dest.getDByte(3)); // note: str().c_str() too slow here
 
     const IPv4Route *e = findBestMatchingRoute(dest);
     return e ? e->getGateway() : IPv4Address();
@@ -547,9 +567,9 @@ IPv4Address RoutingTable::getGatewayForDestAddr(const IPv4Address& dest) const
 
 const IPv4MulticastRoute *RoutingTable::findBestMatchingMulticastRoute(const IPv4Address &origin, const IPv4Address &group) const
 {
-    Enter_Method("getMulticastRoutesFor(%u.%u.%u.%u, %u.%u.%u.%u)",
+    Enter_Method_Query("getMulticastRoutesFor(%u.%u.%u.%u, %u.%u.%u.%u)",
             origin.getDByte(0), origin.getDByte(1), origin.getDByte(2), origin.getDByte(3),
-            group.getDByte(0), group.getDByte(1), group.getDByte(2), group.getDByte(3)); // note: str().c_str() too slow here here
+            group.getDByte(0), group.getDByte(1), group.getDByte(2), group.getDByte(3)); // note: str().c_str() too slow here
 
     // TODO caching?
 
@@ -573,12 +593,26 @@ IPv4Route *RoutingTable::getRoute(int k) const
 IPv4Route *RoutingTable::getDefaultRoute() const
 {
     // if exists default route entry, it is the last valid entry
-    for (RouteVector::const_reverse_iterator i=routes.rbegin(); i!=routes.rend() && (*i)->getNetmask().isUnspecified(); ++i)
+    IPv4Route *defaultRoute = NULL;
+    RouteVector::const_iterator sortedEnd = routes.begin() + numSortedRoutes;
+    for (RouteVector::const_reverse_iterator i(sortedEnd); i!=routes.rend() && (*i)->getNetmask().isUnspecified(); ++i)
     {
         if ((*i)->isValid())
-            return *i;
+        {
+            defaultRoute = *i;
+            break;
+        }
     }
-    return NULL;
+
+    // routes appended during a batch are not sorted yet: the last one in the
+    // sorted order wins
+    for (RouteVector::const_iterator i=sortedEnd; i!=routes.end(); ++i)
+    {
+        IPv4Route *e = *i;
+        if (e->getNetmask().isUnspecified() && e->isValid() && (!defaultRoute || !routeLessThan(e, defaultRoute)))
+            defaultRoute = e;
+    }
+    return defaultRoute;
 }
 
 // The 'routes' vector stores the routes in this order.
@@ -641,19 +675,47 @@ void RoutingTable::internalAddRoute(IPv4Route *entry)
 
     // add to tables
     // we keep entries sorted by netmask desc, metric asc in routeList, so that we can
-    // stop at the first match when doing the longest netmask matching
-    RouteVector::iterator pos = upper_bound(routes.begin(), routes.end(), entry, routeLessThan);
-    routes.insert(pos, entry);
+    // stop at the first match when doing the longest netmask matching;
+    // within a batch, new entries are appended and sorted in one go later
+    if (batchDepth > 0)
+        routes.push_back(entry);
+    else
+    {
+        ensureRoutesSorted();
+        RouteVector::iterator pos = upper_bound(routes.begin(), routes.end(), entry, routeLessThan);
+        routes.insert(pos, entry);
+        numSortedRoutes++;
+    }
 
     entry->setRoutingTable(this);
 }
 
+void RoutingTable::ensureRoutesSorted()
+{
+    if (numSortedRoutes == routes.size())
+        return;
+
+    // sort the appended tail (stable, so that equal routes keep their insertion
+    // order, like with upper_bound()) and merge it into the sorted head
+    RouteVector::iterator mid = routes.begin() + numSortedRoutes;
+    std::stable_sort(mid, routes.end(), routeLessThan);
+    std::inplace_merge(routes.begin(), mid, routes.end(), routeLessThan);
+    numSortedRoutes = routes.size();
+}
+
 void RoutingTable::addRoute(IPv4Route *entry)
 {
     Enter_Method("addRoute(...)");
 
     internalAddRoute(entry);
 
+    if (batchDepth > 0)
+    {
+        routingCache.clear();
+        pendingNotifications.push_back(std::make_pair((int)NF_IPv4_ROUTE_ADDED, entry));
+        return;
+    }
+
     invalidateCache();
     updateDisplayString();
 
@@ -665,6 +727,8 @@ IPv4Route *RoutingTable::internalRemoveRoute(IPv4Route *entry)
     RouteVector::iterator i = std::find(routes.begin(), routes.end(), entry);
     if (i!=routes.end())
     {
+        if ((unsigned int)(i - routes.begin()) < numSortedRoutes)
+            numSortedRoutes--;
         routes.erase(i);
         return entry;
     }
@@ -677,7 +741,16 @@ IPv4Route *RoutingTable::removeRoute(IPv4Route *entry)
 
     entry = internalRemoveRoute(entry);
 
-    if (entry != NULL)
+    if (entry != NULL && batchDepth > 0)
+    {
+        // the caller takes the route over and must keep it alive until the
+        // deferred notifications are out; it may modify and re-add the route
+        // in the meantime, so it is detached right away
+        routingCache.clear();
+        pendingNotifications.push_back(std::make_pair((int)NF_IPv4_ROUTE_DELETED, entry));
+        entry->setRoutingTable(NULL);
+    }
+    else if (entry != NULL)
     {
         invalidateCache();
         updateDisplayString();
@@ -694,7 +767,14 @@ bool RoutingTable::deleteRoute(IPv4Route *entry)
 
     entry = internalRemoveRoute(entry);
 
-    if (entry != NULL)
+    if (entry != NULL && batchDepth > 0)
+    {
+        // keep the route alive until the deferred notifications are out
+        routingCache.clear();
+        pendingNotifications.push_back(std::make_pair((int)NF_IPv4_ROUTE_DELETED, entry));
+        pendingDeletes.push_back(entry);
+    }
+    else if (entry != NULL)
     {
         invalidateCache();
         updateDisplayString();
@@ -827,10 +907,18 @@ void RoutingTable::routeChanged(IPv4Route *entry, int fieldCode)
         ASSERT(entry != NULL);  // failure means inconsistency: route was not found in this routing table
         internalAddRoute(entry);
 
-        invalidateCache();
-        updateDisplayString();
+        if (batchDepth == 0)
+        {
+            invalidateCache();
+            updateDisplayString();
+        }
+        else
+            routingCache.clear();
     }
-    nb->fireChangeNotification(NF_IPv4_ROUTE_CHANGED, entry); // TODO include fieldCode in the notification
+    if (batchDepth > 0)
+        pendingNotifications.push_back(std::make_pair((int)NF_IPv4_ROUTE_CHANGED, entry));
+    else
+        nb->fireChangeNotification(NF_IPv4_ROUTE_CHANGED, entry); // TODO include fieldCode in the notification
 }
 
 void RoutingTable::multicastRouteChanged(IPv4MulticastRoute *entry, int fieldCode)
@@ -848,9 +936,66 @@ void RoutingTable::multicastRouteChanged(IPv4MulticastRoute *entry, int fieldCod
     nb->fireChangeNotification(NF_IPv4_MROUTE_CHANGED, entry); // TODO include fieldCode in the notification
 }
 
+void RoutingTable::beginBatch()
+{
+    Enter_Method("beginBatch()");
+    batchDepth++;
+}
+
+void RoutingTable::commitBatch()
+{
+    Enter_Method("commitBatch()");
+
+    if (batchDepth <= 0)
+        error("commitBatch(): no batch in progress");
+    if (--batchDepth > 0)
+        return;
+
+    bool changed = !pendingNotifications.empty() || !pendingDeletes.empty();
+    ensureRoutesSorted();
+
+    // take over the pending state first, listeners may start batches of their own
+    RouteNotificationVector notifications;
+    notifications.swap(pendingNotifications);
+    RouteVector deletes;
+    deletes.swap(pendingDeletes);
+
+    // the listeners need not hear about routes that were both added and
+    // removed within the batch: find the first and last change of each route
+    typedef std::map<IPv4Route *, std::pair<int, int> > RouteChangeMap;
+    RouteChangeMap firstAndLastChanges;
+    for (RouteNotificationVector::iterator it = notifications.begin(); it != notifications.end(); ++it)
+    {
+        std::pair<RouteChangeMap::iterator, bool> inserted =
+                firstAndLastChanges.insert(std::make_pair(it->second, std::make_pair(it->first, it->first)));
+        if (!inserted.second)
+            inserted.first->second.second = it->first;
+    }
+
+    if (changed)
+    {
+        invalidateCache();
+        updateDisplayString();
+    }
+
+    for (RouteNotificationVector::iterator it = notifications.begin(); it != notifications.end(); ++it)
+    {
+        const std::pair<int, int>& changes = firstAndLastChanges[it->second];
+        if (changes.first != NF_IPv4_ROUTE_ADDED || changes.second != NF_IPv4_ROUTE_DELETED)
+            nb->fireChangeNotification(it->first, it->second);
+    }
+
+    if (changed)
+        nb->fireChangeNotification(NF_IPv4_ROUTE_BATCH_COMMITTED, this);
+
+    for (RouteVector::iterator it = deletes.begin(); it != deletes.end(); ++it)
+        delete *it;
+}
+
 void RoutingTable::updateNetmaskRoutes()
 {
     // first, delete all routes with src=IFACENETMASK
+    ensureRoutesSorted();
     for (unsigned int k=0; k<routes.size(); k++)
     {
         if (routes[k]->getSourceType()==IPv4Route::IFACENETMASK)
@@ -858,6 +1003,7 @@ void RoutingTable::updateNetmaskRoutes()
             std::vector<IPv4Route *>::iterator it = routes.begin()+(k--);  // '--' is necessary because indices shift down
             IPv4Route *route = *it;
             routes.erase(it);
+            numSortedRoutes--;
             ASSERT(route->getRoutingTable() == this); // still filled in, for the listeners' benefit
             nb->fireChangeNotification(NF_IPv4_ROUTE_DELETED, route);
             delete route;
@@ -884,6 +1030,7 @@ void RoutingTable::updateNetmaskRoutes()
             route->setRoutingTable(this);
             RouteVector::iterator pos = upper_bound(routes.begin(), routes.end(), route, routeLessThan);
             routes.insert(pos, route);
+            numSortedRoutes++;
             nb->fireChangeNotification(NF_IPv4_ROUTE_ADDED, route);
         }
     }
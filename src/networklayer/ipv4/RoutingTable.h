@@ -103,11 +103,19 @@ class INET_API RoutingTable: public cSimpleModule, public IRoutingTable, protect
 
     typedef std::vector<IPv4Route *> RouteVector;
     RouteVector routes;          // Unicast route array, sorted by netmask desc, dest asc, metric asc
+    unsigned int numSortedRoutes; // routes appended during a batch are past this index until commitBatch()
 
     typedef std::vector<IPv4MulticastRoute*> MulticastRouteVector;
     MulticastRouteVector multicastRoutes; // Multicast route array, sorted by netmask desc, origin asc, metric asc
 
 
+  protected:
+    // route batch state, see beginBatch()
+    int batchDepth;
+    typedef std::vector<std::pair<int, IPv4Route *> > RouteNotificationVector;
+    RouteNotificationVector pendingNotifications; // deferred NF_IPv4_ROUTE_xxx notifications
+    RouteVector pendingDeletes;   // routes deleted during the batch, disposed of on commit
+
   protected:
     // set IPv4 address etc on local loopback
     virtual void configureLoopbackForIPv4();
@@ -136,6 +144,9 @@ class INET_API RoutingTable: public cSimpleModule, public IRoutingTable, protect
     // helper for sorting multicast routing table, used by addMulticastRoute()
     static bool multicastRouteLessThan(const IPv4MulticastRoute *a, const IPv4MulticastRoute *b);
 
+    // sorts the routes appended during a batch into place
+    void ensureRoutesSorted();
+
     // helper functions:
     void internalAddRoute(IPv4Route *entry);
     IPv4Route *internalRemoveRoute(IPv4Route *entry);
@@ -361,6 +372,16 @@ class INET_API RoutingTable: public cSimpleModule, public IRoutingTable, protect
      * notifications.
      */
     virtual void multicastRouteChanged(IPv4MulticastRoute *entry, int fieldCode);
+
+    /**
+     * Starts a batch of unicast route changes, see IRoutingTable::beginBatch().
+     */
+    virtual void beginBatch();
+
+    /**
+     * Applies the changes made since the outermost beginBatch() call.
+     */
+    virtual void commitBatch();
     //@}
 
     /**
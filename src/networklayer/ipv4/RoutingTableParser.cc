@@ -126,7 +126,11 @@ int RoutingTableParser::readRoutingTableFromFile(const char *filename)
     if (ifconfigFile)
         parseInterfaces(ifconfigFile);
     if (routeFile)
+    {
+        rt->beginBatch();
         parseRouting(routeFile);
+        rt->commitBatch();
+    }
 
     delete [] ifconfigFile;
     delete [] routeFile;
@@ -35,6 +35,11 @@ IPv6FragBuf::IPv6FragBuf()
 
 IPv6FragBuf::~IPv6FragBuf()
 {
+    while (!bufs.empty())
+    {
+        delete bufs.begin()->second.datagram;
+        bufs.erase(bufs.begin());
+    }
 }
 
 void IPv6FragBuf::init(ICMPv6 *icmp)
@@ -56,9 +61,11 @@ IPv6Datagram *IPv6FragBuf::addFragment(IPv6Datagram *datagram, IPv6FragmentHeade
     if (i==bufs.end())
     {
         // this is the first fragment of that datagram, create reassembly buffer for it
-        buf = &bufs[key];
+        i = bufs.insert(std::make_pair(key, DatagramBuffer())).first;
+        buf = &(i->second);
         buf->datagram = NULL;
         buf->createdAt = now;
+        buf->expiryPos = expiryList.insert(expiryList.end(), key);
     }
     else
     {
@@ -122,6 +129,7 @@ IPv6Datagram *IPv6FragBuf::addFragment(IPv6Datagram *datagram, IPv6FragmentHeade
         ASSERT(ret);
         ret->removeExtensionHeader(IP_PROT_IPv6EXT_FRAGMENT);
         ret->setByteLength(ret->calculateUnfragmentableHeaderByteLength()+buf->buf.getTotalLength());
+        expiryList.erase(buf->expiryPos);
         bufs.erase(i);
         return ret;
     }
@@ -145,32 +153,27 @@ IPv6Datagram *IPv6FragBuf::addFragment(IPv6Datagram *datagram, IPv6FragmentHeade
  */
 void IPv6FragBuf::purgeStaleFragments(simtime_t lastupdate)
 {
-    // this method shouldn't be called too often because iteration on
-    // an std::map is *very* slow...
-
     ASSERT(icmpModule);
 
-    for (Buffers::iterator i=bufs.begin(); i!=bufs.end(); )
+    // expiryList is ordered by creation time, so stop at the first fresh buffer
+    while (!expiryList.empty())
     {
-        // if too old, remove it
+        Buffers::iterator i = bufs.find(expiryList.front());
+        ASSERT(i != bufs.end());
         DatagramBuffer& buf = i->second;
-        if (buf.createdAt < lastupdate)
-        {
-            if (buf.datagram)
-            {
-                // send ICMP error
-                EV << "datagram fragment timed out in reassembly buffer, sending ICMP_TIME_EXCEEDED\n";
-                icmpModule->sendErrorMessage(buf.datagram, ICMPv6_TIME_EXCEEDED, 0);
-            }
-
-            // delete
-            Buffers::iterator oldi = i++;
-            bufs.erase(oldi);
-        }
-        else
+        if (buf.createdAt >= lastupdate)
+            break;
+
+        if (buf.datagram)
         {
-            ++i;
+            // send ICMP error
+            EV << "datagram fragment timed out in reassembly buffer, sending ICMP_TIME_EXCEEDED\n";
+            icmpModule->sendErrorMessage(buf.datagram, ICMPv6_TIME_EXCEEDED, 0);
         }
+
+        // delete
+        expiryList.pop_front();
+        bufs.erase(i);
     }
 }
 
@@ -18,6 +18,7 @@
 #ifndef __IPv6FRAGBUF_H__
 #define __IPv6FRAGBUF_H__
 
+#include <list>
 #include <map>
 #include <vector>
 #include "INETDefs.h"
@@ -48,6 +49,9 @@ class INET_API IPv6FragBuf
         }
     };
 
+    // buffer keys in order of creation, oldest first
+    typedef std::list<Key> ExpiryList;
+
     //
     // Reassembly buffer for the datagram
     //
@@ -56,6 +60,7 @@ class INET_API IPv6FragBuf
         ReassemblyBuffer buf;  // reassembly buffer
         IPv6Datagram *datagram;  // the actual datagram
         simtime_t createdAt;  // time of the buffer creation (i.e. reception time of first-arriving fragment)
+        ExpiryList::iterator expiryPos;  // position in expiryList
     };
 
     // we use std::map for fast lookup by datagram Id
@@ -64,6 +69,10 @@ class INET_API IPv6FragBuf
     // the reassembly buffers
     Buffers bufs;
 
+    // createdAt never changes, so purgeStaleFragments() only needs
+    // to look at the front of this list
+    ExpiryList expiryList;
+
     // needed for TIME_EXCEEDED errors
     ICMPv6 *icmpModule;
 
@@ -92,13 +101,12 @@ class INET_API IPv6FragBuf
     IPv6Datagram *addFragment(IPv6Datagram *datagram, IPv6FragmentHeader *fh, simtime_t now);
 
     /**
-     * Throws out all fragments which are incomplete and their
-     * last update (last fragment arrival) was before "lastupdate",
-     * and sends ICMP TIME EXCEEDED message about them.
+     * Throws out all fragments which are incomplete and whose first
+     * fragment arrived before "lastupdate", and sends ICMP TIME EXCEEDED
+     * message about them.
      *
-     * Timeout should be between 60 seconds and 120 seconds (RFC1122).
-     * This method should be called more frequently, maybe every
-     * 10..30 seconds or so.
+     * Timeout is 60 seconds (RFC 2460 4.5). The cost is proportional
+     * to the number of purged buffers, not to the number of buffers.
      */
     void purgeStaleFragments(simtime_t lastupdate);
 };
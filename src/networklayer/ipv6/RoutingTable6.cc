@@ -462,7 +462,7 @@ void RoutingTable6::configureTunnelFromXML(cXMLElement* cfg)
 
 InterfaceEntry *RoutingTable6::getInterfaceByAddress(const IPv6Address& addr)
 {
-    Enter_Method("getInterfaceByAddress(%s)=?", addr.str().c_str());
+    Enter_Method_Query("getInterfaceByAddress(%s)=?", addr.str().c_str());
 
     if (addr.isUnspecified())
         return NULL;
@@ -478,7 +478,7 @@ InterfaceEntry *RoutingTable6::getInterfaceByAddress(const IPv6Address& addr)
 
 bool RoutingTable6::isLocalAddress(const IPv6Address& dest) const
 {
-    Enter_Method("isLocalAddress(%s) y/n", dest.str().c_str());
+    Enter_Method_Query("isLocalAddress(%s) y/n", dest.str().c_str());
 
     // first, check if we have an interface with this address
     for (int i=0; i<ift->getNumInterfaces(); i++)
@@ -513,7 +513,7 @@ bool RoutingTable6::isLocalAddress(const IPv6Address& dest) const
 
 const IPv6Address& RoutingTable6::lookupDestCache(const IPv6Address& dest, int& outInterfaceId)
 {
-    Enter_Method("lookupDestCache(%s)", dest.str().c_str());
+    Enter_Method_Query("lookupDestCache(%s)", dest.str().c_str());
 
     DestCache::iterator it = destCache.find(dest);
     if (it == destCache.end())
@@ -535,7 +535,7 @@ const IPv6Address& RoutingTable6::lookupDestCache(const IPv6Address& dest, int&
 
 const IPv6Route *RoutingTable6::doLongestPrefixMatch(const IPv6Address& dest)
 {
-    Enter_Method("doLongestPrefixMatch(%s)", dest.str().c_str());
+    Enter_Method_Lazy("doLongestPrefixMatch(%s)", dest.str().c_str());
 
     // we'll just stop at the first match, because the table is sorted
     // by prefix lengths and metric (see addRoute())
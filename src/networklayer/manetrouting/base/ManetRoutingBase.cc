@@ -756,6 +756,7 @@ void ManetRoutingBase::omnet_clean_rte()
     if (mac_layer_)
         return;
     // clean the route table wlan interface entry
+    inet_rt->beginBatch();
     for (int i=inet_rt->getNumRoutes()-1; i>=0; i--)
     {
         entry = inet_rt->getRoute(i);
@@ -764,6 +765,7 @@ void ManetRoutingBase::omnet_clean_rte()
             inet_rt->deleteRoute(entry);
         }
     }
+    inet_rt->commitBatch();
 }
 
 //
@@ -164,6 +164,11 @@ class INET_API ManetRoutingBase : public cSimpleModule, public INotifiable, prot
     virtual void deleteIpEntry(const ManetAddress &dst) {omnet_chg_rte(dst, dst, dst, 0, true);}
     virtual void setIpEntry(const ManetAddress &dst, const ManetAddress &gtwy, const ManetAddress &netm, short int hops, const ManetAddress &iface = ManetAddress::ZERO)
             {omnet_chg_rte(dst, gtwy, netm, hops, false, iface);}
+
+    /// Groups the following omnet_chg_rte() calls into one IPv4 routing table update
+    /// (see IRoutingTable::beginBatch()); must be paired with omnet_commit_rte_batch()
+    virtual void omnet_begin_rte_batch() {if (!mac_layer_) inet_rt->beginBatch();}
+    virtual void omnet_commit_rte_batch() {if (!mac_layer_) inet_rt->commitBatch();}
     //@}
 
     /**
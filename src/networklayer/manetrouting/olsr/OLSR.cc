@@ -87,6 +87,7 @@ OLSR_Timer::OLSR_Timer(OLSR* agent) : cOwnedObject("OLSR_Timer")
 {
     agent_ = agent;
     tuple_ = NULL;
+    queued_ = false;
 }
 
 OLSR_Timer::~OLSR_Timer()
@@ -100,25 +101,28 @@ OLSR_Timer::OLSR_Timer() : cOwnedObject("OLSR_Timer")
     if (agent_==NULL)
         opp_error("timer ower is bad");
     tuple_ = NULL;
+    queued_ = false;
 }
 
 void OLSR_Timer::removeQueueTimer()
 {
-    TimerQueue::iterator it;
-    for (it=agent_->timerQueuePtr->begin(); it != agent_->timerQueuePtr->end(); it++ )
+    if (queued_)
     {
-        if (it->second==this)
-        {
-            agent_->timerQueuePtr->erase(it);
-            return;
-        }
+        agent_->timerQueuePtr->erase(queuePos_);
+        queued_ = false;
     }
 }
 
-void OLSR_Timer::resched(double time)
+void OLSR_Timer::insertQueue(simtime_t when)
 {
     removeQueueTimer();
-    agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+time, this));
+    queuePos_ = agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(when, this));
+    queued_ = true;
+}
+
+void OLSR_Timer::resched(double time)
+{
+    insertQueue(simTime()+time);
     //if (this->isScheduled())
     //  agent_->cancelEvent(this);
     // agent_->scheduleAt (simTime()+time,this);
@@ -134,7 +138,7 @@ OLSR_HelloTimer::expire()
 {
     agent_->send_hello();
     // agent_->scheduleAt(simTime()+agent_->hello_ival_- JITTER,this);
-    agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+agent_->hello_ival_- agent_->jitter(), this));
+    insertQueue(simTime()+agent_->hello_ival_- agent_->jitter());
 }
 
 ///
@@ -147,7 +151,7 @@ OLSR_TcTimer::expire()
     if (agent_->mprselset().size() > 0)
         agent_->send_tc();
     // agent_->scheduleAt(simTime()+agent_->tc_ival_- JITTER,this);
-    agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+agent_->tc_ival_- agent_->jitter(), this));
+    insertQueue(simTime()+agent_->tc_ival_- agent_->jitter());
 
 }
 
@@ -164,7 +168,7 @@ OLSR_MidTimer::expire()
         return; // not multi-interface support
     agent_->send_mid();
 //  agent_->scheduleAt(simTime()+agent_->mid_ival_- JITTER,this);
-    agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+agent_->mid_ival_- agent_->jitter(), this));
+    insertQueue(simTime()+agent_->mid_ival_- agent_->jitter());
 #endif
 }
 
@@ -190,7 +194,7 @@ OLSR_DupTupleTimer::expire()
     else
     {
         // agent_->scheduleAt (simTime()+DELAY_T(time),this);
-        agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+DELAY_T(time), this));
+        insertQueue(simTime()+DELAY_T(time));
     }
 }
 
@@ -244,12 +248,12 @@ OLSR_LinkTupleTimer::expire()
         else
             agent_->nb_loss(tuple);
         // agent_->scheduleAt (simTime()+DELAY_T(tuple_->time()),this);
-        agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+DELAY_T(tuple->time()), this));
+        insertQueue(simTime()+DELAY_T(tuple->time()));
     }
     else
     {
         // agent_->scheduleAt (simTime()+DELAY_T(MIN(tuple_->time(), tuple_->sym_time())),this);
-        agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+DELAY_T(MIN(tuple->time(), tuple->sym_time())), this));
+        insertQueue(simTime()+DELAY_T(MIN(tuple->time(), tuple->sym_time())));
     }
 }
 
@@ -288,7 +292,7 @@ OLSR_Nb2hopTupleTimer::expire()
     else
     {
         // agent_->scheduleAt (simTime()+DELAY_T(time),this);
-        agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+DELAY_T(time), this));
+        insertQueue(simTime()+DELAY_T(time));
     }
 }
 
@@ -329,7 +333,7 @@ OLSR_MprSelTupleTimer::expire()
     else
     {
 //      agent_->scheduleAt (simTime()+DELAY_T(time),this);
-        agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+DELAY_T(time), this));
+        insertQueue(simTime()+DELAY_T(time));
     }
 }
 
@@ -369,7 +373,7 @@ OLSR_TopologyTupleTimer::expire()
     else
     {
 //      agent_->scheduleAt (simTime()+DELAY_T(time),this);
-        agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+DELAY_T(time), this));
+        insertQueue(simTime()+DELAY_T(time));
     }
 }
 
@@ -406,7 +410,7 @@ void OLSR_IfaceAssocTupleTimer::expire()
     else
     {
         //  agent_->scheduleAt (simTime()+DELAY_T(time),this);
-        agent_->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+DELAY_T(time), this));
+        insertQueue(simTime()+DELAY_T(time));
     }
 }
 
@@ -562,7 +566,7 @@ void OLSR::handleMessage(cMessage *msg)
                 opp_error("timer ower is bad");
             else
             {
-                timerQueuePtr->erase(timerQueuePtr->begin());
+                timer->removeQueueTimer();
                 timer->expire();
             }
         }
@@ -1274,21 +1278,9 @@ OLSR::mpr_computation()
 void
 OLSR::rtable_computation()
 {
-    nsaddr_t netmask(IPv4Address::ALLONES_ADDRESS);
-    // 1. All the entries from the routing table are removed.
-    //
-
-    if (par("DelOnlyRtEntriesInrtable_").boolValue())
-    {
-        for (rtable_t::const_iterator itRtTable = rtable_.getInternalTable()->begin();itRtTable != rtable_.getInternalTable()->begin();++itRtTable)
-        {
-            nsaddr_t addr = itRtTable->first;
-            omnet_chg_rte(addr, addr,netmask,1, true, addr);
-        }
-    }
-    else
-        omnet_clean_rte(); // clean IP tables
-
+    // 1. All the entries from the routing table are removed. The IP routing
+    // table is not touched here: install_rtable() applies only the differences
+    // between the new table and the installed one at the end.
     rtable_.clear();
 
 
@@ -1312,16 +1304,6 @@ OLSR::rtable_computation()
                                       link_tuple->nb_iface_addr(),
                                       link_tuple->local_iface_addr(),
                                       1, link_tuple->local_iface_index());
-                    if (!useIndex)
-                        omnet_chg_rte(link_tuple->nb_iface_addr(),
-                                       link_tuple->nb_iface_addr(),
-                                       netmask,
-                                       1, false, link_tuple->local_iface_addr());
-                    else
-                        omnet_chg_rte(link_tuple->nb_iface_addr(),
-                                       link_tuple->nb_iface_addr(),
-                                       netmask,
-                                       1, false, link_tuple->local_iface_index());
 
                     if (link_tuple->nb_iface_addr() == nb_tuple->nb_main_addr())
                         nb_main_addr = true;
@@ -1333,18 +1315,6 @@ OLSR::rtable_computation()
                                   lt->nb_iface_addr(),
                                   lt->local_iface_addr(),
                                   1, lt->local_iface_index());
-
-                if (!useIndex)
-                    omnet_chg_rte(nb_tuple->nb_main_addr(),
-                                   lt->nb_iface_addr(),
-                                   netmask,// Default mask
-                                   1, false, lt->local_iface_addr());
-
-                else
-                    omnet_chg_rte(nb_tuple->nb_main_addr(),
-                                   lt->nb_iface_addr(),
-                                   netmask,// Default mask
-                                   1, false, lt->local_iface_index());
             }
         }
     }
@@ -1383,18 +1353,6 @@ OLSR::rtable_computation()
                               entry->next_addr(),
                               entry->iface_addr(),
                               2, entry->local_iface_index());
-            if (!useIndex)
-                omnet_chg_rte(nb2hop_tuple->nb2hop_addr(),
-                               entry->next_addr(),
-                               netmask,
-                               2, false, entry->iface_addr());
-
-            else
-                omnet_chg_rte(nb2hop_tuple->nb2hop_addr(),
-                               entry->next_addr(),
-                               netmask,
-                               2, false, entry->local_iface_index());
-
         }
     }
 
@@ -1421,19 +1379,6 @@ OLSR::rtable_computation()
                                   entry2->next_addr(),
                                   entry2->iface_addr(),
                                   h+1, entry2->local_iface_index(), entry2);
-
-                if (!useIndex)
-                    omnet_chg_rte(topology_tuple->dest_addr(),
-                                   entry2->next_addr(),
-                                   netmask,
-                                   h+1, false, entry2->iface_addr());
-
-                else
-                    omnet_chg_rte(topology_tuple->dest_addr(),
-                                   entry2->next_addr(),
-                                   netmask,
-                                   h+1, false, entry2->local_iface_index());
-
                 added = true;
             }
         }
@@ -1457,18 +1402,6 @@ OLSR::rtable_computation()
                                   entry1->next_addr(),
                                   entry1->iface_addr(),
                                   entry1->dist(), entry1->local_iface_index(), entry1);
-
-                if (!useIndex)
-                    omnet_chg_rte(tuple->iface_addr(),
-                                   entry1->next_addr(),
-                                   netmask,
-                                   entry1->dist(), false, entry1->iface_addr());
-
-                else
-                    omnet_chg_rte(tuple->iface_addr(),
-                                   entry1->next_addr(),
-                                   netmask,
-                                   entry1->dist(), false, entry1->local_iface_index());
                 added = true;
             }
         }
@@ -1476,9 +1409,75 @@ OLSR::rtable_computation()
         if (!added)
             break;
     }
+    install_rtable();
     setTopologyChanged(false);
 }
 
+///
+/// \brief Updates the IP routing table to match rtable_.
+///
+/// Only the routes that appeared, disappeared or changed since the previous
+/// call are added, deleted or replaced; unchanged routes are left alone.
+///
+void
+OLSR::install_rtable()
+{
+    nsaddr_t netmask(IPv4Address::ALLONES_ADDRESS);
+
+    omnet_begin_rte_batch();
+    if (!routesInstalled_)
+    {
+        // start from a clean table, unless told to touch our own entries only
+        if (!par("DelOnlyRtEntriesInrtable_").boolValue())
+            omnet_clean_rte();
+        routesInstalled_ = true;
+    }
+
+    // merge the two sorted sequences
+    const rtable_t& rt = *rtable_.getInternalTable();
+    rtable_t::const_iterator itNew = rt.begin();
+    InstalledRouteMap::iterator itOld = installedRoutes_.begin();
+    while (itNew != rt.end() || itOld != installedRoutes_.end())
+    {
+        if (itNew == rt.end() || (itOld != installedRoutes_.end() && itOld->first < itNew->first))
+        {
+            // route disappeared
+            nsaddr_t addr = itOld->first;
+            omnet_chg_rte(addr, addr, netmask, 1, true, addr);
+            installedRoutes_.erase(itOld++);
+            continue;
+        }
+
+        OLSR_rt_entry *entry = itNew->second;
+        bool found = itOld != installedRoutes_.end() && itOld->first == itNew->first;
+        if (found)
+        {
+            InstalledRoute& route = itOld->second;
+            bool changed = route.next_addr != entry->next_addr() || route.dist != entry->dist()
+                    || (useIndex ? route.iface_index != entry->local_iface_index() : route.iface_addr != entry->iface_addr());
+            ++itOld;
+            if (!changed)
+            {
+                ++itNew;
+                continue;
+            }
+        }
+
+        // route appeared or changed
+        if (!useIndex)
+            omnet_chg_rte(entry->dest_addr(), entry->next_addr(), netmask, entry->dist(), false, entry->iface_addr());
+        else
+            omnet_chg_rte(entry->dest_addr(), entry->next_addr(), netmask, entry->dist(), false, entry->local_iface_index());
+        InstalledRoute& route = installedRoutes_[itNew->first];
+        route.next_addr = entry->next_addr();
+        route.iface_addr = entry->iface_addr();
+        route.iface_index = entry->local_iface_index();
+        route.dist = entry->dist();
+        ++itNew;
+    }
+    omnet_commit_rte_batch();
+}
+
 ///
 /// \brief Processes a HELLO message following RFC 3626 specification.
 ///
@@ -2841,7 +2840,7 @@ OLSR::~OLSR()
     while (timerQueuePtr && timerQueuePtr->size()>0)
     {
         OLSR_Timer * timer = timerQueuePtr->begin()->second;
-        timerQueuePtr->erase(timerQueuePtr->begin());
+        timer->removeQueueTimer();
         timer->setTuple(NULL);
         if (helloTimer==timer)
             helloTimer = NULL;
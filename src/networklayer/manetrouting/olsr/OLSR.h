@@ -156,9 +156,12 @@
 //#define JITTER            (Random::uniform()*OLSR_MAXJITTER)
 
 class OLSR;         // forward declaration
+class OLSR_Timer;
 
 /********** Timers **********/
 
+typedef std::multimap <simtime_t, OLSR_Timer *> TimerQueue;
+
 /// Basic timer class
 
 class OLSR_Timer :  public cOwnedObject /*cMessage*/
@@ -166,6 +169,8 @@ class OLSR_Timer :  public cOwnedObject /*cMessage*/
   protected:
     OLSR*       agent_; ///< OLSR agent which created the timer.
     cObject* tuple_;
+    bool queued_;       ///< True if the timer is in the agent's timer queue.
+    TimerQueue::iterator queuePos_; ///< Position in the timer queue, valid if queued_.
   public:
 
     virtual void removeTimer();
@@ -174,6 +179,7 @@ class OLSR_Timer :  public cOwnedObject /*cMessage*/
     ~OLSR_Timer();
     virtual void expire() = 0;
     virtual void removeQueueTimer();
+    virtual void insertQueue(simtime_t when);
     virtual void resched(double time);
     virtual void setTuple(cObject *tuple) {tuple_ = tuple;}
 };
@@ -337,7 +343,6 @@ class OLSR_IfaceAssocTupleTimer : public OLSR_Timer
 ///
 
 typedef std::set<OLSR_Timer *> TimerPendingList;
-typedef std::multimap <simtime_t, OLSR_Timer *> TimerQueue;
 
 
 class OLSR : public ManetRoutingBase
@@ -390,6 +395,19 @@ class OLSR : public ManetRoutingBase
     std::vector<OLSR_msg>   msgs_;
     /// Routing table.
     OLSR_rtable     rtable_;
+    /// A route installed in the IP routing table by install_rtable().
+    struct InstalledRoute
+    {
+        nsaddr_t next_addr;
+        nsaddr_t iface_addr;
+        int iface_index;
+        uint32_t dist;
+    };
+    typedef std::map<nsaddr_t, InstalledRoute> InstalledRouteMap;
+    /// Routes currently installed in the IP routing table, by destination.
+    InstalledRouteMap installedRoutes_;
+    /// False until the first install_rtable() call.
+    bool routesInstalled_;
     /// Internal state with all needed data structs.
 
     OLSR_state      *state_ptr;
@@ -471,6 +489,7 @@ class OLSR : public ManetRoutingBase
 
     virtual void        mpr_computation();
     virtual void        rtable_computation();
+    virtual void        install_rtable();
 
     virtual bool        process_hello(OLSR_msg&, const nsaddr_t &, const nsaddr_t &, const int &);
     virtual bool        process_tc(OLSR_msg&, const nsaddr_t &, const int &);
@@ -532,7 +551,7 @@ class OLSR : public ManetRoutingBase
     const char * getNodeId(const nsaddr_t &addr);
 
   public:
-    OLSR() {}
+    OLSR() : routesInstalled_(false) {}
     virtual ~OLSR();
 
 
@@ -77,7 +77,7 @@ void OLSR_ETX_LinkQualityTimer::expire()
     OLSR_ETX *agentaux = check_and_cast<OLSR_ETX *>(agent_);
     agentaux->OLSR_ETX::link_quality();
     // agentaux->scheduleAt(simTime()+agentaux->hello_ival_,this);
-    agentaux->timerQueuePtr->insert(std::pair<simtime_t, OLSR_Timer *>(simTime()+agentaux->hello_ival_, this));
+    insertQueue(simTime()+agentaux->hello_ival_);
 }
 
 
@@ -1208,21 +1208,11 @@ OLSR_ETX::rtable_default_computation()
 void
 OLSR_ETX::rtable_dijkstra_computation()
 {
-    nsaddr_t netmask (IPv4Address::ALLONES_ADDRESS);
     // Declare a class that will run the dijkstra algorithm
     Dijkstra *dijkstra = new Dijkstra();
 
-    // All the entries from the routing table are removed.
-    if (par("DelOnlyRtEntriesInrtable_").boolValue())
-    {
-        for (rtable_t::const_iterator itRtTable = rtable_.getInternalTable()->begin();itRtTable != rtable_.getInternalTable()->begin();++itRtTable)
-        {
-            nsaddr_t addr = itRtTable->first;
-            omnet_chg_rte(addr, addr,netmask,1, true, addr);
-        }
-    }
-    else
-        omnet_clean_rte(); // clean IP tables
+    // All the entries from the routing table are removed; the IP routing
+    // table is updated with the differences by install_rtable() at the end.
     rtable_.clear();
 
 
@@ -1360,7 +1350,6 @@ OLSR_ETX::rtable_dijkstra_computation()
         {
             // add route...
             rtable_.add_entry(it->second, it->second, itDij->second.link().last_node(), 1, -1,itDij->second.link().quality(),itDij->second.link().getDelay());
-            omnet_chg_rte(it->second, it->second, netmask, hopCount, false, itDij->second.link().last_node());
         }
         else if (it->first > 1)
         {
@@ -1369,7 +1358,6 @@ OLSR_ETX::rtable_dijkstra_computation()
             if (entry==NULL)
                 opp_error("entry not found");
             rtable_.add_entry(it->second, entry->next_addr(), entry->iface_addr(), hopCount, entry->local_iface_index(),itDij->second.link().quality(),itDij->second.link().getDelay());
-            omnet_chg_rte (it->second, entry->next_addr(), netmask, hopCount, false, entry->iface_addr());
         }
         processed_nodes.erase(processed_nodes.begin());
         dijkstra->dijkstraMap.erase(itDij);
@@ -1383,7 +1371,6 @@ OLSR_ETX::rtable_dijkstra_computation()
         {
             // add route...
             rtable_.add_entry(*it, *it, dijkstra->D(*it).link().last_node(), 1, -1);
-            omnet_chg_rte(*it, *it, netmask, 1, false, dijkstra->D(*it).link().last_node());
             processed_nodes.insert(*it);
         }
     }
@@ -1398,7 +1385,6 @@ OLSR_ETX::rtable_dijkstra_computation()
             OLSR_ETX_rt_entry* entry = rtable_.lookup(dijkstra->D(*it).link().last_node());
             assert(entry != NULL);
             rtable_.add_entry(*it, dijkstra->D(*it).link().last_node(), entry->iface_addr(), 2, entry->local_iface_index());
-            omnet_chg_rte(*it, dijkstra->D(*it).link().last_node(), netmask, 2, false, entry->iface_addr());
             processed_nodes.insert(*it);
         }
     }
@@ -1415,7 +1401,6 @@ OLSR_ETX::rtable_dijkstra_computation()
                 OLSR_ETX_rt_entry* entry = rtable_.lookup(dijkstra->D(*it).link().last_node());
                 assert(entry != NULL);
                 rtable_.add_entry(*it, entry->next_addr(), entry->iface_addr(), i, entry->local_iface_index());
-                omnet_chg_rte(*it, entry->next_addr(), netmask, i, false, entry->iface_addr());
                 processed_nodes.insert(*it);
             }
         }
@@ -1439,13 +1424,12 @@ OLSR_ETX::rtable_dijkstra_computation()
         {
             rtable_.add_entry(tuple->iface_addr(),
                               entry1->next_addr(), entry1->iface_addr(), entry1->dist(), entry1->local_iface_index(),entry1->quality,entry1->delay);
-            omnet_chg_rte(tuple->iface_addr(), entry1->next_addr(), netmask, entry1->dist(), false, entry1->iface_addr());
-
         }
     }
     // rtable_.print_debug(this);
     // destroy the dijkstra class we've created
     // dijkstra->clear ();
+    install_rtable();
     delete dijkstra;
 }
 
@@ -2675,7 +2659,7 @@ OLSR_ETX::~OLSR_ETX()
     while (timerQueuePtr && timerQueuePtr->size()>0)
     {
         OLSR_Timer * timer = timerQueuePtr->begin()->second;
-        timerQueuePtr->erase(timerQueuePtr->begin());
+        timer->removeQueueTimer();
         timer->setTuple(NULL);
         if (helloTimer==timer)
             helloTimer = NULL;
@@ -38,44 +38,42 @@ OLSR_ETX_link_tuple*  OLSR_ETX_state::find_best_sym_link_tuple(const nsaddr_t &m
 {
     OLSR_ETX_link_tuple* best = NULL;
 
-    for (ifaceassocset_t::iterator it = ifaceassocset_.begin();
-            it != ifaceassocset_.end(); it++)
+    std::pair<std::multimap<nsaddr_t, OLSR_iface_assoc_tuple*>::iterator, std::multimap<nsaddr_t, OLSR_iface_assoc_tuple*>::iterator> range =
+        ifaceassocByMain_.equal_range(main_addr);
+    for (std::multimap<nsaddr_t, OLSR_iface_assoc_tuple*>::iterator it = range.first; it != range.second; it++)
     {
-        OLSR_ETX_iface_assoc_tuple* iface_assoc_tuple = *it;
-        if (iface_assoc_tuple->main_addr() == main_addr)
+        OLSR_ETX_iface_assoc_tuple* iface_assoc_tuple = it->second;
+        OLSR_link_tuple *tupleAux = find_sym_link_tuple(iface_assoc_tuple->iface_addr(), now);
+        if (tupleAux == NULL)
+            continue;
+        OLSR_ETX_link_tuple* tuple =
+            dynamic_cast<OLSR_ETX_link_tuple*> (tupleAux);
+        if (best == NULL)
+            best = tuple;
+        else
         {
-            OLSR_link_tuple *tupleAux = find_sym_link_tuple(iface_assoc_tuple->iface_addr(), now);
-            if (tupleAux == NULL)
-                continue;
-            OLSR_ETX_link_tuple* tuple =
-                dynamic_cast<OLSR_ETX_link_tuple*> (tupleAux);
-            if (best == NULL)
-                best = tuple;
+            if (parameter->link_delay())
+            {
+                if (tuple->nb_link_delay() < best->nb_link_delay())
+                    best = tuple;
+            }
             else
             {
-                if (parameter->link_delay())
+                switch (parameter->link_quality())
                 {
-                    if (tuple->nb_link_delay() < best->nb_link_delay())
+                case OLSR_ETX_BEHAVIOR_ETX:
+                    if (tuple->etx() < best->etx())
                         best = tuple;
-                }
-                else
-                {
-                    switch (parameter->link_quality())
-                    {
-                    case OLSR_ETX_BEHAVIOR_ETX:
-                        if (tuple->etx() < best->etx())
-                            best = tuple;
-                        break;
+                    break;
 
-                    case OLSR_ETX_BEHAVIOR_ML:
-                        if (tuple->etx() > best->etx())
-                            best = tuple;
-                        break;
-                    case OLSR_ETX_BEHAVIOR_NONE:
-                    default:
-                        // best = tuple;
-                        break;
-                    }
+                case OLSR_ETX_BEHAVIOR_ML:
+                    if (tuple->etx() > best->etx())
+                        best = tuple;
+                    break;
+                case OLSR_ETX_BEHAVIOR_NONE:
+                default:
+                    // best = tuple;
+                    break;
                 }
             }
         }
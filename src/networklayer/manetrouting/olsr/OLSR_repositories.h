@@ -89,6 +89,8 @@ typedef struct OLSR_rt_entry : public cObject
 /// An Interface Association Tuple.
 typedef struct OLSR_iface_assoc_tuple : public cObject
 {
+    /// Insertion order in OLSR_state, used to find the tuple in its set.
+    unsigned long insertSeq_;
     /// Interface address of a node.
     nsaddr_t    iface_addr_;
     /// Main address of the node.
@@ -122,6 +124,8 @@ typedef struct OLSR_iface_assoc_tuple : public cObject
 /// A Link Tuple.
 typedef struct OLSR_link_tuple : public cObject
 {
+    /// Insertion order in OLSR_state, used to find the tuple in its set.
+    unsigned long insertSeq_;
     /// Interface address of the local node.
     nsaddr_t    local_iface_addr_;
     /// Interface address of the neighbor node.
@@ -164,6 +168,8 @@ typedef struct OLSR_link_tuple : public cObject
 /// A Neighbor Tuple.
 typedef struct OLSR_nb_tuple : public cObject
 {
+    /// Insertion order in OLSR_state, used to find the tuple in its set.
+    unsigned long insertSeq_;
     /// Main address of a neighbor node.
     nsaddr_t nb_main_addr_;
     /// Neighbor Type and Link Type at the four less significative digits.
@@ -195,6 +201,8 @@ typedef struct OLSR_nb_tuple : public cObject
 /// A 2-hop Tuple.
 typedef struct OLSR_nb2hop_tuple : public cObject
 {
+    /// Insertion order in OLSR_state, used to find the tuple in its set.
+    unsigned long insertSeq_;
     /// Main address of a neighbor.
     nsaddr_t    nb_main_addr_;
     /// Main address of a 2-hop neighbor with a symmetric link to nb_main_addr.
@@ -224,6 +232,8 @@ typedef struct OLSR_nb2hop_tuple : public cObject
 /// An MPR-Selector Tuple.
 typedef struct OLSR_mprsel_tuple : public cObject
 {
+    /// Insertion order in OLSR_state, used to find the tuple in its set.
+    unsigned long insertSeq_;
     /// Main address of a node which have selected this node as a MPR.
     nsaddr_t    main_addr_;
     /// Time at which this tuple expires and must be removed.
@@ -252,6 +262,8 @@ typedef std::vector<nsaddr_t> addr_list_t;
 /// A Duplicate Tuple
 typedef struct OLSR_dup_tuple : public cObject
 {
+    /// Insertion order in OLSR_state, used to find the tuple in its set.
+    unsigned long insertSeq_;
     /// Originator address of the message.
     nsaddr_t    addr_;
     /// Message sequence number.
@@ -286,6 +298,8 @@ typedef struct OLSR_dup_tuple : public cObject
 /// A Topology Tuple
 typedef struct OLSR_topology_tuple : public cObject
 {
+    /// Insertion order in OLSR_state, used to find the tuple in its set.
+    unsigned long insertSeq_;
     /// Main address of the destination.
     nsaddr_t    dest_addr_;
     /// Main address of a node which is a neighbor of the destination.
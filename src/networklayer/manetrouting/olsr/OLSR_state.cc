@@ -26,39 +26,74 @@
 ///     state of an OLSR node.
 ///
 
+#include <algorithm>
+
 #include "OLSR_state.h"
 #include "OLSR.h"
 
+/********** Index helpers **********/
+
+template<class Index, class Tuple>
+static void index_insert(Index& index, const typename Index::key_type& key, Tuple* tuple)
+{
+    // equal keys go after the existing ones, i.e. in insertion order
+    index.insert(index.upper_bound(key), std::make_pair(key, tuple));
+}
+
+/// Removes tuple from the index; returns false if it was not there.
+template<class Index, class Tuple>
+static bool index_erase(Index& index, const typename Index::key_type& key, Tuple* tuple)
+{
+    std::pair<typename Index::iterator, typename Index::iterator> range = index.equal_range(key);
+    for (typename Index::iterator it = range.first; it != range.second; ++it)
+    {
+        if (it->second == tuple)
+        {
+            index.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+struct SeqLess
+{
+    template<class Tuple>
+    bool operator()(const Tuple* a, const Tuple* b) const { return a->insertSeq_ < b->insertSeq_; }
+};
+
+/// The sets are sorted by insertion order, so the tuple is found by binary
+/// search. The set order must be kept because OLSR iterates the sets, so
+/// erase() still moves the pointers after the tuple.
+template<class Set, class Tuple>
+static void set_erase(Set& set, Tuple* tuple)
+{
+    typename Set::iterator it = std::lower_bound(set.begin(), set.end(), tuple, SeqLess());
+    if (it != set.end() && *it == tuple)
+        set.erase(it);
+}
+
 /********** MPR Selector Set Manipulation **********/
 
 OLSR_mprsel_tuple*
 OLSR_state::find_mprsel_tuple(const nsaddr_t &main_addr)
 {
-    for (mprselset_t::iterator it = mprselset_.begin(); it != mprselset_.end(); it++)
-    {
-        OLSR_mprsel_tuple* tuple = *it;
-        if (tuple->main_addr() == main_addr)
-            return tuple;
-    }
-    return NULL;
+    std::multimap<nsaddr_t, OLSR_mprsel_tuple*>::iterator it = mprselByAddr_.find(main_addr);
+    return it != mprselByAddr_.end() ? it->second : NULL;
 }
 
 void
 OLSR_state::erase_mprsel_tuple(OLSR_mprsel_tuple* tuple)
 {
-    for (mprselset_t::iterator it = mprselset_.begin(); it != mprselset_.end(); it++)
-    {
-        if (*it == tuple)
-        {
-            mprselset_.erase(it);
-            break;
-        }
-    }
+    if (index_erase(mprselByAddr_, tuple->main_addr(), tuple))
+        set_erase(mprselset_, tuple);
 }
 
 bool
 OLSR_state::erase_mprsel_tuples(const nsaddr_t & main_addr)
 {
+    if (mprselByAddr_.erase(main_addr) == 0)
+        return false;
     bool topologyChanged = false;
     for (mprselset_t::iterator it = mprselset_.begin(); it != mprselset_.end();)
     {
@@ -80,7 +115,9 @@ OLSR_state::erase_mprsel_tuples(const nsaddr_t & main_addr)
 void
 OLSR_state::insert_mprsel_tuple(OLSR_mprsel_tuple* tuple)
 {
+    tuple->insertSeq_ = nextSeq_++;
     mprselset_.push_back(tuple);
+    index_insert(mprselByAddr_, tuple->main_addr(), tuple);
 }
 
 /********** Neighbor Set Manipulation **********/
@@ -88,22 +125,18 @@ OLSR_state::insert_mprsel_tuple(OLSR_mprsel_tuple* tuple)
 OLSR_nb_tuple*
 OLSR_state::find_nb_tuple(const nsaddr_t & main_addr)
 {
-    for (nbset_t::iterator it = nbset_.begin(); it != nbset_.end(); it++)
-    {
-        OLSR_nb_tuple* tuple = *it;
-        if (tuple->nb_main_addr() == main_addr)
-            return tuple;
-    }
-    return NULL;
+    std::multimap<nsaddr_t, OLSR_nb_tuple*>::iterator it = nbByAddr_.find(main_addr);
+    return it != nbByAddr_.end() ? it->second : NULL;
 }
 
 OLSR_nb_tuple*
 OLSR_state::find_sym_nb_tuple(const nsaddr_t & main_addr)
 {
-    for (nbset_t::iterator it = nbset_.begin(); it != nbset_.end(); it++)
+    std::pair<std::multimap<nsaddr_t, OLSR_nb_tuple*>::iterator, std::multimap<nsaddr_t, OLSR_nb_tuple*>::iterator> range = nbByAddr_.equal_range(main_addr);
+    for (std::multimap<nsaddr_t, OLSR_nb_tuple*>::iterator it = range.first; it != range.second; it++)
     {
-        OLSR_nb_tuple* tuple = *it;
-        if (tuple->nb_main_addr() == main_addr && tuple->getStatus() == OLSR_STATUS_SYM)
+        OLSR_nb_tuple* tuple = it->second;
+        if (tuple->getStatus() == OLSR_STATUS_SYM)
             return tuple;
     }
     return NULL;
@@ -112,10 +145,11 @@ OLSR_state::find_sym_nb_tuple(const nsaddr_t & main_addr)
 OLSR_nb_tuple*
 OLSR_state::find_nb_tuple(const nsaddr_t & main_addr, uint8_t willingness)
 {
-    for (nbset_t::iterator it = nbset_.begin(); it != nbset_.end(); it++)
+    std::pair<std::multimap<nsaddr_t, OLSR_nb_tuple*>::iterator, std::multimap<nsaddr_t, OLSR_nb_tuple*>::iterator> range = nbByAddr_.equal_range(main_addr);
+    for (std::multimap<nsaddr_t, OLSR_nb_tuple*>::iterator it = range.first; it != range.second; it++)
     {
-        OLSR_nb_tuple* tuple = *it;
-        if (tuple->nb_main_addr() == main_addr && tuple->willingness() == willingness)
+        OLSR_nb_tuple* tuple = it->second;
+        if (tuple->willingness() == willingness)
             return tuple;
     }
     return NULL;
@@ -124,34 +158,24 @@ OLSR_state::find_nb_tuple(const nsaddr_t & main_addr, uint8_t willingness)
 void
 OLSR_state::erase_nb_tuple(OLSR_nb_tuple* tuple)
 {
-    for (nbset_t::iterator it = nbset_.begin(); it != nbset_.end(); it++)
-    {
-        if (*it == tuple)
-        {
-            nbset_.erase(it);
-            break;
-        }
-    }
+    if (index_erase(nbByAddr_, tuple->nb_main_addr(), tuple))
+        set_erase(nbset_, tuple);
 }
 
 void
 OLSR_state::erase_nb_tuple(const nsaddr_t & main_addr)
 {
-    for (nbset_t::iterator it = nbset_.begin(); it != nbset_.end(); it++)
-    {
-        OLSR_nb_tuple* tuple = *it;
-        if (tuple->nb_main_addr() == main_addr)
-        {
-            it = nbset_.erase(it);
-            break;
-        }
-    }
+    OLSR_nb_tuple* tuple = find_nb_tuple(main_addr);
+    if (tuple)
+        erase_nb_tuple(tuple);
 }
 
 void
 OLSR_state::insert_nb_tuple(OLSR_nb_tuple* tuple)
 {
+    tuple->insertSeq_ = nextSeq_++;
     nbset_.push_back(tuple);
+    index_insert(nbByAddr_, tuple->nb_main_addr(), tuple);
 }
 
 /********** Neighbor 2 Hop Set Manipulation **********/
@@ -159,58 +183,47 @@ OLSR_state::insert_nb_tuple(OLSR_nb_tuple* tuple)
 OLSR_nb2hop_tuple*
 OLSR_state::find_nb2hop_tuple(const nsaddr_t & nb_main_addr, const nsaddr_t & nb2hop_addr)
 {
-    for (nb2hopset_t::iterator it = nb2hopset_.begin(); it != nb2hopset_.end(); it++)
-    {
-        OLSR_nb2hop_tuple* tuple = *it;
-        if (tuple->nb_main_addr() == nb_main_addr && tuple->nb2hop_addr() == nb2hop_addr)
-            return tuple;
-    }
-    return NULL;
+    std::multimap<AddrPair, OLSR_nb2hop_tuple*>::iterator it = nb2hopByPair_.find(AddrPair(nb_main_addr, nb2hop_addr));
+    return it != nb2hopByPair_.end() ? it->second : NULL;
 }
 
 void
 OLSR_state::erase_nb2hop_tuple(OLSR_nb2hop_tuple* tuple)
 {
-    for (nb2hopset_t::iterator it = nb2hopset_.begin(); it != nb2hopset_.end(); it++)
+    if (index_erase(nb2hopByPair_, AddrPair(tuple->nb_main_addr(), tuple->nb2hop_addr()), tuple))
     {
-        if (*it == tuple)
-        {
-            nb2hopset_.erase(it);
-            break;
-        }
+        index_erase(nb2hopByNb_, tuple->nb_main_addr(), tuple);
+        set_erase(nb2hopset_, tuple);
     }
 }
 
 bool
 OLSR_state::erase_nb2hop_tuples(const nsaddr_t & nb_main_addr, const nsaddr_t & nb2hop_addr)
 {
-    bool returnValue = false;
-    for (nb2hopset_t::iterator it = nb2hopset_.begin(); it != nb2hopset_.end();)
+    std::pair<std::multimap<AddrPair, OLSR_nb2hop_tuple*>::iterator, std::multimap<AddrPair, OLSR_nb2hop_tuple*>::iterator> range = nb2hopByPair_.equal_range(AddrPair(nb_main_addr, nb2hop_addr));
+    if (range.first == range.second)
+        return false;
+    for (std::multimap<AddrPair, OLSR_nb2hop_tuple*>::iterator it = range.first; it != range.second; it++)
     {
-        OLSR_nb2hop_tuple* tuple = *it;
-        if (tuple->nb_main_addr() == nb_main_addr && tuple->nb2hop_addr() == nb2hop_addr)
-        {
-            it = nb2hopset_.erase(it);
-            returnValue = true;
-            if (nb2hopset_.empty())
-                break;
-        }
-        else
-            it++;
-
+        index_erase(nb2hopByNb_, nb_main_addr, it->second);
+        set_erase(nb2hopset_, it->second);
     }
-    return returnValue;
+    nb2hopByPair_.erase(range.first, range.second);
+    return true;
 }
 
 bool
 OLSR_state::erase_nb2hop_tuples(const nsaddr_t & nb_main_addr)
 {
+    if (nb2hopByNb_.count(nb_main_addr) == 0)
+        return false;
     bool topologyChanged = false;
     for (nb2hopset_t::iterator it = nb2hopset_.begin(); it != nb2hopset_.end();)
     {
         OLSR_nb2hop_tuple* tuple = *it;
         if (tuple->nb_main_addr() == nb_main_addr)
         {
+            index_erase(nb2hopByPair_, AddrPair(tuple->nb_main_addr(), tuple->nb2hop_addr()), tuple);
             it = nb2hopset_.erase(it);
             topologyChanged = true;
             if (nb2hopset_.empty())
@@ -220,13 +233,17 @@ OLSR_state::erase_nb2hop_tuples(const nsaddr_t & nb_main_addr)
             it++;
 
     }
+    nb2hopByNb_.erase(nb_main_addr);
     return topologyChanged;
 }
 
 void
 OLSR_state::insert_nb2hop_tuple(OLSR_nb2hop_tuple* tuple)
 {
+    tuple->insertSeq_ = nextSeq_++;
     nb2hopset_.push_back(tuple);
+    index_insert(nb2hopByPair_, AddrPair(tuple->nb_main_addr(), tuple->nb2hop_addr()), tuple);
+    index_insert(nb2hopByNb_, tuple->nb_main_addr(), tuple);
 }
 
 /********** MPR Set Manipulation **********/
@@ -255,32 +272,23 @@ OLSR_state::clear_mprset()
 OLSR_dup_tuple*
 OLSR_state::find_dup_tuple(const nsaddr_t & addr, uint16_t seq_num)
 {
-    for (dupset_t::iterator it = dupset_.begin(); it != dupset_.end(); it++)
-    {
-        OLSR_dup_tuple* tuple = *it;
-        if (tuple->getAddr() == addr && tuple->seq_num() == seq_num)
-            return tuple;
-    }
-    return NULL;
+    std::multimap<AddrSeq, OLSR_dup_tuple*>::iterator it = dupByAddrSeq_.find(AddrSeq(addr, seq_num));
+    return it != dupByAddrSeq_.end() ? it->second : NULL;
 }
 
 void
 OLSR_state::erase_dup_tuple(OLSR_dup_tuple* tuple)
 {
-    for (dupset_t::iterator it = dupset_.begin(); it != dupset_.end(); it++)
-    {
-        if (*it == tuple)
-        {
-            dupset_.erase(it);
-            break;
-        }
-    }
+    if (index_erase(dupByAddrSeq_, AddrSeq(tuple->getAddr(), tuple->seq_num()), tuple))
+        set_erase(dupset_, tuple);
 }
 
 void
 OLSR_state::insert_dup_tuple(OLSR_dup_tuple* tuple)
 {
+    tuple->insertSeq_ = nextSeq_++;
     dupset_.push_back(tuple);
+    index_insert(dupByAddrSeq_, AddrSeq(tuple->getAddr(), tuple->seq_num()), tuple);
 }
 
 /********** Link Set Manipulation **********/
@@ -288,49 +296,32 @@ OLSR_state::insert_dup_tuple(OLSR_dup_tuple* tuple)
 OLSR_link_tuple*
 OLSR_state::find_link_tuple(const nsaddr_t & iface_addr)
 {
-    for (linkset_t::iterator it = linkset_.begin(); it != linkset_.end(); it++)
-    {
-        OLSR_link_tuple* tuple = *it;
-        if (tuple->nb_iface_addr() == iface_addr)
-            return tuple;
-    }
-    return NULL;
+    std::multimap<nsaddr_t, OLSR_link_tuple*>::iterator it = linkByIface_.find(iface_addr);
+    return it != linkByIface_.end() ? it->second : NULL;
 }
 
 OLSR_link_tuple*
 OLSR_state::find_sym_link_tuple(const nsaddr_t & iface_addr, double now)
 {
-    for (linkset_t::iterator it = linkset_.begin(); it != linkset_.end(); it++)
-    {
-        OLSR_link_tuple* tuple = *it;
-        if (tuple->nb_iface_addr() == iface_addr)
-        {
-            if (tuple->sym_time() > now)
-                return tuple;
-            else
-                break;
-        }
-    }
+    OLSR_link_tuple* tuple = find_link_tuple(iface_addr);
+    if (tuple && tuple->sym_time() > now)
+        return tuple;
     return NULL;
 }
 
 void
 OLSR_state::erase_link_tuple(OLSR_link_tuple* tuple)
 {
-    for (linkset_t::iterator it = linkset_.begin(); it != linkset_.end(); it++)
-    {
-        if (*it == tuple)
-        {
-            linkset_.erase(it);
-            break;
-        }
-    }
+    if (index_erase(linkByIface_, tuple->nb_iface_addr(), tuple))
+        set_erase(linkset_, tuple);
 }
 
 void
 OLSR_state::insert_link_tuple(OLSR_link_tuple* tuple)
 {
+    tuple->insertSeq_ = nextSeq_++;
     linkset_.push_back(tuple);
+    index_insert(linkByIface_, tuple->nb_iface_addr(), tuple);
 }
 
 /********** Topology Set Manipulation **********/
@@ -338,22 +329,18 @@ OLSR_state::insert_link_tuple(OLSR_link_tuple* tuple)
 OLSR_topology_tuple*
 OLSR_state::find_topology_tuple(const nsaddr_t & dest_addr, const nsaddr_t & last_addr)
 {
-    for (topologyset_t::iterator it = topologyset_.begin(); it != topologyset_.end(); it++)
-    {
-        OLSR_topology_tuple* tuple = *it;
-        if (tuple->dest_addr() == dest_addr && tuple->last_addr() == last_addr)
-            return tuple;
-    }
-    return NULL;
+    std::multimap<AddrPair, OLSR_topology_tuple*>::iterator it = topologyByPair_.find(AddrPair(dest_addr, last_addr));
+    return it != topologyByPair_.end() ? it->second : NULL;
 }
 
 OLSR_topology_tuple*
 OLSR_state::find_newer_topology_tuple(const nsaddr_t &last_addr, uint16_t ansn)
 {
-    for (topologyset_t::iterator it = topologyset_.begin(); it != topologyset_.end(); it++)
+    std::pair<std::multimap<nsaddr_t, OLSR_topology_tuple*>::iterator, std::multimap<nsaddr_t, OLSR_topology_tuple*>::iterator> range = topologyByLast_.equal_range(last_addr);
+    for (std::multimap<nsaddr_t, OLSR_topology_tuple*>::iterator it = range.first; it != range.second; it++)
     {
-        OLSR_topology_tuple* tuple = *it;
-        if (tuple->last_addr() == last_addr && tuple->seq() > ansn)
+        OLSR_topology_tuple* tuple = it->second;
+        if (tuple->seq() > ansn)
             return tuple;
     }
     return NULL;
@@ -362,15 +349,22 @@ OLSR_state::find_newer_topology_tuple(const nsaddr_t &last_addr, uint16_t ansn)
 void
 OLSR_state::erase_topology_tuple(OLSR_topology_tuple* tuple)
 {
-    for (topologyset_t::iterator it = topologyset_.begin(); it != topologyset_.end(); it++)
+    if (index_erase(topologyByPair_, AddrPair(tuple->dest_addr(), tuple->last_addr()), tuple))
     {
-        if (*it == tuple)
-        {
-            topologyset_.erase(it);
-            break;
-        }
+        index_erase(topologyByLast_, tuple->last_addr(), tuple);
+        set_erase(topologyset_, tuple);
     }
 }
+
+topologyset_t::iterator
+OLSR_state::erase_topology_tuple(topologyset_t::iterator it)
+{
+    OLSR_topology_tuple* tuple = *it;
+    index_erase(topologyByPair_, AddrPair(tuple->dest_addr(), tuple->last_addr()), tuple);
+    index_erase(topologyByLast_, tuple->last_addr(), tuple);
+    return topologyset_.erase(it);
+}
+
 std::ostream& operator<<(std::ostream& out, const OLSR_topology_tuple& tuple)
 {
     out << "Tuple index: " << tuple.index;
@@ -406,6 +400,24 @@ OLSR_state::print_topology_tuples_across(const nsaddr_t & last_addr)
 void
 OLSR_state::erase_older_topology_tuples(const nsaddr_t & last_addr, uint16_t ansn)
 {
+    // find the tuples through the index, and only scan the set if there are any
+    bool found = false;
+    std::pair<std::multimap<nsaddr_t, OLSR_topology_tuple*>::iterator, std::multimap<nsaddr_t, OLSR_topology_tuple*>::iterator> range = topologyByLast_.equal_range(last_addr);
+    for (std::multimap<nsaddr_t, OLSR_topology_tuple*>::iterator it = range.first; it != range.second; )
+    {
+        OLSR_topology_tuple* tuple = it->second;
+        if (tuple->seq() < ansn)
+        {
+            index_erase(topologyByPair_, AddrPair(tuple->dest_addr(), tuple->last_addr()), tuple);
+            topologyByLast_.erase(it++);
+            found = true;
+        }
+        else
+            it++;
+    }
+    if (!found)
+        return;
+
     for (topologyset_t::iterator it = topologyset_.begin(); it != topologyset_.end();)
     {
         OLSR_topology_tuple* tuple = *it;
@@ -424,7 +436,10 @@ OLSR_state::erase_older_topology_tuples(const nsaddr_t & last_addr, uint16_t ans
 void
 OLSR_state::insert_topology_tuple(OLSR_topology_tuple* tuple)
 {
+    tuple->insertSeq_ = nextSeq_++;
     topologyset_.push_back(tuple);
+    index_insert(topologyByPair_, AddrPair(tuple->dest_addr(), tuple->last_addr()), tuple);
+    index_insert(topologyByLast_, tuple->last_addr(), tuple);
 }
 
 /********** Interface Association Set Manipulation **********/
@@ -432,36 +447,27 @@ OLSR_state::insert_topology_tuple(OLSR_topology_tuple* tuple)
 OLSR_iface_assoc_tuple*
 OLSR_state::find_ifaceassoc_tuple(const nsaddr_t & iface_addr)
 {
-    for (ifaceassocset_t::iterator it = ifaceassocset_.begin();
-            it != ifaceassocset_.end();
-            it++)
-    {
-        OLSR_iface_assoc_tuple* tuple = *it;
-        if (tuple->iface_addr() == iface_addr)
-            return tuple;
-    }
-    return NULL;
+    std::multimap<nsaddr_t, OLSR_iface_assoc_tuple*>::iterator it = ifaceassocByIface_.find(iface_addr);
+    return it != ifaceassocByIface_.end() ? it->second : NULL;
 }
 
 void
 OLSR_state::erase_ifaceassoc_tuple(OLSR_iface_assoc_tuple* tuple)
 {
-    for (ifaceassocset_t::iterator it = ifaceassocset_.begin();
-            it != ifaceassocset_.end();
-            it++)
+    if (index_erase(ifaceassocByIface_, tuple->iface_addr(), tuple))
     {
-        if (*it == tuple)
-        {
-            ifaceassocset_.erase(it);
-            break;
-        }
+        index_erase(ifaceassocByMain_, tuple->main_addr(), tuple);
+        set_erase(ifaceassocset_, tuple);
     }
 }
 
 void
 OLSR_state::insert_ifaceassoc_tuple(OLSR_iface_assoc_tuple* tuple)
 {
+    tuple->insertSeq_ = nextSeq_++;
     ifaceassocset_.push_back(tuple);
+    index_insert(ifaceassocByIface_, tuple->iface_addr(), tuple);
+    index_insert(ifaceassocByMain_, tuple->main_addr(), tuple);
 }
 
 void OLSR_state::clear_all()
@@ -493,32 +499,42 @@ void OLSR_state::clear_all()
     ifaceassocset_.clear();
     mprset_.clear();
 
+    linkByIface_.clear();
+    nbByAddr_.clear();
+    nb2hopByPair_.clear();
+    nb2hopByNb_.clear();
+    topologyByPair_.clear();
+    topologyByLast_.clear();
+    mprselByAddr_.clear();
+    dupByAddrSeq_.clear();
+    ifaceassocByIface_.clear();
+    ifaceassocByMain_.clear();
 }
 
-OLSR_state::OLSR_state(OLSR_state * st)
+OLSR_state::OLSR_state(OLSR_state * st) : nextSeq_(0)
 {
     for (linkset_t::iterator it = st->linkset_.begin(); it != st->linkset_.end(); it++)
     {
         OLSR_link_tuple* tuple = *it;
-        linkset_.push_back(tuple->dup());
+        insert_link_tuple(tuple->dup());
     }
 
     for (nbset_t::iterator it = st->nbset_.begin(); it != st->nbset_.end(); it++)
     {
         OLSR_nb_tuple* tuple = *it;
-        nbset_.push_back(tuple->dup());
+        insert_nb_tuple(tuple->dup());
     }
 
     for (nb2hopset_t::iterator it = st->nb2hopset_.begin(); it != st->nb2hopset_.end(); it++)
     {
         OLSR_nb2hop_tuple* tuple = *it;
-        nb2hopset_.push_back(tuple->dup());
+        insert_nb2hop_tuple(tuple->dup());
     }
 
     for (topologyset_t::iterator it = st->topologyset_.begin(); it != st->topologyset_.end(); it++)
     {
         OLSR_topology_tuple* tuple = *it;
-        topologyset_.push_back(tuple->dup());
+        insert_topology_tuple(tuple->dup());
     }
 
     for (mprset_t::iterator it = st->mprset_.begin(); it != st->mprset_.end(); it++)
@@ -529,19 +545,19 @@ OLSR_state::OLSR_state(OLSR_state * st)
     for (mprselset_t::iterator it = st->mprselset_.begin(); it != st->mprselset_.end(); it++)
     {
         OLSR_mprsel_tuple* tuple = *it;
-        mprselset_.push_back(tuple->dup());
+        insert_mprsel_tuple(tuple->dup());
     }
 
     for (dupset_t::iterator it = st->dupset_.begin(); it != st->dupset_.end(); it++)
     {
         OLSR_dup_tuple* tuple = *it;
-        dupset_.push_back(tuple->dup());
+        insert_dup_tuple(tuple->dup());
     }
 
     for (ifaceassocset_t::iterator it = st->ifaceassocset_.begin(); it != st->ifaceassocset_.end(); it++)
     {
         OLSR_iface_assoc_tuple* tuple = *it;
-        ifaceassocset_.push_back(tuple->dup());
+        insert_ifaceassoc_tuple(tuple->dup());
     }
 }
 
@@ -26,6 +26,8 @@
 #ifndef __OLSR_state_h__
 #define __OLSR_state_h__
 
+#include <map>
+
 #include "INETDefs.h"
 
 #include "OLSR_repositories.h"
@@ -45,6 +47,27 @@ class OLSR_state : public cObject
     dupset_t    dupset_;    ///< Duplicate Set (RFC 3626, section 3.4).
     ifaceassocset_t ifaceassocset_; ///< Interface Association Set (RFC 3626, section 4.1).
 
+    /// \name Indexes into the sets above. Tuples with equal keys are kept in
+    /// insertion order, so lookups return the same tuple as a scan of the set.
+    //@{
+    typedef std::pair<nsaddr_t, nsaddr_t> AddrPair;
+    typedef std::pair<nsaddr_t, uint16_t> AddrSeq;
+    std::multimap<nsaddr_t, OLSR_link_tuple*> linkByIface_;         ///< by nb_iface_addr
+    std::multimap<nsaddr_t, OLSR_nb_tuple*> nbByAddr_;              ///< by nb_main_addr
+    std::multimap<AddrPair, OLSR_nb2hop_tuple*> nb2hopByPair_;      ///< by (nb_main_addr, nb2hop_addr)
+    std::multimap<nsaddr_t, OLSR_nb2hop_tuple*> nb2hopByNb_;        ///< by nb_main_addr
+    std::multimap<AddrPair, OLSR_topology_tuple*> topologyByPair_;  ///< by (dest_addr, last_addr)
+    std::multimap<nsaddr_t, OLSR_topology_tuple*> topologyByLast_;  ///< by last_addr
+    std::multimap<nsaddr_t, OLSR_mprsel_tuple*> mprselByAddr_;      ///< by main_addr
+    std::multimap<AddrSeq, OLSR_dup_tuple*> dupByAddrSeq_;          ///< by (addr, seq_num)
+    std::multimap<nsaddr_t, OLSR_iface_assoc_tuple*> ifaceassocByIface_; ///< by iface_addr
+    std::multimap<nsaddr_t, OLSR_iface_assoc_tuple*> ifaceassocByMain_;  ///< by main_addr
+    //@}
+
+    /// Sequence number of the next inserted tuple. Tuples are only appended
+    /// to the sets, so each set is sorted by the tuples' insertSeq_ fields.
+    unsigned long nextSeq_;
+
     inline  linkset_t&      linkset()   { return linkset_; }
     inline  mprset_t&       mprset()    { return mprset_; }
     inline  mprselset_t&        mprselset() { return mprselset_; }
@@ -88,6 +111,7 @@ class OLSR_state : public cObject
     OLSR_topology_tuple*    find_topology_tuple(const nsaddr_t &, const  nsaddr_t &);
     OLSR_topology_tuple*    find_newer_topology_tuple(const nsaddr_t &, uint16_t);
     void            erase_topology_tuple(OLSR_topology_tuple*);
+    topologyset_t::iterator erase_topology_tuple(topologyset_t::iterator);
     void            erase_older_topology_tuples(const nsaddr_t &, uint16_t);
     void             print_topology_tuples_to(const nsaddr_t & dest_addr);
     void             print_topology_tuples_across(const nsaddr_t & last_addr);
@@ -98,7 +122,7 @@ class OLSR_state : public cObject
     void            insert_ifaceassoc_tuple(OLSR_iface_assoc_tuple*);
     void            clear_all();
 
-    OLSR_state() {}
+    OLSR_state() : nextSeq_(0) {}
     ~OLSR_state();
     OLSR_state(OLSR_state *);
     virtual OLSR_state * dup() {return new OLSR_state(this);}
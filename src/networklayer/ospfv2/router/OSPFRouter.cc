@@ -758,6 +758,7 @@ void OSPF::Router::rebuildRoutingTable()
         }
     }
 
+    simRoutingTable->beginBatch();
     unsigned int eraseCount = eraseEntries.size();
     for (i = 0; i < eraseCount; i++) {
         simRoutingTable->deleteRoute(eraseEntries[i]);
@@ -770,6 +771,7 @@ void OSPF::Router::rebuildRoutingTable()
             simRoutingTable->addRoute(new OSPF::RoutingTableEntry(*(routingTable[i])));
         }
     }
+    simRoutingTable->commitBatch();
 
     notifyAboutRoutingTableChanges(oldTable);
 
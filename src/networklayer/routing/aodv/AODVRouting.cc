@@ -56,6 +56,9 @@ void AODVRouting::initialize(int stage)
         ttlIncrement = par("ttlIncrement");
         ttlThreshold = par("ttlThreshold");
         localAddTTL = par("localAddTTL");
+
+        // RREP timeouts expire at their exact times, the granularity only affects bucketing
+        timerWheel.initialize(this, 0.01);
         jitterPar = &par("jitter");
         periodicJitter = &par("periodicJitter");
 
@@ -108,8 +111,11 @@ void AODVRouting::handleMessage(cMessage *msg)
     }
 
     if (msg->isSelfMessage()) {
-        if (dynamic_cast<WaitForRREP *>(msg))
-            handleWaitForRREP((WaitForRREP *)msg);
+        if (timerWheel.isTickEvent(msg)) {
+            cMessage *timer;
+            while ((timer = timerWheel.popExpired()) != NULL)
+                handleWaitForRREP(check_and_cast<WaitForRREP *>(timer));
+        }
         else if (msg == helloMsgTimer)
             sendHelloMessagesIfNeeded();
         else if (msg == expungeTimer)
@@ -293,15 +299,15 @@ void AODVRouting::sendRREQ(AODVRREQ *rreq, const IPv4Address& destAddr, unsigned
         if (timeToLive != 0) {
             rrepTimerMsg->setLastTTL(timeToLive);
             rrepTimerMsg->setFromInvalidEntry(true);
-            cancelEvent(rrepTimerMsg);
+            timerWheel.cancel(rrepTimerMsg);
         }
         else if (lastTTL + ttlIncrement < ttlThreshold) {
-            ASSERT(!rrepTimerMsg->isScheduled());
+            ASSERT(!timerWheel.isScheduled(rrepTimerMsg));
             timeToLive = lastTTL + ttlIncrement;
             rrepTimerMsg->setLastTTL(lastTTL + ttlIncrement);
         }
         else {
-            ASSERT(!rrepTimerMsg->isScheduled());
+            ASSERT(!timerWheel.isScheduled(rrepTimerMsg));
             timeToLive = netDiameter;
             rrepTimerMsg->setLastTTL(netDiameter);
         }
@@ -319,7 +325,7 @@ void AODVRouting::sendRREQ(AODVRREQ *rreq, const IPv4Address& destAddr, unsigned
 
     // Each time, the timeout for receiving a RREP is RING_TRAVERSAL_TIME.
     simtime_t ringTraversalTime = 2.0 * nodeTraversalTime * (timeToLive + timeoutBuffer);
-    scheduleAt(simTime() + ringTraversalTime, rrepTimerMsg);
+    timerWheel.scheduleAt(simTime() + ringTraversalTime, rrepTimerMsg);
 
     EV_INFO << "Sending a Route Request with target " << rreq->getDestAddr() << " and TTL= " << timeToLive << endl;
     sendAODVPacket(rreq, destAddr, timeToLive, jitterPar->doubleValue());
@@ -1212,7 +1218,7 @@ void AODVRouting::clearState()
     rerrCount = rreqCount = rreqId = sequenceNum = 0;
     addressToRreqRetries.clear();
     for (std::map<IPv4Address, WaitForRREP *>::iterator it = waitForRREPTimers.begin(); it != waitForRREPTimers.end(); ++it)
-        cancelAndDelete(it->second);
+        delete timerWheel.cancel(it->second);
 
     // FIXME: Drop the queued datagrams.
     //for (std::multimap<IPv4Address, IPv4Datagram *>::iterator it = targetAddressToDelayedPackets.begin(); it != targetAddressToDelayedPackets.end(); it++)
@@ -1291,7 +1297,7 @@ void AODVRouting::completeRouteDiscovery(const IPv4Address& target)
     // we have a route for the destination, thus we must cancel the WaitForRREPTimer events
     std::map<IPv4Address, WaitForRREP *>::iterator waitRREPIter = waitForRREPTimers.find(target);
     ASSERT(waitRREPIter != waitForRREPTimers.end());
-    cancelAndDelete(waitRREPIter->second);
+    delete timerWheel.cancel(waitRREPIter->second);
     waitForRREPTimers.erase(waitRREPIter);
 }
 
@@ -27,6 +27,7 @@
 #include "ILifecycle.h"
 #include "NodeStatus.h"
 #include "NotificationBoard.h"
+#include "TimerWheel.h"
 #include "UDPSocket.h"
 #include "AODVRouteData.h"
 #include "UDPPacket.h"
@@ -124,6 +125,7 @@ class INET_API AODVRouting : public cSimpleModule, public ILifecycle, public INe
     cMessage *counterTimer;    // timer to set rrerCount = rreqCount = 0 in each second
     cMessage *rrepAckTimer;    // timer to wait for RREP-ACKs (RREP-ACK timeout)
     cMessage *blacklistTimer;    // timer to clean the blacklist out
+    TimerWheel timerWheel;    // holds the WaitForRREP timers, one per ongoing route discovery
 
     // lifecycle
     simtime_t rebootTime;    // the last time when the node rebooted
@@ -16,6 +16,8 @@
 // Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 //
 
+#include <algorithm>
+
 #include "GPSR.h"
 #include "InterfaceTableAccess.h"
 #include "IPProtocolId_m.h"
@@ -36,6 +38,15 @@ static inline double determinant(double a1, double a2, double b1, double b2) {
 
 static inline bool isNaN(double d) { return d != d;}
 
+// orders neighbor indices by angle, then by index (i.e. address)
+struct NeighborAngleLess
+{
+    const std::vector<double> & angles;
+    NeighborAngleLess(const std::vector<double> & angles) : angles(angles) { }
+    bool operator()(int a, int b) const { return angles[a] < angles[b] || (angles[a] == angles[b] && a < b); }
+    bool operator()(double angle, int b) const { return angle < angles[b]; }
+};
+
 // KLUDGE: implement position registry protocol
 PositionTable GPSR::globalPositionTable;
 
@@ -49,6 +60,8 @@ GPSR::GPSR()
     networkProtocol = NULL;
     beaconTimer = NULL;
     purgeNeighborsTimer = NULL;
+    neighborCacheVersion = 0;
+    planarNeighborsValid = false;
 }
 
 GPSR::~GPSR()
@@ -387,67 +400,80 @@ void GPSR::purgeNeighbors()
     neighborPositionTable.removeOldPositions(simTime() - neighborValidityInterval);
 }
 
-std::vector<IPvXAddress> GPSR::getPlanarNeighbors()
+void GPSR::updateNeighborCache()
 {
-    std::vector<IPvXAddress> planarNeighbors;
-    std::vector<IPvXAddress> neighborAddresses = neighborPositionTable.getAddresses();
+    // the neighbor table version is bumped on every insertion, removal and move
+    if (neighborCacheVersion == neighborPositionTable.getVersion())
+        return;
+    neighborCacheVersion = neighborPositionTable.getVersion();
+    neighborAddresses.clear();
+    neighborPositions.clear();
+    neighborPositionTable.getPositions(neighborAddresses, neighborPositions);
+    planarNeighborsValid = false;
+}
+
+const std::vector<int> & GPSR::getPlanarNeighbors()
+{
+    updateNeighborCache();
     Coord selfPosition = mobility->getCurrentPosition();
-    for (std::vector<IPvXAddress>::iterator it = neighborAddresses.begin(); it != neighborAddresses.end(); it++) {
-        const IPvXAddress & neighborAddress = *it;
-        Coord neighborPosition = neighborPositionTable.getPosition(neighborAddress);
+    if (planarNeighborsValid && selfPosition.x == planarNeighborsSelfPosition.x && selfPosition.y == planarNeighborsSelfPosition.y && selfPosition.z == planarNeighborsSelfPosition.z)
+        return planarNeighbors;
+
+    int numNeighbors = neighborAddresses.size();
+    planarNeighbors.clear();
+    neighborAngles.resize(numNeighbors);
+    for (int i = 0; i < numNeighbors; i++) {
+        const Coord & neighborPosition = neighborPositions[i];
+        neighborAngles[i] = getVectorAngle(neighborPosition - selfPosition);
         if (planarizationMode == GPSR_RNG_PLANARIZATION) {
             double neighborDistance = (neighborPosition - selfPosition).length();
-            for (std::vector<IPvXAddress>::iterator jt = neighborAddresses.begin(); jt != neighborAddresses.end(); jt++) {
-                const IPvXAddress & witnessAddress = *jt;
-                Coord witnessPosition = neighborPositionTable.getPosition(witnessAddress);
-                double witnessDistance = (witnessPosition - selfPosition).length();;
-                double neighborWitnessDistance = (witnessPosition - neighborPosition).length();
-                if (*it == *jt)
+            for (int j = 0; j < numNeighbors; j++) {
+                if (i == j)
                     continue;
-                else if (neighborDistance > std::max(witnessDistance, neighborWitnessDistance))
+                const Coord & witnessPosition = neighborPositions[j];
+                double witnessDistance = (witnessPosition - selfPosition).length();
+                double neighborWitnessDistance = (witnessPosition - neighborPosition).length();
+                if (neighborDistance > std::max(witnessDistance, neighborWitnessDistance))
                     goto eliminate;
             }
         }
         else if (planarizationMode == GPSR_GG_PLANARIZATION) {
             Coord middlePosition = (selfPosition + neighborPosition) / 2;
             double neighborDistance = (neighborPosition - middlePosition).length();
-            for (std::vector<IPvXAddress>::iterator jt = neighborAddresses.begin(); jt != neighborAddresses.end(); jt++) {
-                const IPvXAddress & witnessAddress = *jt;
-                Coord witnessPosition = neighborPositionTable.getPosition(witnessAddress);
-                double witnessDistance = (witnessPosition - middlePosition).length();;
-                if (*it == *jt)
+            for (int j = 0; j < numNeighbors; j++) {
+                if (i == j)
                     continue;
-                else if (witnessDistance < neighborDistance)
+                double witnessDistance = (neighborPositions[j] - middlePosition).length();
+                if (witnessDistance < neighborDistance)
                     goto eliminate;
             }
         }
         else
             throw cRuntimeError("Unknown planarization mode");
-        planarNeighbors.push_back(*it);
+        planarNeighbors.push_back(i);
         eliminate: ;
     }
+    std::sort(planarNeighbors.begin(), planarNeighbors.end(), NeighborAngleLess(neighborAngles));
+    planarNeighborsSelfPosition = selfPosition;
+    planarNeighborsValid = true;
     return planarNeighbors;
 }
 
 IPvXAddress GPSR::getNextPlanarNeighborCounterClockwise(const IPvXAddress& startNeighborAddress, double startNeighborAngle)
 {
     GPSR_EV << "Finding next planar neighbor (counter clockwise): startAddress = " << startNeighborAddress << ", startAngle = " << startNeighborAngle << endl;
-    IPvXAddress bestNeighborAddress = startNeighborAddress;
-    double bestNeighborAngleDifference = 2 * PI;
-    std::vector<IPvXAddress> neighborAddresses = getPlanarNeighbors();
-    for (std::vector<IPvXAddress>::iterator it = neighborAddresses.begin(); it != neighborAddresses.end(); it++) {
-        const IPvXAddress & neighborAddress = *it;
-        double neighborAngle = getNeighborAngle(neighborAddress);
-        double neighborAngleDifference = neighborAngle - startNeighborAngle;
-        if (neighborAngleDifference < 0)
-            neighborAngleDifference += 2 * PI;
-        GPSR_EV << "Trying next planar neighbor (counter clockwise): address = " << neighborAddress << ", angle = " << neighborAngle << endl;
-        if (neighborAngleDifference != 0 && neighborAngleDifference < bestNeighborAngleDifference) {
-            bestNeighborAngleDifference = neighborAngleDifference;
-            bestNeighborAddress = neighborAddress;
-        }
+    const std::vector<int> & neighbors = getPlanarNeighbors();
+    int numNeighbors = neighbors.size();
+    // the neighbors are sorted by angle, so the first one after the start angle
+    // (wrapping around) is the one with the smallest counter clockwise difference
+    int first = std::upper_bound(neighbors.begin(), neighbors.end(), startNeighborAngle, NeighborAngleLess(neighborAngles)) - neighbors.begin();
+    for (int k = 0; k < numNeighbors; k++) {
+        int i = neighbors[(first + k) % numNeighbors];
+        GPSR_EV << "Trying next planar neighbor (counter clockwise): address = " << neighborAddresses[i] << ", angle = " << neighborAngles[i] << endl;
+        if (neighborAngles[i] != startNeighborAngle)
+            return neighborAddresses[i];
     }
-    return bestNeighborAddress;
+    return startNeighborAddress;
 }
 
 //
@@ -474,14 +500,12 @@ IPvXAddress GPSR::findGreedyRoutingNextHop(IPv4Datagram * datagram, const IPvXAd
     Coord destinationPosition = packet->getDestinationPosition();
     double bestDistance = (destinationPosition - selfPosition).length();
     IPvXAddress bestNeighbor;
-    std::vector<IPvXAddress> neighborAddresses = neighborPositionTable.getAddresses();
-    for (std::vector<IPvXAddress>::iterator it = neighborAddresses.begin(); it != neighborAddresses.end(); it++) {
-        const IPvXAddress & neighborAddress = *it;
-        Coord neighborPosition = neighborPositionTable.getPosition(neighborAddress);
-        double neighborDistance = (destinationPosition - neighborPosition).length();
+    updateNeighborCache();
+    for (int i = 0; i < (int)neighborAddresses.size(); i++) {
+        double neighborDistance = (destinationPosition - neighborPositions[i]).length();
         if (neighborDistance < bestDistance) {
             bestDistance = neighborDistance;
-            bestNeighbor = neighborAddress.get4();
+            bestNeighbor = neighborAddresses[i].get4();
         }
     }
     if (bestNeighbor.isUnspecified()) {
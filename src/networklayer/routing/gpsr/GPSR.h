@@ -19,6 +19,8 @@
 #ifndef __INET_GPSR_H_
 #define __INET_GPSR_H_
 
+#include <vector>
+
 #include "INETDefs.h"
 #include "Coord.h"
 #include "ILifecycle.h"
@@ -67,6 +69,16 @@ class INET_API GPSR : public cSimpleModule, public ILifecycle, public INotifiabl
         cMessage * purgeNeighborsTimer;
         PositionTable neighborPositionTable;
 
+        // flat copy of neighborPositionTable, refreshed when its version changes
+        unsigned int neighborCacheVersion;
+        std::vector<IPvXAddress> neighborAddresses;
+        std::vector<Coord> neighborPositions;
+        // planar subgraph sorted by angle, recomputed when the neighbors or our own position change
+        bool planarNeighborsValid;
+        Coord planarNeighborsSelfPosition;
+        std::vector<double> neighborAngles;
+        std::vector<int> planarNeighbors; // indices into neighborAddresses
+
     public:
         GPSR();
         virtual ~GPSR();
@@ -125,7 +137,8 @@ class INET_API GPSR : public cSimpleModule, public ILifecycle, public INotifiabl
         // neighbor
         simtime_t getNextNeighborExpiration();
         void purgeNeighbors();
-        std::vector<IPvXAddress> getPlanarNeighbors();
+        void updateNeighborCache();
+        const std::vector<int> & getPlanarNeighbors();
         IPvXAddress getNextPlanarNeighborCounterClockwise(const IPvXAddress & startNeighborAddress, double startNeighborAngle);
 
         // next hop
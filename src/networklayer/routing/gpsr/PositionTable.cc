@@ -27,6 +27,15 @@ std::vector<IPvXAddress> PositionTable::getAddresses() const {
     return addresses;
 }
 
+void PositionTable::getPositions(std::vector<IPvXAddress> & addresses, std::vector<Coord> & positions) const {
+    addresses.reserve(addresses.size() + addressToPositionMap.size());
+    positions.reserve(positions.size() + addressToPositionMap.size());
+    for (AddressToPositionMap::const_iterator it = addressToPositionMap.begin(); it != addressToPositionMap.end(); it++) {
+        addresses.push_back(it->first);
+        positions.push_back(it->second.second);
+    }
+}
+
 bool PositionTable::hasPosition(const IPvXAddress & address) const {
     AddressToPositionMap::const_iterator it = addressToPositionMap.find(address);
     return it != addressToPositionMap.end();
@@ -42,24 +51,38 @@ Coord PositionTable::getPosition(const IPvXAddress & address) const {
 
 void PositionTable::setPosition(const IPvXAddress & address, const Coord & coord) {
     ASSERT(!address.isUnspecified());
-    addressToPositionMap[address] = AddressToPositionMapValue(simTime(), coord);
+    AddressToPositionMap::iterator it = addressToPositionMap.find(address);
+    if (it == addressToPositionMap.end()) {
+        addressToPositionMap[address] = AddressToPositionMapValue(simTime(), coord);
+        version++;
+    }
+    else {
+        const Coord & oldCoord = it->second.second;
+        if (oldCoord.x != coord.x || oldCoord.y != coord.y || oldCoord.z != coord.z)
+            version++;
+        it->second = AddressToPositionMapValue(simTime(), coord);
+    }
 }
 
 void PositionTable::removePosition(const IPvXAddress & address) {
     AddressToPositionMap::iterator it = addressToPositionMap.find(address);
     addressToPositionMap.erase(it);
+    version++;
 }
 
 void PositionTable::removeOldPositions(simtime_t timestamp) {
     for (AddressToPositionMap::iterator it = addressToPositionMap.begin(); it != addressToPositionMap.end();)
-        if (it->second.first <= timestamp)
+        if (it->second.first <= timestamp) {
             addressToPositionMap.erase(it++);
+            version++;
+        }
         else
             it++;
 }
 
 void PositionTable::clear() {
     addressToPositionMap.clear();
+    version++;
 }
 
 simtime_t PositionTable::getOldestPosition() const {
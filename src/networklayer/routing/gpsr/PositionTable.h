@@ -33,12 +33,25 @@ class INET_API PositionTable {
         typedef std::pair<simtime_t, Coord> AddressToPositionMapValue;
         typedef std::map<IPvXAddress, AddressToPositionMapValue> AddressToPositionMap;
         AddressToPositionMap addressToPositionMap;
+        unsigned int version;
 
     public:
-        PositionTable() { }
+        PositionTable() : version(0) { }
+
+        /**
+         * Returns a number that changes whenever an address is added or
+         * removed or a position changes, so users can cache derived data.
+         */
+        unsigned int getVersion() const { return version; }
 
         std::vector<IPvXAddress> getAddresses() const;
 
+        /**
+         * Appends all addresses and positions to the given vectors in
+         * address order, without further lookups.
+         */
+        void getPositions(std::vector<IPvXAddress> & addresses, std::vector<Coord> & positions) const;
+
         bool hasPosition(const IPvXAddress & address) const;
         Coord getPosition(const IPvXAddress & address) const;
         void setPosition(const IPvXAddress & address, const Coord & coord);
@@ -17,6 +17,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <set>
 
 #include "InterfaceMatcher.h"
 #include "InterfaceTableAccess.h"
@@ -135,6 +136,7 @@ RIPRouting::RIPRouting()
     triggeredUpdateTimer = NULL;
     startupTimer = NULL;
     shutdownTimer = NULL;
+    routeCounter = 0;
     isOperational = false;
 }
 
@@ -260,7 +262,7 @@ RIPRoute* RIPRouting::importRoute(IPv4Route *route, RIPRoute::RouteType type, in
         ripRoute->setInterface(ie);
     }
 
-    ripRoutes.push_back(ripRoute);
+    addRIPRoute(ripRoute);
     emit(numRoutesSignal, ripRoutes.size());
     return ripRoute;
 }
@@ -361,7 +363,7 @@ void RIPRouting::receiveChangeNotification(int signalID, const cObject *obj)
                     RIPInterfaceEntry *ripIe = findInterfaceById(ie->getInterfaceId());
                     ripRoute->setRoute(route);
                     ripRoute->setMetric(ripIe ? ripIe->metric : 1);
-                    ripRoute->setChanged(true);
+                    markRouteChanged(ripRoute);
                     triggerUpdate();
                 }
                 else
@@ -386,13 +388,15 @@ void RIPRouting::receiveChangeNotification(int signalID, const cObject *obj)
                                route->getNetmask() != IPv4Address::makeNetmask(ripRoute->getPrefixLength()) ||
                                route->getGateway() != ripRoute->getNextHop().get4() ||
                                route->getInterface() != ripRoute->getInterface();
+                unsigned long position = unindexRoute(ripRoute);
                 ripRoute->setDestination(route->getDestination());
                 ripRoute->setPrefixLength(route->getNetmask().getNetmaskLength());
+                indexRoute(ripRoute, position);
                 ripRoute->setNextHop(route->getGateway());
                 ripRoute->setInterface(route->getInterface());
                 if (changed)
                 {
-                    ripRoute->setChanged(changed);
+                    markRouteChanged(ripRoute);
                     triggerUpdate();
                 }
             }
@@ -500,6 +504,8 @@ void RIPRouting::stopRIPRouting()
 
     // clear data
     ripRoutes.clear();
+    routeIndex.clear();
+    changedRoutes.clear();
     ripInterfaces.clear();
 }
 
@@ -557,6 +563,10 @@ void RIPRouting::handleMessage(cMessage *msg)
 /**
  * This method called when a triggered or regular update timer expired.
  * It either sends the changed/all routes to neighbors.
+ *
+ * The routes are collected once. Interfaces on which split horizon does not
+ * remove or poison any of them (no route points to the interface, or split
+ * horizon is off) get copies of the same prebuilt packets.
  */
 void RIPRouting::processUpdate(bool triggered)
 {
@@ -565,13 +575,48 @@ void RIPRouting::processUpdate(bool triggered)
     else
         RIP_EV << "sending regular updates on all interfaces\n";
 
+    RouteVector routes;
+    collectRoutes(triggered, routes);
+
+    std::set<const InterfaceEntry*> routeInterfaces;
+    for (RouteVector::iterator it = routes.begin(); it != routes.end(); ++it)
+        routeInterfaces.insert((*it)->getInterface());
+
+    std::map<int, PacketVector> sharedPackets; // by maxEntries
     for (InterfaceVector::iterator it = ripInterfaces.begin(); it != ripInterfaces.end(); ++it)
-        if (it->mode != NO_RIP)
-            sendRoutes(IPv4Address::ALL_RIP_ROUTERS_MCAST, ripUdpPort, *it, triggered);
+    {
+        if (it->mode == NO_RIP)
+            continue;
+        RIP_DEBUG << "Sending " << (triggered ? "changed" : "all") << " routes on " << it->ie->getFullName() << std::endl;
+        int maxEntries = getMaxEntries(*it);
+        if (it->mode == NO_SPLIT_HORIZON || routeInterfaces.find(it->ie) == routeInterfaces.end())
+        {
+            std::map<int, PacketVector>::iterator shared = sharedPackets.find(maxEntries);
+            if (shared == sharedPackets.end())
+            {
+                shared = sharedPackets.insert(std::make_pair(maxEntries, PacketVector())).first;
+                buildResponses(routes, NULL, maxEntries, shared->second);
+            }
+            PacketVector packets;
+            for (PacketVector::iterator p = shared->second.begin(); p != shared->second.end(); ++p)
+                packets.push_back((*p)->dup());
+            sendResponses(packets, IPv4Address::ALL_RIP_ROUTERS_MCAST, ripUdpPort, *it);
+        }
+        else
+        {
+            PacketVector packets;
+            buildResponses(routes, &(*it), maxEntries, packets);
+            sendResponses(packets, IPv4Address::ALL_RIP_ROUTERS_MCAST, ripUdpPort, *it);
+        }
+    }
+    for (std::map<int, PacketVector>::iterator it = sharedPackets.begin(); it != sharedPackets.end(); ++it)
+        for (PacketVector::iterator p = it->second.begin(); p != it->second.end(); ++p)
+            delete *p;
 
     // clear changed flags
-    for (RouteVector::iterator it = ripRoutes.begin(); it != ripRoutes.end(); ++it)
+    for (RouteVector::iterator it = changedRoutes.begin(); it != changedRoutes.end(); ++it)
         (*it)->setChanged(false);
+    changedRoutes.clear();
 }
 
 /**
@@ -650,28 +695,50 @@ void RIPRouting::processRequest(RIPPacket *packet)
 
 /**
  * Send all or changed part of the routing table to address/port on the specified interface.
- * This method is called by regular updates (every 30s), triggered updates (when some route changed),
- * and when RIP requests are processed.
+ * This method is called when RIP requests are processed; regular and triggered
+ * updates are sent by processUpdate().
  */
 void RIPRouting::sendRoutes(const IPvXAddress &address, int port, const RIPInterfaceEntry &ripInterface, bool changedOnly)
 {
     RIP_DEBUG << "Sending " << (changedOnly ? "changed" : "all") << " routes on " << ripInterface.ie->getFullName() << std::endl;
 
-    int maxEntries = mode == RIPv2 ? 25 : (ripInterface.ie->getMTU() - 40/*IPv6_HEADER_BYTES*/ - UDP_HEADER_BYTES - RIP_HEADER_SIZE) / RIP_RTE_SIZE;
-
-    RIPPacket *packet = new RIPPacket("RIP response");
-    packet->setCommand(RIP_RESPONSE);
-    packet->setEntryArraySize(maxEntries);
-    int k = 0; // index into RIP entries
+    RouteVector routes;
+    collectRoutes(changedOnly, routes);
+    PacketVector packets;
+    buildResponses(routes, &ripInterface, getMaxEntries(ripInterface), packets);
+    sendResponses(packets, address, port, ripInterface);
+}
 
-    for (RouteVector::iterator it = ripRoutes.begin(); it != ripRoutes.end(); ++it)
+/**
+ * Collects the valid routes to be advertised: the changed ones (from the
+ * change log), or all of them. Expired routes are invalidated or purged
+ * on the way.
+ */
+void RIPRouting::collectRoutes(bool changedOnly, RouteVector &routes)
+{
+    // copy, because expiry handling modifies both vectors
+    RouteVector candidates(changedOnly ? changedRoutes : ripRoutes);
+    for (RouteVector::iterator it = candidates.begin(); it != candidates.end(); ++it)
     {
         RIPRoute *ripRoute = checkRouteIsExpired(*it);
-        if (!ripRoute)
-            continue;
+        if (ripRoute && (!changedOnly || ripRoute->isChanged()))
+            routes.push_back(ripRoute);
+    }
+}
 
-        if (changedOnly && !ripRoute->isChanged())
-            continue;
+/**
+ * Fills RIP response packets with the routes. Split horizon is applied
+ * according to the mode of ripInterface; if it is NULL, all routes are
+ * included with their own metric.
+ */
+void RIPRouting::buildResponses(const RouteVector &routes, const RIPInterfaceEntry *ripInterface, int maxEntries, PacketVector &packets)
+{
+    RIPPacket *packet = NULL;
+    int k = 0; // index into RIP entries
+
+    for (RouteVector::const_iterator it = routes.begin(); it != routes.end(); ++it)
+    {
+        RIPRoute *ripRoute = *it;
 
         // Split Horizon check:
         //   Omit routes learned from one neighbor in updates sent to that neighbor.
@@ -680,17 +747,27 @@ void RIPRouting::sendRoutes(const IPvXAddress &address, int port, const RIPInter
         // Split Horizon with Poisoned Reverse:
         //   Do include such routes in updates, but sets their metrics to infinity.
         int metric = ripRoute->getMetric();
-        if (ripRoute->getInterface() == ripInterface.ie)
+        if (ripInterface && ripRoute->getInterface() == ripInterface->ie)
         {
-            if (ripInterface.mode == SPLIT_HORIZON)
+            if (ripInterface->mode == SPLIT_HORIZON)
                 continue;
-            else if (ripInterface.mode == SPLIT_HORIZON_POISONED_REVERSE)
+            else if (ripInterface->mode == SPLIT_HORIZON_POISONED_REVERSE)
                 metric = RIP_INFINITE_METRIC;
         }
 
         RIP_DEBUG << "Add entry for " << ripRoute->getDestination() << "/" << ripRoute->getPrefixLength() << ": "
                   << " metric=" << metric << std::endl;
 
+        // allocate a new packet if the previous one is full
+        if (!packet)
+        {
+            packet = new RIPPacket("RIP response");
+            packet->setCommand(RIP_RESPONSE);
+            packet->setEntryArraySize(maxEntries);
+            packets.push_back(packet);
+            k = 0;
+        }
+
         // fill next entry
         RIPEntry &entry = packet->getEntry(k++);
         entry.addressFamilyId = RIP_AF_INET;
@@ -700,27 +777,27 @@ void RIPRouting::sendRoutes(const IPvXAddress &address, int port, const RIPInter
         entry.routeTag = ripRoute->getRouteTag();
         entry.metric = metric;
 
-        // if packet is full, then send it and allocate a new one
         if (k >= maxEntries)
-        {
-            emit(sentUpdateSignal, packet);
-            sendPacket(packet, address, port, ripInterface.ie);
-            packet = new RIPPacket("RIP response");
-            packet->setCommand(RIP_RESPONSE);
-            packet->setEntryArraySize(maxEntries);
-            k = 0;
-        }
+            packet = NULL;
     }
 
-    // send last packet if it has entries
-    if (k > 0)
-    {
+    // shrink the last packet to its entries
+    if (packet)
         packet->setEntryArraySize(k);
-        emit(sentUpdateSignal, packet);
-        sendPacket(packet, address, port, ripInterface.ie);
+}
+
+void RIPRouting::sendResponses(const PacketVector &packets, const IPvXAddress &address, int port, const RIPInterfaceEntry &ripInterface)
+{
+    for (PacketVector::const_iterator it = packets.begin(); it != packets.end(); ++it)
+    {
+        emit(sentUpdateSignal, *it);
+        sendPacket(*it, address, port, ripInterface.ie);
     }
-    else
-        delete packet;
+}
+
+int RIPRouting::getMaxEntries(const RIPInterfaceEntry &ripInterface)
+{
+    return mode == RIPv2 ? 25 : (ripInterface.ie->getMTU() - 40/*IPv6_HEADER_BYTES*/ - UDP_HEADER_BYTES - RIP_HEADER_SIZE) / RIP_RTE_SIZE;
 }
 
 /**
@@ -913,8 +990,8 @@ void RIPRouting::addRoute(const IPvXAddress &dest, int prefixLength, const Inter
     RIPRoute *ripRoute = new RIPRoute(route, RIPRoute::RIP_ROUTE_RTE, metric, routeTag);
     ripRoute->setFrom(from);
     ripRoute->setLastUpdateTime(simTime());
-    ripRoute->setChanged(true);
-    ripRoutes.push_back(ripRoute);
+    addRIPRoute(ripRoute);
+    markRouteChanged(ripRoute);
     emit(numRoutesSignal, ripRoutes.size());
     triggerUpdate();
 }
@@ -974,7 +1051,7 @@ void RIPRouting::updateRoute(RIPRoute *ripRoute, const InterfaceEntry *ie, const
         }
     }
 
-    ripRoute->setChanged(true);
+    markRouteChanged(ripRoute);
     triggerUpdate();
 
     if (metric == RIP_INFINITE_METRIC && oldMetric != RIP_INFINITE_METRIC)
@@ -983,6 +1060,19 @@ void RIPRouting::updateRoute(RIPRoute *ripRoute, const InterfaceEntry *ie, const
         ripRoute->setLastUpdateTime(simTime());
 }
 
+/**
+ * Sets the route change flag, and records the route in the change log
+ * unless it is already there.
+ */
+void RIPRouting::markRouteChanged(RIPRoute *ripRoute)
+{
+    if (!ripRoute->isChanged())
+    {
+        ripRoute->setChanged(true);
+        changedRoutes.push_back(ripRoute);
+    }
+}
+
 /**
  * Sets the update timer to trigger an update in the [1s,5s] interval.
  * If the update is already scheduled, it does nothing.
@@ -1043,7 +1133,7 @@ void RIPRouting::invalidateRoute(RIPRoute *ripRoute)
         deleteRoute(route);
     }
     ripRoute->setMetric(RIP_INFINITE_METRIC);
-    ripRoute->setChanged(true);
+    markRouteChanged(ripRoute);
     triggerUpdate();
 }
 
@@ -1061,9 +1151,7 @@ void RIPRouting::purgeRoute(RIPRoute *ripRoute)
         deleteRoute(route);
     }
 
-    RouteVector::iterator end = std::remove(ripRoutes.begin(), ripRoutes.end(), ripRoute);
-    if (end != ripRoutes.end())
-        ripRoutes.erase(end, ripRoutes.end());
+    removeRIPRoute(ripRoute);
     delete ripRoute;
 
     emit(numRoutesSignal, ripRoutes.size());
@@ -1107,17 +1195,17 @@ RIPInterfaceEntry *RIPRouting::findInterfaceById(int interfaceId)
 
 RIPRoute *RIPRouting::findRoute(const IPvXAddress &destination, int prefixLength)
 {
-    for (RouteVector::iterator it = ripRoutes.begin(); it != ripRoutes.end(); ++it)
-        if ((*it)->getDestination() == destination && (*it)->getPrefixLength() == prefixLength)
-            return *it;
-    return NULL;
+    RouteKey key(destination, prefixLength);
+    RouteIndex::iterator it = routeIndex.lower_bound(std::make_pair(key, 0UL));
+    return it != routeIndex.end() && it->first.first == key ? it->second : NULL;
 }
 
 RIPRoute *RIPRouting::findRoute(const IPvXAddress &destination, int prefixLength, RIPRoute::RouteType type)
 {
-    for (RouteVector::iterator it = ripRoutes.begin(); it != ripRoutes.end(); ++it)
-        if ((*it)->getType() == type && (*it)->getDestination() == destination && (*it)->getPrefixLength() == prefixLength)
-            return *it;
+    RouteKey key(destination, prefixLength);
+    for (RouteIndex::iterator it = routeIndex.lower_bound(std::make_pair(key, 0UL)); it != routeIndex.end() && it->first.first == key; ++it)
+        if (it->second->getType() == type)
+            return it->second;
     return NULL;
 }
 
@@ -1137,6 +1225,55 @@ RIPRoute *RIPRouting::findRoute(const InterfaceEntry *ie, RIPRoute::RouteType ty
     return NULL;
 }
 
+void RIPRouting::addRIPRoute(RIPRoute *ripRoute)
+{
+    ripRoutes.push_back(ripRoute);
+    indexRoute(ripRoute, routeCounter++);
+}
+
+void RIPRouting::removeRIPRoute(RIPRoute *ripRoute)
+{
+    unindexRoute(ripRoute);
+    RouteVector::iterator end = std::remove(ripRoutes.begin(), ripRoutes.end(), ripRoute);
+    if (end != ripRoutes.end())
+        ripRoutes.erase(end, ripRoutes.end());
+    if (ripRoute->isChanged())
+    {
+        end = std::remove(changedRoutes.begin(), changedRoutes.end(), ripRoute);
+        changedRoutes.erase(end, changedRoutes.end());
+    }
+}
+
+/**
+ * Adds the route to routeIndex. Routes with the same prefix are ordered by
+ * their position in ripRoutes, so findRoute() returns the same route as a
+ * linear search in ripRoutes would. The position of a route only has to
+ * grow with the order of ripRoutes, it is not an index into it.
+ */
+void RIPRouting::indexRoute(RIPRoute *ripRoute, unsigned long position)
+{
+    RouteKey key(ripRoute->getDestination(), ripRoute->getPrefixLength());
+    routeIndex.insert(std::make_pair(std::make_pair(key, position), ripRoute));
+}
+
+/**
+ * Removes the route from routeIndex, and returns its position for indexRoute().
+ */
+unsigned long RIPRouting::unindexRoute(RIPRoute *ripRoute)
+{
+    RouteKey key(ripRoute->getDestination(), ripRoute->getPrefixLength());
+    for (RouteIndex::iterator it = routeIndex.lower_bound(std::make_pair(key, 0UL)); it != routeIndex.end() && it->first.first == key; ++it)
+    {
+        if (it->second == ripRoute)
+        {
+            unsigned long position = it->first.second;
+            routeIndex.erase(it);
+            return position;
+        }
+    }
+    return routeCounter++;
+}
+
 void RIPRouting::addInterface(const InterfaceEntry *ie, cXMLElement *config)
 {
     RIPInterfaceEntry ripInterface(ie);
@@ -1160,6 +1297,10 @@ void RIPRouting::deleteInterface(const InterfaceEntry *ie)
     {
         if ((*it)->getInterface() == ie)
         {
+            RIPRoute *ripRoute = *it;
+            unindexRoute(ripRoute);
+            if (ripRoute->isChanged())
+                changedRoutes.erase(std::remove(changedRoutes.begin(), changedRoutes.end(), ripRoute), changedRoutes.end());
             it = ripRoutes.erase(it);
             emitNumRoutesSignal = true;
         }
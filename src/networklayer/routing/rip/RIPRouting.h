@@ -18,6 +18,8 @@
 #ifndef __INET_RIPROUTING_H_
 #define __INET_RIPROUTING_H_
 
+#include <map>
+
 #include "INETDefs.h"
 #include "IPv4Route.h"
 #include "IRoutingTable.h"
@@ -27,6 +29,8 @@
 
 #define RIP_INFINITE_METRIC 16
 
+class RIPPacket;
+
 struct RIPRoute : public cObject
 {
     enum RouteType {
@@ -135,6 +139,9 @@ class INET_API RIPRouting : public cSimpleModule, public INotifiable, public ILi
     enum Mode { RIPv2, RIPng };
     typedef std::vector<RIPInterfaceEntry> InterfaceVector;
     typedef std::vector<RIPRoute*> RouteVector;
+    typedef std::pair<IPvXAddress, int> RouteKey;  // destination and prefix length
+    typedef std::map<std::pair<RouteKey, unsigned long>, RIPRoute*> RouteIndex;  // keyed by prefix and position in ripRoutes
+    typedef std::vector<RIPPacket*> PacketVector;
     // environment
     cModule *host;                  // the host module that owns this module
     IInterfaceTable *ift;           // interface table of the host
@@ -142,6 +149,9 @@ class INET_API RIPRouting : public cSimpleModule, public INotifiable, public ILi
     // state
     InterfaceVector ripInterfaces;  // interfaces on which RIP is used
     RouteVector ripRoutes;          // all advertised routes (imported or learned)
+    RouteIndex routeIndex;          // ripRoutes by destination prefix, in the order of ripRoutes
+    unsigned long routeCounter;     // position of the next route appended to ripRoutes, see indexRoute()
+    RouteVector changedRoutes;      // routes with the changed flag set, sent in triggered updates
     UDPSocket socket;               // bound to the RIP port (see udpPort parameter)
     cMessage *updateTimer;          // for sending unsolicited Response messages in every ~30 seconds.
     cMessage *triggeredUpdateTimer; // scheduled when there are pending changes
@@ -171,6 +181,10 @@ class INET_API RIPRouting : public cSimpleModule, public INotifiable, public ILi
     RIPRoute *findRoute(const IPvXAddress &destination, int prefixLength, RIPRoute::RouteType type);
     RIPRoute *findRoute(const IPv4Route *route);
     RIPRoute *findRoute(const InterfaceEntry *ie, RIPRoute::RouteType type);
+    void addRIPRoute(RIPRoute *ripRoute);
+    void removeRIPRoute(RIPRoute *ripRoute);
+    void indexRoute(RIPRoute *ripRoute, unsigned long position);
+    unsigned long unindexRoute(RIPRoute *ripRoute);
     void addInterface(const InterfaceEntry *ie, cXMLElement *config);
     void deleteInterface(const InterfaceEntry *ie);
     void invalidateRoutes(const InterfaceEntry *ie);
@@ -199,12 +213,17 @@ class INET_API RIPRouting : public cSimpleModule, public INotifiable, public ILi
     virtual void processRequest(RIPPacket *packet);
     virtual void processUpdate(bool triggered);
     virtual void sendRoutes(const IPvXAddress &address, int port, const RIPInterfaceEntry &ripInterface, bool changedOnly);
+    virtual void collectRoutes(bool changedOnly, RouteVector &routes);
+    virtual void buildResponses(const RouteVector &routes, const RIPInterfaceEntry *ripInterface, int maxEntries, PacketVector &packets);
+    virtual void sendResponses(const PacketVector &packets, const IPvXAddress &address, int port, const RIPInterfaceEntry &ripInterface);
+    virtual int getMaxEntries(const RIPInterfaceEntry &ripInterface);
 
     virtual void processResponse(RIPPacket *packet);
     virtual bool isValidResponse(RIPPacket *packet);
     virtual void addRoute(const IPvXAddress &dest, int prefixLength, const InterfaceEntry *ie, const IPvXAddress &nextHop, int metric, uint16 routeTag, const IPvXAddress &from);
     virtual void updateRoute(RIPRoute *route, const InterfaceEntry *ie, const IPvXAddress &nextHop, int metric, uint16 routeTag, const IPvXAddress &from);
 
+    virtual void markRouteChanged(RIPRoute *route);
     virtual void triggerUpdate();
     virtual RIPRoute *checkRouteIsExpired(RIPRoute *route);
     virtual void invalidateRoute(RIPRoute *route);
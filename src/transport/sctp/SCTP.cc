@@ -870,9 +870,8 @@ void SCTP::removeAssociation(SCTPAssociation *assoc)
     // Remove entry from transmission queue if it is already in the retransmission queue.
     for (SCTPQueue::PayloadQueue::iterator i = assoc->getRetransmissionQueue()->payloadQueue.begin();
           i != assoc->getRetransmissionQueue()->payloadQueue.end(); i++) {
-        SCTPQueue::PayloadQueue::iterator j = assoc->getTransmissionQueue()->payloadQueue.find(i->second->tsn);
-        if (j != assoc->getTransmissionQueue()->payloadQueue.end()) {
-            assoc->getTransmissionQueue()->payloadQueue.erase(j);
+        if (assoc->getTransmissionQueue()->getChunk(i->second->tsn) != NULL) {
+            assoc->getTransmissionQueue()->removeMsg(i->second->tsn);
         }
     }
      // Now, both queues can be safely deleted.
@@ -3302,6 +3302,7 @@ void SCTPAssociation::moveChunkToOtherPath(SCTPDataVariables* chunk,
     // ====== Prepare next destination =======================================
     chunk->hasBeenFastRetransmitted = false;
     chunk->gapReports = 0;
+    SCTPPathVariables* oldPath = chunk->getNextDestinationPath();
     chunk->setNextDestination(newPath);
 
     // ====== Rebook chunk on new path =======================================
@@ -3318,6 +3319,15 @@ void SCTPAssociation::moveChunkToOtherPath(SCTPDataVariables* chunk,
     // This can happen in case multiple timeouts occur in succession.
     if (!transmissionQ->checkAndInsertChunk(chunk->tsn, chunk)) {
         sctpEV3 << "TSN " << chunk->tsn << " already in transmissionQ" << endl;
+        // move its index entry and transmissionQ booking to the new path
+        if (oldPath != NULL && oldPath != newPath) {
+            transmissionQ->updatePathIndex(chunk, oldPath->remoteAddress);
+            const uint32 chunkLength = ADD_PADDING(chunk->len/8+SCTP_DATA_CHUNK_LENGTH);
+            qCounter.roomTransQ.find(oldPath->remoteAddress)->second -= chunkLength;
+            qCounter.roomTransQ.find(newPath->remoteAddress)->second += chunkLength;
+            qCounter.bookedTransQ.find(oldPath->remoteAddress)->second -= chunk->booksize;
+            qCounter.bookedTransQ.find(newPath->remoteAddress)->second += chunk->booksize;
+        }
         return;
     }
     else {
@@ -96,7 +96,9 @@ void SCTPAssociation::loadPacket(SCTPPathVariables* pathVar,
         SCTPDataVariables* chunk = retransmissionQ->payloadQueue.find(((SCTPDataChunk*)(*sctpMsg)->getChunks(i))->getTsn())->second;
         chunk->queuedOnPath = pathVar;
         chunk->queuedOnPath->queuedBytes += chunk->booksize;
+        const IPvXAddress oldDestination = chunk->getLastDestination();
         chunk->setLastDestination(pathVar);
+        retransmissionQ->updatePathIndex(chunk, oldDestination);
         increaseOutstandingBytes(chunk, pathVar);
         chunk->countsAsOutstanding = true;
     }
@@ -1204,7 +1206,9 @@ void SCTPAssociation::sendOnPath(SCTPPathVariables* pathId, bool firstPass)
                     SCTP::AssocStatMap::iterator iterator = sctpMain->assocStatMap.find(assocId);
                     iterator->second.transmittedBytes += datVar->len / 8;
 
+                    const IPvXAddress oldDestination = datVar->getLastDestination();
                     datVar->setLastDestination(path);
+                    retransmissionQ->updatePathIndex(datVar, oldDestination);
                     datVar->countsAsOutstanding = true;
                     datVar->hasBeenReneged = false;
                     datVar->sendTime = simTime(); //I.R. to send Fast RTX just once a RTT
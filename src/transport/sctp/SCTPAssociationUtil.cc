@@ -243,7 +243,9 @@ SCTPAssociation* SCTPAssociation::cloneAssociation()
     SCTPAssociation* assoc = new SCTPAssociation(sctpMain, appGateIndex, assocId);
     const char* queueClass = transmissionQ->getClassName();
     assoc->transmissionQ = check_and_cast<SCTPQueue *>(createOne(queueClass));
+    assoc->transmissionQ->setPathIndex(SCTPQueue::NEXT_DESTINATION);
     assoc->retransmissionQ = check_and_cast<SCTPQueue *>(createOne(queueClass));
+    assoc->retransmissionQ->setPathIndex(SCTPQueue::LAST_DESTINATION);
 
     const char* sctpAlgorithmClass = sctpAlgorithm->getClassName();
     assoc->sctpAlgorithm = check_and_cast<SCTPAlgorithm *>(createOne(sctpAlgorithmClass));
@@ -413,8 +415,10 @@ void SCTPAssociation::initAssociation(SCTPOpenCommand *openCmd)
     // create send/receive queues
     const char *queueClass = openCmd->getQueueClass();
     transmissionQ = check_and_cast<SCTPQueue *>(createOne(queueClass));
+    transmissionQ->setPathIndex(SCTPQueue::NEXT_DESTINATION);
 
     retransmissionQ = check_and_cast<SCTPQueue *>(createOne(queueClass));
+    retransmissionQ->setPathIndex(SCTPQueue::LAST_DESTINATION);
     inboundStreams = openCmd->getInboundStreams();
     outboundStreams = openCmd->getOutboundStreams();
     // create algorithm
@@ -1266,7 +1270,8 @@ SCTPForwardTsnChunk* SCTPAssociation::createForwardTsnChunk(const IPvXAddress& p
     forwChunk->setChunkType(FORWARD_TSN);
     advancePeerTsn();
     forwChunk->setNewCumTsn(state->advancedPeerAckPoint);
-    for (SCTPQueue::PayloadQueue::iterator it=retransmissionQ->payloadQueue.begin(); it!=retransmissionQ->payloadQueue.end(); it++)
+    const SCTPQueue::PayloadQueue& pathQueue = retransmissionQ->getPathQueue(pid);
+    for (SCTPQueue::PayloadQueue::const_iterator it = pathQueue.begin(); it != pathQueue.end(); it++)
     {
         chunk = it->second;
         sctpEV3 << "tsn=" << chunk->tsn << " lastDestination=" << chunk->getLastDestination() << " abandoned=" << chunk->hasBeenAbandoned << "\n";
@@ -1288,9 +1293,8 @@ SCTPForwardTsnChunk* SCTPAssociation::createForwardTsnChunk(const IPvXAddress& p
                 chunk->numberOfRetransmissions++;
                 chunk->sendForwardIfAbandoned = false;
 
-                SCTPQueue::PayloadQueue::iterator itt = transmissionQ->payloadQueue.find(chunk->tsn);
-                if (itt != transmissionQ->payloadQueue.end()) {
-                    transmissionQ->payloadQueue.erase(itt);
+                if (transmissionQ->getChunk(chunk->tsn) != NULL) {
+                    transmissionQ->removeMsg(chunk->tsn);
                     chunk->enqueuedInTransmissionQ = false;
                     CounterMap::iterator i = qCounter.roomTransQ.find(pid);
                     i->second -= ADD_PADDING(chunk->len/8+SCTP_DATA_CHUNK_LENGTH);
@@ -2176,9 +2180,11 @@ SCTPDataVariables* SCTPAssociation::getOutboundDataChunk(const SCTPPathVariables
               << " availableSpace=" << availableSpace
               << " availableCwnd="  << availableCwnd
               << endl;
-    if (!transmissionQ->payloadQueue.empty()) {
-        for (SCTPQueue::PayloadQueue::iterator it = transmissionQ->payloadQueue.begin();
-             it != transmissionQ->payloadQueue.end(); it++) {
+    // only the chunks scheduled for this path have to be looked at
+    const SCTPQueue::PayloadQueue& pathQueue = transmissionQ->getPathQueue(path->remoteAddress);
+    if (!pathQueue.empty()) {
+        for (SCTPQueue::PayloadQueue::const_iterator it = pathQueue.begin();
+             it != pathQueue.end(); it++) {
             SCTPDataVariables* chunk = it->second;
             if ( (chunkHasBeenAcked(chunk) == false) && !chunk->hasBeenAbandoned &&
                  (chunk->getNextDestinationPath() == path) ) {
@@ -2191,7 +2197,7 @@ SCTPDataVariables* SCTPAssociation::getOutboundDataChunk(const SCTPPathVariables
                     //                        this chunk is actually dequeued. Therefore, the check
                     //                        for "chunkHasBeenAcked==false" has been moved into the
                     //                        "if" statement above!
-                    transmissionQ->payloadQueue.erase(it);
+                    transmissionQ->removeMsg(chunk->tsn);
                     chunk->enqueuedInTransmissionQ = false;
                     CounterMap::iterator i = qCounter.roomTransQ.find(path->remoteAddress);
                     i->second -= ADD_PADDING(chunk->len/8+SCTP_DATA_CHUNK_LENGTH);
@@ -2248,10 +2254,11 @@ SCTPDataVariables* SCTPAssociation::peekAbandonedChunk(const SCTPPathVariables*
 {
     SCTPDataVariables* retChunk = NULL;
 
-    if (state->prMethod != 0 && !retransmissionQ->payloadQueue.empty())
+    const SCTPQueue::PayloadQueue& pathQueue = retransmissionQ->getPathQueue(path->remoteAddress);
+    if (state->prMethod != 0 && !pathQueue.empty())
     {
-        for (SCTPQueue::PayloadQueue::iterator it = retransmissionQ->payloadQueue.begin();
-             it != retransmissionQ->payloadQueue.end(); it++) {
+        for (SCTPQueue::PayloadQueue::const_iterator it = pathQueue.begin();
+             it != pathQueue.end(); it++) {
             SCTPDataVariables* chunk = it->second;
 
             if (chunk->getLastDestinationPath() == path) {
@@ -2684,11 +2691,8 @@ void SCTPAssociation::pmStartPathManagement()
 
 int32 SCTPAssociation::getOutstandingBytes() const
 {
-    int32 osb = 0;
-    for (SCTPPathMap::const_iterator pm = sctpPathMap.begin(); pm != sctpPathMap.end(); pm++) {
-        osb += pm->second->outstandingBytes;
-    }
-    return osb;
+    // maintained by increaseOutstandingBytes()/decreaseOutstandingBytes()
+    return (int32)state->outstandingBytes;
 }
 
 void SCTPAssociation::pmClearPathCounter(SCTPPathVariables* path)
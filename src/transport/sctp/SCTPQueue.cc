@@ -17,6 +17,8 @@
 //
 
 
+#include <assert.h>
+
 #include "SCTPQueue.h"
 #include "SCTPAssociation.h"
 
@@ -26,6 +28,7 @@ Register_Class(SCTPQueue);
 SCTPQueue::SCTPQueue()
 {
     assoc = NULL;
+    pathIndex = NO_PATH_INDEX;
 }
 
 SCTPQueue::~SCTPQueue()
@@ -47,6 +50,9 @@ bool SCTPQueue::checkAndInsertChunk(const uint32 key, SCTPDataVariables* chunk)
         return false;
     }
     payloadQueue[key] = chunk;
+    if (pathIndex != NO_PATH_INDEX) {
+        pathQueues[getIndexAddress(chunk)][key] = chunk;
+    }
     return true;
 }
 
@@ -60,6 +66,7 @@ SCTPDataVariables* SCTPQueue::extractMessage()
     if (!payloadQueue.empty()) {
         PayloadQueue::iterator iterator = payloadQueue.begin();
         SCTPDataVariables*    chunk = iterator->second;
+        removeFromPathIndex(iterator->first, chunk);
         payloadQueue.erase(iterator);
         return chunk;
     }
@@ -71,6 +78,7 @@ SCTPDataVariables* SCTPQueue::getAndExtractChunk(const uint32 tsn)
     if (!payloadQueue.empty()) {
         PayloadQueue::iterator iterator = payloadQueue.find(tsn);
         SCTPDataVariables*    chunk = iterator->second;
+        removeFromPathIndex(iterator->first, chunk);
         payloadQueue.erase(iterator);
         return chunk;
     }
@@ -151,6 +159,7 @@ SCTPDataVariables* SCTPQueue::getChunkFast(const uint32 tsn, bool& firstTime)
 void SCTPQueue::removeMsg(const uint32 tsn)
 {
     PayloadQueue::iterator iterator = payloadQueue.find(tsn);
+    removeFromPathIndex(tsn, iterator->second);
     payloadQueue.erase(iterator);
 }
 
@@ -162,6 +171,7 @@ bool SCTPQueue::deleteMsg(const uint32 tsn)
         SCTPDataVariables* chunk = iterator->second;
         cMessage* msg = check_and_cast<cMessage*>(chunk->userData);
         delete msg;
+        removeFromPathIndex(tsn, chunk);
         payloadQueue.erase(iterator);
         return true;
     }
@@ -186,6 +196,7 @@ SCTPDataVariables* SCTPQueue::dequeueChunkBySSN(const uint16 ssn)
         if ((iterator->second->ssn == ssn) &&
              (iterator->second->bbit) &&
              (iterator->second->ebit) ) {
+            removeFromPathIndex(iterator->first, chunk);
             payloadQueue.erase(iterator);
             return chunk;
         }
@@ -205,8 +216,9 @@ void SCTPQueue::findEarliestOutstandingTSNsForPath(const IPvXAddress& remoteAddr
     bool findEarliestOutstandingTSN = true;
     bool findRTXEarliestOutstandingTSN = true;
 
-    for (PayloadQueue::const_iterator iterator = payloadQueue.begin();
-            iterator != payloadQueue.end(); ++iterator) {
+    const PayloadQueue& queue = (pathIndex == LAST_DESTINATION) ? getPathQueue(remoteAddress) : payloadQueue;
+    for (PayloadQueue::const_iterator iterator = queue.begin();
+            iterator != queue.end(); ++iterator) {
         const SCTPDataVariables* chunk = iterator->second;
         if (chunk->getLastDestination() == remoteAddress) {
             // ====== Find earliest outstanding TSNs ===========================
@@ -229,6 +241,10 @@ void SCTPQueue::findEarliestOutstandingTSNsForPath(const IPvXAddress& remoteAddr
 
 uint32 SCTPQueue::getSizeOfFirstChunk(const IPvXAddress& remoteAddress)
 {
+    if (pathIndex == NEXT_DESTINATION) {
+        const PayloadQueue& queue = getPathQueue(remoteAddress);
+        return queue.empty() ? 0 : queue.begin()->second->booksize;
+    }
     for (PayloadQueue::const_iterator iterator = payloadQueue.begin();
             iterator != payloadQueue.end(); ++iterator) {
         const SCTPDataVariables* chunk = iterator->second;
@@ -238,3 +254,58 @@ uint32 SCTPQueue::getSizeOfFirstChunk(const IPvXAddress& remoteAddress)
     }
     return (0);
 }
+
+void SCTPQueue::setPathIndex(PathIndex index)
+{
+    assert(payloadQueue.empty());
+    pathIndex = index;
+    pathQueues.clear();
+}
+
+const SCTPQueue::PayloadQueue& SCTPQueue::getPathQueue(const IPvXAddress& remoteAddress) const
+{
+    assert(pathIndex != NO_PATH_INDEX);
+    PathQueueMap::const_iterator found = pathQueues.find(remoteAddress);
+    if (found != pathQueues.end()) {
+        return found->second;
+    }
+    return emptyPathQueue;
+}
+
+void SCTPQueue::updatePathIndex(SCTPDataVariables* chunk, const IPvXAddress& oldAddress)
+{
+    if (pathIndex == NO_PATH_INDEX || payloadQueue.find(chunk->tsn) == payloadQueue.end()) {
+        return;
+    }
+    const IPvXAddress& newAddress = getIndexAddress(chunk);
+    if (newAddress != oldAddress) {
+        PathQueueMap::iterator found = pathQueues.find(oldAddress);
+        if (found != pathQueues.end()) {
+            found->second.erase(chunk->tsn);
+        }
+        pathQueues[newAddress][chunk->tsn] = chunk;
+    }
+}
+
+const IPvXAddress& SCTPQueue::getIndexAddress(const SCTPDataVariables* chunk) const
+{
+    return (pathIndex == NEXT_DESTINATION) ? chunk->getNextDestination() : chunk->getLastDestination();
+}
+
+void SCTPQueue::removeFromPathIndex(const uint32 key, const SCTPDataVariables* chunk)
+{
+    if (pathIndex == NO_PATH_INDEX) {
+        return;
+    }
+    PathQueueMap::iterator found = pathQueues.find(getIndexAddress(chunk));
+    if (found != pathQueues.end() && found->second.erase(key) > 0) {
+        return;
+    }
+    // destination changed without updatePathIndex(): search all paths
+    for (PathQueueMap::iterator iterator = pathQueues.begin();
+          iterator != pathQueues.end(); ++iterator) {
+        if (iterator->second.erase(key) > 0) {
+            return;
+        }
+    }
+}
@@ -49,6 +49,15 @@ class SCTPAssociation;
 class INET_API SCTPQueue : public cObject
 {
     public:
+    /**
+      * Destination a chunk is filed under in the per-path index.
+      */
+     enum PathIndex {
+         NO_PATH_INDEX,      // no per-path index (default)
+         NEXT_DESTINATION,   // index by getNextDestination(), used by the transmissionQ
+         LAST_DESTINATION    // index by getLastDestination(), used by the retransmissionQ
+     };
+
     /**
       * Constructor.
       */
@@ -97,8 +106,34 @@ class INET_API SCTPQueue : public cObject
      typedef std::map<uint32, SCTPDataVariables*> PayloadQueue;
      PayloadQueue payloadQueue;
 
+     /**
+      * Enables the per-path index; the queue must be empty.
+      */
+     void setPathIndex(PathIndex index);
+
+     /**
+      * Returns the chunks filed under the given destination, in TSN order.
+      * Requires the per-path index.
+      */
+     const PayloadQueue& getPathQueue(const IPvXAddress& remoteAddress) const;
+
+     /**
+      * Must be called when the indexed destination of a queued chunk
+      * changes; oldAddress is the destination it was filed under.
+      */
+     void updatePathIndex(SCTPDataVariables* chunk, const IPvXAddress& oldAddress);
+
+  protected:
+     typedef std::map<IPvXAddress, PayloadQueue> PathQueueMap;
+
+     const IPvXAddress& getIndexAddress(const SCTPDataVariables* chunk) const;
+     void removeFromPathIndex(const uint32 key, const SCTPDataVariables* chunk);
+
   protected:
      SCTPAssociation* assoc;    // SCTP connection object
+     PathIndex pathIndex;
+     PathQueueMap pathQueues;   // payloadQueue split by destination, see PathIndex
+     PayloadQueue emptyPathQueue;
 
   private:
      PayloadQueue::iterator GetChunkFastIterator;
@@ -34,11 +34,16 @@ class TCPSegment;
 class TCPSendQueue;
 class TCPReceiveQueue;
 
+// compile-time log level of TCP, see Compat.h
+#ifndef TCP_LOG_LEVEL
+#define TCP_LOG_LEVEL INET_LOG_LEVEL
+#endif
+
 // macro for normal EV<< logging (Note: deliberately no parens in macro def)
-#define tcpEV (ev.isDisabled()||TCP::testing)?EV:EV
+#define tcpEV (!INET_LOG_ENABLED_AT(DETAIL, TCP_LOG_LEVEL)||TCP::testing)?EV:EV
 
 // macro for more verbose EV<< logging (Note: deliberately no parens in macro def)
-#define tcpEV2 (ev.isDisabled()||TCP::testing||!TCP::logverbose)?EV:EV
+#define tcpEV2 (!INET_LOG_ENABLED_AT(DEBUG, TCP_LOG_LEVEL)||TCP::testing||!TCP::logverbose)?EV:EV
 
 // testingEV writes log that automated test cases can check (*.test files)
 #define testingEV (ev.isDisabled()||!TCP::testing)?EV:EV
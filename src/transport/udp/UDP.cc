@@ -100,6 +100,7 @@ UDP::SockDesc::SockDesc(int sockId_, int appGateIndex_) {
     multicastLoop = DEFAULT_MULTICAST_LOOP;
     ttl = -1;
     typeOfService = 0;
+    isConnectedIndexed = false;
 }
 
 //--------
@@ -357,7 +358,8 @@ void UDP::processUDPPacket(UDPPacket *udpPacket)
     else
     {
         // multicast packet: find all matching sockets, and send up a copy to each
-        std::vector<SockDesc*> sds = findSocketsForMcastBcastPacket(destAddr, destPort, srcAddr, srcPort, isMulticast, isBroadcast);
+        SockDescVector& sds = deliveryList;
+        findSocketsForMcastBcastPacket(destAddr, destPort, srcAddr, srcPort, isMulticast, isBroadcast, sds);
         if (sds.empty())
         {
             EV << "No socket registered on port " << destPort << "\n";
@@ -503,14 +505,22 @@ void UDP::bind(int sockId, int gateIndex, const IPvXAddress& localAddr, int loca
         if (sd->isBound)
             error("bind: socket is already bound (sockId=%d)", sockId);
 
+        removeFromConnectedIndex(sd);
         sd->isBound = true;
         sd->localAddr = localAddr;
         if (localPort != -1 && sd->localPort != localPort)
         {
-            socketsByPortMap[sd->localPort].remove(sd);
+            int oldPort = sd->localPort;
+            SockDescList& oldList = socketsByPortMap[oldPort];
+            oldList.remove(sd);
+            if (oldList.empty())
+                socketsByPortMap.erase(oldPort);
+            rebuildPortIndex(oldPort);
             sd->localPort = localPort;
             socketsByPortMap[sd->localPort].push_back(sd);
         }
+        addToConnectedIndex(sd);
+        rebuildPortIndex(sd->localPort);
     }
     else
     {
@@ -527,9 +537,14 @@ void UDP::connect(int sockId, int gateIndex, const IPvXAddress& remoteAddr, int
         error("connect: invalid remote port number %d", remotePort);
 
     SockDesc *sd = getOrCreateSocket(sockId, gateIndex);
+    bool wasConnected = sd->isConnectedIndexed;
+    removeFromConnectedIndex(sd);
     sd->remoteAddr = remoteAddr;
     sd->remotePort = remotePort;
     sd->onlyLocalPortIsSet = false;
+    addToConnectedIndex(sd);
+    if (sd->isConnectedIndexed != wasConnected)
+        rebuildPortIndex(sd->localPort);
 
     EV << "Socket connected: " << *sd << "\n";
 }
@@ -550,6 +565,9 @@ UDP::SockDesc *UDP::createSocket(int sockId, int gateIndex, const IPvXAddress& l
     SockDescList& list = socketsByPortMap[sd->localPort]; // create if doesn't exist
     list.push_back(sd);
 
+    // a new socket is neither connected nor member of a group, so it goes to the end of the unconnected list
+    unconnectedSocketsByPort[sd->localPort].push_back(sd);
+
     EV << "Socket created: " << *sd << "\n";
     return sd;
 }
@@ -572,6 +590,12 @@ void UDP::close(int sockId)
             {list.erase(it); break;}
     if (list.empty())
         socketsByPortMap.erase(sd->localPort);
+
+    // remove from the lookup indices
+    bool wasConnected = sd->isConnectedIndexed;
+    removeFromConnectedIndex(sd);
+    if (!wasConnected || sd->isBroadcast || !sd->multicastAddrs.empty())
+        rebuildPortIndex(sd->localPort);
     delete sd;
 }
 
@@ -584,6 +608,10 @@ void UDP::clearAllSockets()
         it->second.clear();
     }
     socketsByPortMap.clear();
+    connectedSocketsMap.clear();
+    unconnectedSocketsByPort.clear();
+    broadcastSocketsByPort.clear();
+    multicastMembersByPort.clear();
     for (SocketsByIdMap::iterator it = socketsByIdMap.begin(); it != socketsByIdMap.end(); ++it)
         delete it->second;
     socketsByIdMap.clear();
@@ -627,14 +655,24 @@ UDP::SockDesc *UDP::findFirstSocketByLocalAddress(const IPvXAddress& localAddr,
 
 UDP::SockDesc *UDP::findSocketForUnicastPacket(const IPvXAddress& localAddr, ushort localPort, const IPvXAddress& remoteAddr, ushort remotePort)
 {
-    SocketsByPortMap::iterator it = socketsByPortMap.find(localPort);
-    if (it == socketsByPortMap.end())
+    // a connected socket takes precedence; if several match, use the most recently connected one
+    SockPair key(localAddr, localPort, remoteAddr, remotePort);
+    SocketsBySockPairMap::iterator ct = connectedSocketsMap.upper_bound(key);
+    if (ct != connectedSocketsMap.begin())
+    {
+        --ct;
+        if (!(ct->first < key))
+            return ct->second;
+    }
+
+    SockDescVectorsByPortMap::iterator it = unconnectedSocketsByPort.find(localPort);
+    if (it == unconnectedSocketsByPort.end())
         return NULL;
 
     // select the socket bound to ANY_ADDR only if there is no socket bound to localAddr
-    SockDescList& list = it->second;
+    SockDescVector& list = it->second;
     SockDesc *socketBoundToAnyAddress = NULL;
-    for (SockDescList::reverse_iterator it = list.rbegin(); it != list.rend(); ++it)
+    for (SockDescVector::reverse_iterator it = list.rbegin(); it != list.rend(); ++it)
     {
         SockDesc *sd = *it;
         if (sd->onlyLocalPortIsSet || (
@@ -651,38 +689,95 @@ UDP::SockDesc *UDP::findSocketForUnicastPacket(const IPvXAddress& localAddr, ush
     return socketBoundToAnyAddress;
 }
 
-std::vector<UDP::SockDesc*> UDP::findSocketsForMcastBcastPacket(const IPvXAddress& localAddr, ushort localPort, const IPvXAddress& remoteAddr, ushort remotePort, bool isMulticast, bool isBroadcast)
+void UDP::findSocketsForMcastBcastPacket(const IPvXAddress& localAddr, ushort localPort, const IPvXAddress& remoteAddr, ushort remotePort, bool isMulticast, bool isBroadcast, SockDescVector& result)
 {
     ASSERT(isMulticast || isBroadcast);
-    std::vector<SockDesc*> result;
-    SocketsByPortMap::iterator it = socketsByPortMap.find(localPort);
-    if (it == socketsByPortMap.end())
-        return result;
+    result.clear();
 
-    SockDescList& list = it->second;
-    for (SockDescList::iterator it = list.begin(); it != list.end(); ++it)
+    const SockDescVector *candidates = NULL;
+    if (isBroadcast)
     {
-        SockDesc *sd = *it;
-        if (isBroadcast)
+        SockDescVectorsByPortMap::iterator it = broadcastSocketsByPort.find(localPort);
+        if (it != broadcastSocketsByPort.end())
+            candidates = &it->second;
+    }
+    else
+    {
+        MulticastMembersByPortMap::iterator it = multicastMembersByPort.find(localPort);
+        if (it != multicastMembersByPort.end())
         {
-            if (sd->isBroadcast)
-            {
-                if ((sd->remotePort == -1 || sd->remotePort == remotePort) &&
-                    (sd->remoteAddr.isUnspecified() || sd->remoteAddr == remoteAddr))
-                    result.push_back(sd);
-            }
+            SockDescVectorsByGroupMap::iterator jt = it->second.find(localAddr);
+            if (jt != it->second.end())
+                candidates = &jt->second;
         }
-        else if (isMulticast)
+    }
+    if (!candidates)
+        return;
+
+    for (SockDescVector::const_iterator it = candidates->begin(); it != candidates->end(); ++it)
+    {
+        SockDesc *sd = *it;
+        if ((sd->remotePort == -1 || sd->remotePort == remotePort) &&
+            (sd->remoteAddr.isUnspecified() || sd->remoteAddr == remoteAddr))
+            result.push_back(sd);
+    }
+}
+
+bool UDP::isConnectedSocket(SockDesc *sd)
+{
+    // such a socket can only match packets with exactly this address/port 4-tuple
+    return !sd->onlyLocalPortIsSet && !sd->localAddr.isUnspecified() &&
+            !sd->remoteAddr.isUnspecified() && sd->remotePort != -1;
+}
+
+void UDP::addToConnectedIndex(SockDesc *sd)
+{
+    ASSERT(!sd->isConnectedIndexed);
+    if (isConnectedSocket(sd))
+    {
+        connectedSocketsMap.insert(std::make_pair(SockPair(sd->localAddr, sd->localPort, sd->remoteAddr, sd->remotePort), sd));
+        sd->isConnectedIndexed = true;
+    }
+}
+
+void UDP::removeFromConnectedIndex(SockDesc *sd)
+{
+    if (!sd->isConnectedIndexed)
+        return;
+    std::pair<SocketsBySockPairMap::iterator, SocketsBySockPairMap::iterator> range =
+            connectedSocketsMap.equal_range(SockPair(sd->localAddr, sd->localPort, sd->remoteAddr, sd->remotePort));
+    for (SocketsBySockPairMap::iterator it = range.first; it != range.second; ++it)
+    {
+        if (it->second == sd)
         {
-            if (sd->multicastAddrs.find(localAddr) != sd->multicastAddrs.end())
-            {
-                if ((sd->remotePort == -1 || sd->remotePort == remotePort) &&
-                    (sd->remoteAddr.isUnspecified() || sd->remoteAddr == remoteAddr))
-                    result.push_back(sd);
-            }
+            connectedSocketsMap.erase(it);
+            break;
         }
     }
-    return result;
+    sd->isConnectedIndexed = false;
+}
+
+void UDP::rebuildPortIndex(int port)
+{
+    unconnectedSocketsByPort.erase(port);
+    broadcastSocketsByPort.erase(port);
+    multicastMembersByPort.erase(port);
+
+    SocketsByPortMap::iterator it = socketsByPortMap.find(port);
+    if (it == socketsByPortMap.end())
+        return;
+
+    SockDescList& list = it->second;
+    for (SockDescList::iterator jt = list.begin(); jt != list.end(); ++jt)
+    {
+        SockDesc *sd = *jt;
+        if (!sd->isConnectedIndexed)
+            unconnectedSocketsByPort[port].push_back(sd);
+        if (sd->isBroadcast)
+            broadcastSocketsByPort[port].push_back(sd);
+        for (std::map<IPvXAddress,int>::iterator kt = sd->multicastAddrs.begin(); kt != sd->multicastAddrs.end(); ++kt)
+            multicastMembersByPort[port][kt->first].push_back(sd);
+    }
 }
 
 void UDP::sendUp(cPacket *payload, SockDesc *sd, const IPvXAddress& srcAddr, ushort srcPort, const IPvXAddress& destAddr, ushort destPort, int interfaceId, int ttl, unsigned char tos)
@@ -812,7 +907,11 @@ void UDP::setTypeOfService(SockDesc *sd, int typeOfService)
 
 void UDP::setBroadcast(SockDesc *sd, bool broadcast)
 {
-    sd->isBroadcast = broadcast;
+    if (sd->isBroadcast != broadcast)
+    {
+        sd->isBroadcast = broadcast;
+        rebuildPortIndex(sd->localPort);
+    }
 }
 
 void UDP::setMulticastOutputInterface(SockDesc *sd, int interfaceId)
@@ -840,6 +939,7 @@ void UDP::joinMulticastGroups(SockDesc *sd, const std::vector<IPvXAddress>& mult
         int interfaceId = k < interfaceIdsLen ? interfaceIds[k] : -1;
         ASSERT(multicastAddr.isMulticast());
         sd->multicastAddrs[multicastAddr] = interfaceId;
+        rebuildPortIndex(sd->localPort);
 
         // add the multicast address to the selected interface or all interfaces
         IInterfaceTable *ift = InterfaceTableAccess().get(this);
@@ -879,6 +979,7 @@ void UDP::leaveMulticastGroups(SockDesc *sd, const std::vector<IPvXAddress>& mul
 {
     for (unsigned int i = 0; i < multicastAddresses.size(); i++)
         sd->multicastAddrs.erase(multicastAddresses[i]);
+    rebuildPortIndex(sd->localPort);
     // note: we cannot remove the address from the interface, because someone else may still use it
 }
 
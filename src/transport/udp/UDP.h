@@ -22,6 +22,7 @@
 
 #include <map>
 #include <list>
+#include <vector>
 
 #include "ILifecycle.h"
 #include "UDPControlInfo.h"
@@ -63,17 +64,47 @@ class INET_API UDP : public cSimpleModule, public ILifecycle
         int ttl;
         unsigned char typeOfService;
         std::map<IPvXAddress,int> multicastAddrs; // key: multicast address; value: output interface Id or -1
+        bool isConnectedIndexed;  // true if the socket is in connectedSocketsMap
+    };
+
+    // local and remote address/port of a connected socket
+    struct SockPair
+    {
+        IPvXAddress localAddr;
+        IPvXAddress remoteAddr;
+        int localPort;
+        int remotePort;
+        SockPair(const IPvXAddress& localAddr, int localPort, const IPvXAddress& remoteAddr, int remotePort) :
+            localAddr(localAddr), remoteAddr(remoteAddr), localPort(localPort), remotePort(remotePort) {}
+        bool operator<(const SockPair& other) const {
+            if (localPort != other.localPort) return localPort < other.localPort;
+            if (remotePort != other.remotePort) return remotePort < other.remotePort;
+            if (localAddr != other.localAddr) return localAddr < other.localAddr;
+            return remoteAddr < other.remoteAddr;
+        }
     };
 
     typedef std::list<SockDesc *> SockDescList;   // might contain duplicated local addresses if their reuseAddr flag is set
+    typedef std::vector<SockDesc *> SockDescVector;
     typedef std::map<int,SockDesc *> SocketsByIdMap;
     typedef std::map<int,SockDescList> SocketsByPortMap;
+    typedef std::multimap<SockPair,SockDesc *> SocketsBySockPairMap;
+    typedef std::map<int,SockDescVector> SockDescVectorsByPortMap;
+    typedef std::map<IPvXAddress,SockDescVector> SockDescVectorsByGroupMap;
+    typedef std::map<int,SockDescVectorsByGroupMap> MulticastMembersByPortMap;
 
   protected:
     // sockets
     SocketsByIdMap socketsByIdMap;
     SocketsByPortMap socketsByPortMap;
 
+    // lookup indices derived from socketsByPortMap; the per-port vectors keep its order
+    SocketsBySockPairMap connectedSocketsMap;         // sockets that can only match a single address/port 4-tuple
+    SockDescVectorsByPortMap unconnectedSocketsByPort; // all other sockets
+    SockDescVectorsByPortMap broadcastSocketsByPort;   // sockets with the broadcast flag
+    MulticastMembersByPortMap multicastMembersByPort;  // sockets that joined a multicast group
+    SockDescVector deliveryList;                       // reused by processUDPPacket() for multicast/broadcast delivery
+
     // other state vars
     ushort lastEphemeralPort;
     ICMP *icmp;
@@ -115,11 +146,17 @@ class INET_API UDP : public cSimpleModule, public ILifecycle
     virtual void leaveMulticastGroups(SockDesc *sd, const std::vector<IPvXAddress>& multicastAddresses);
     virtual void addMulticastAddressToInterface(InterfaceEntry *ie, const IPvXAddress& multicastAddr);
 
+    // lookup indices
+    virtual bool isConnectedSocket(SockDesc *sd);
+    virtual void addToConnectedIndex(SockDesc *sd);
+    virtual void removeFromConnectedIndex(SockDesc *sd);
+    virtual void rebuildPortIndex(int port);
+
     // ephemeral port
     virtual ushort getEphemeralPort();
 
     virtual SockDesc *findSocketForUnicastPacket(const IPvXAddress& localAddr, ushort localPort, const IPvXAddress& remoteAddr, ushort remotePort);
-    virtual std::vector<SockDesc*> findSocketsForMcastBcastPacket(const IPvXAddress& localAddr, ushort localPort, const IPvXAddress& remoteAddr, ushort remotePort, bool isMulticast, bool isBroadcast);
+    virtual void findSocketsForMcastBcastPacket(const IPvXAddress& localAddr, ushort localPort, const IPvXAddress& remoteAddr, ushort remotePort, bool isMulticast, bool isBroadcast, SockDescVector& result);
     virtual SockDesc *findFirstSocketByLocalAddress(const IPvXAddress& localAddr, ushort localPort);
     virtual void sendUp(cPacket *payload, SockDesc *sd, const IPvXAddress& srcAddr, ushort srcPort, const IPvXAddress& destAddr, ushort destPort, int interfaceId, int ttl, unsigned char tos);
     virtual void sendDown(cPacket *appData, const IPvXAddress& srcAddr, ushort srcPort, const IPvXAddress& destAddr, ushort destPort, int interfaceId, bool multicastLoop, int ttl, unsigned char tos);
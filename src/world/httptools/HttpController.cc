@@ -61,6 +61,7 @@ void HttpController::initialize(int stage)
         EV_INFO << "Using " << rdServerSelection->typeStr() << " for server popularity distribution." << endl;
 
         pspecial = 0.0; // No special events by default
+        specialTableValid = false;
         totalLookups = 0;
     }
     else if (stage == 1)
@@ -319,6 +320,7 @@ void HttpController::setSpecialStatus(const char* www, ServerStatus status, doub
     en->pamortize = amortize;
 
     specialList.push_front(en);
+    specialTableValid = false;
 
     pspecial += p;
 }
@@ -339,6 +341,7 @@ void HttpController::cancelSpecialStatus(const char* www)
             en->pvalue = 0.0;
             en->pamortize = 0.0;
             specialList.erase(i);
+            specialTableValid = false;
             EV_DEBUG << "Special status for " << www << " cancelled" << endl;
             break;
         }
@@ -364,15 +367,27 @@ HttpController::WebServerEntry* HttpController::selectFromSpecialList()
     }
     else
     {
-        double p = uniform(0, 1);
-        double pcumulative = 0.0;
-        std::list<WebServerEntry*>::iterator i;
-        for (i=specialList.begin(); i!=specialList.end(); i++)
+        if (!specialTableValid || pspecial < specialTable.getTotal()/2)
+            rebuildSpecialTable();
+
+        int rejected = 0;
+        while (true)
         {
-            en = (*i);
-            pcumulative += en->pvalue;
-            if (pcumulative/pspecial > p)
+            int k = specialTable.draw(uniform(0, 1));
+            en = specialTableEntries[k];
+            if (uniform(0, 1) * specialTablePValues[k] < en->pvalue)
+                break;
+            // Only happens after amortization; the current probabilities are exact after a rebuild
+            if (++rejected == 8)
+            {
+                rebuildSpecialTable();
+                rejected = 0;
+            }
+            if (specialTable.getTotal() <= 0.0)
+            {
+                en = specialList.back();
                 break;
+            }
         }
     }
 
@@ -397,6 +412,16 @@ HttpController::WebServerEntry* HttpController::selectFromSpecialList()
     return en;
 }
 
+void HttpController::rebuildSpecialTable()
+{
+    specialTableEntries.assign(specialList.begin(), specialList.end());
+    specialTablePValues.resize(specialTableEntries.size());
+    for (unsigned int k=0; k<specialTableEntries.size(); k++)
+        specialTablePValues[k] = specialTableEntries[k]->pvalue;
+    specialTable.build(specialTablePValues);
+    specialTableValid = true;
+}
+
 std::string HttpController::listRegisteredServers()
 {
     std::ostringstream str;
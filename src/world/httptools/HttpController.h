@@ -91,6 +91,17 @@ class HttpController : public cSimpleModule
         std::list<WebServerEntry*> specialList;  ///< The special list -- contains sites with active popularity modification events.
         double pspecial;                ///< The probability [0,1) of selecting a site from the special list.
 
+        /**
+         * Alias table over the special list, built from the special probabilities at build time.
+         * Amortization only lowers the probabilities, so selections are drawn from the table and
+         * accepted with the ratio of the current and the build time probability; the table is
+         * rebuilt when sites are added or too much of the probability has been amortized.
+         */
+        rdAliasTable specialTable;
+        std::vector<WebServerEntry*> specialTableEntries;  ///< The special list entries of the table slots.
+        std::vector<double> specialTablePValues;          ///< The special probabilities the table was built from.
+        bool specialTableValid;                           ///< False if the special list changed since the last build.
+
         unsigned long totalLookups;     ///< A counter for the total number of lookups
 
         rdObject *rdServerSelection;    ///< The random object for the server selection.
@@ -173,6 +184,9 @@ class HttpController : public cSimpleModule
         /** Select a server from the special list. This method is called with the pspecial probability. */
         WebServerEntry* selectFromSpecialList();
 
+        /** Rebuild the alias table used by selectFromSpecialList(). */
+        void rebuildSpecialTable();
+
         /** List the registered servers. Useful for debug. */
         std::string listRegisteredServers();
 
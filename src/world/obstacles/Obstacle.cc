@@ -25,6 +25,7 @@ typedef std::pair<Coord, double> CoordFrac;
 
 Obstacle::Obstacle(std::string id, double attenuationPerWall, double attenuationPerMeter) :
     visualRepresentation(0),
+    visitStamp(0),
     id(id),
     attenuationPerWall(attenuationPerWall),
     attenuationPerMeter(attenuationPerMeter) {
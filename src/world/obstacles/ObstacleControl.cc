@@ -19,7 +19,10 @@
 
 #include <sstream>
 #include <map>
-#include <set>
+#include <limits>
+#include <cmath>
+#include <cstdlib>
+#include <string.h>
 
 #include "world/obstacles/ObstacleControl.h"
 
@@ -36,9 +39,17 @@ void ObstacleControl::initialize(int stage)
     if (stage == 0)
     {
         obstacles.clear();
-        cacheEntries.clear();
+        clearCache();
+        visitStamp = 0;
 
         obstaclesXml = par("obstacles");
+        int cacheSizePar = par("cacheSize");
+        if (cacheSizePar < 0) error("cacheSize must not be negative");
+        cacheSize = cacheSizePar;
+        cacheQuantum = par("cacheQuantum");
+        if (cacheQuantum <= 0) error("cacheQuantum must be positive");
+        cacheAngleQuantum = par("cacheAngleQuantum");
+        if (cacheAngleQuantum <= 0) error("cacheAngleQuantum must be positive");
     }
     else if (stage == 1)
     {
@@ -130,7 +141,7 @@ void ObstacleControl::add(Obstacle obstacle) {
     // visualize using AnnotationManager
     if (annotations) o->visualRepresentation = annotations->drawPolygon(o->getShape(), "red", annotationGroup);
 
-    cacheEntries.clear();
+    clearCache();
 }
 
 void ObstacleControl::erase(const Obstacle* obstacle) {
@@ -150,62 +161,146 @@ void ObstacleControl::erase(const Obstacle* obstacle) {
     if (annotations && obstacle->visualRepresentation) annotations->erase(obstacle->visualRepresentation);
     delete obstacle;
 
+    clearCache();
+}
+
+void ObstacleControl::clearCache() {
     cacheEntries.clear();
+    cacheList.clear();
 }
 
-double ObstacleControl::calculateReceivedPower(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) const {
-    Enter_Method_Silent();
+namespace {
+    inline int64 quantize(double value, double quantum) {
+        return (int64)floor(value / quantum + 0.5);
+    }
 
-    // return cached result, if available
-    CacheKey cacheKey(pSend, carrierFrequency, senderPos, senderAngle, receiverPos, receiverAngle);
-    CacheEntries::const_iterator cacheEntryIter = cacheEntries.find(cacheKey);
-    if (cacheEntryIter != cacheEntries.end()) return cacheEntryIter->second;
+    inline void hashCombine(size_t& seed, uint64 value) {
+        seed ^= (size_t)(value ^ (value >> 32)) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
 
-    // calculate bounding box of transmission
-    Coord bboxP1 = Coord(std::min(senderPos.x, receiverPos.x), std::min(senderPos.y, receiverPos.y));
-    Coord bboxP2 = Coord(std::max(senderPos.x, receiverPos.x), std::max(senderPos.y, receiverPos.y));
+    inline uint64 doubleBits(double value) {
+        uint64 bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+}
 
-    size_t fromRow = std::max(0, int(bboxP1.x / GRIDCELL_SIZE));
-    size_t toRow = std::max(0, int(bboxP2.x / GRIDCELL_SIZE));
-    size_t fromCol = std::max(0, int(bboxP1.y / GRIDCELL_SIZE));
-    size_t toCol = std::max(0, int(bboxP2.y / GRIDCELL_SIZE));
+ObstacleControl::CacheKey::CacheKey(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle, double quantum, double angleQuantum) :
+    senderX(quantize(senderPos.x, quantum)),
+    senderY(quantize(senderPos.y, quantum)),
+    receiverX(quantize(receiverPos.x, quantum)),
+    receiverY(quantize(receiverPos.y, quantum)),
+    senderAngle(quantize(senderAngle, angleQuantum)),
+    receiverAngle(quantize(receiverAngle, angleQuantum)),
+    pSend(pSend),
+    carrierFrequency(carrierFrequency),
+    hash(0) {
+    hashCombine(hash, senderX);
+    hashCombine(hash, senderY);
+    hashCombine(hash, receiverX);
+    hashCombine(hash, receiverY);
+    hashCombine(hash, this->senderAngle);
+    hashCombine(hash, this->receiverAngle);
+    hashCombine(hash, doubleBits(pSend));
+    hashCombine(hash, doubleBits(carrierFrequency));
+}
 
-    std::set<Obstacle*> processedObstacles;
-    for (size_t col = fromCol; col <= toCol; ++col) {
-        if (col >= obstacles.size()) break;
-        for (size_t row = fromRow; row <= toRow; ++row) {
-            if (row >= obstacles[col].size()) break;
-            const ObstacleGridCell& cell = (obstacles[col])[row];
-            for (ObstacleGridCell::const_iterator k = cell.begin(); k != cell.end(); ++k) {
+double ObstacleControl::attenuateCell(const ObstacleGridCell& cell, double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle, const Coord& bboxP1, const Coord& bboxP2) const {
+    for (ObstacleGridCell::const_iterator k = cell.begin(); k != cell.end(); ++k) {
 
-                Obstacle* o = *k;
+        Obstacle* o = *k;
 
-                if (processedObstacles.find(o) != processedObstacles.end()) continue;
-                processedObstacles.insert(o);
+        // obstacles spanning several cells are only processed once per query
+        if (o->visitStamp == visitStamp) continue;
+        o->visitStamp = visitStamp;
 
-                // bail if bounding boxes cannot overlap
-                if (o->getBboxP2().x < bboxP1.x) continue;
-                if (o->getBboxP1().x > bboxP2.x) continue;
-                if (o->getBboxP2().y < bboxP1.y) continue;
-                if (o->getBboxP1().y > bboxP2.y) continue;
+        // bail if bounding boxes cannot overlap
+        if (o->getBboxP2().x < bboxP1.x) continue;
+        if (o->getBboxP1().x > bboxP2.x) continue;
+        if (o->getBboxP2().y < bboxP1.y) continue;
+        if (o->getBboxP1().y > bboxP2.y) continue;
 
-                double pSendOld = pSend;
+        double pSendOld = pSend;
 
-                pSend = o->calculateReceivedPower(pSend, carrierFrequency, senderPos, senderAngle, receiverPos, receiverAngle);
+        pSend = o->calculateReceivedPower(pSend, carrierFrequency, senderPos, senderAngle, receiverPos, receiverAngle);
 
-                // draw a "hit!" bubble
-                if (annotations && (pSend < pSendOld)) annotations->drawBubble(o->getBboxP1(), "hit");
+        // draw a "hit!" bubble
+        if (annotations && (pSend < pSendOld)) annotations->drawBubble(o->getBboxP1(), "hit");
 
-                // bail if attenuation is already extremely high
-                if (pSend < 1e-30) break;
+        // bail if attenuation is already extremely high
+        if (pSend < 1e-30) break;
+    }
+    return pSend;
+}
 
-            }
+double ObstacleControl::calculateReceivedPower(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) const {
+    Enter_Method_Silent();
+
+    // return cached result, if available
+    CacheKey cacheKey(pSend, carrierFrequency, senderPos, senderAngle, receiverPos, receiverAngle, cacheQuantum, cacheAngleQuantum);
+    if (cacheSize > 0) {
+        CacheEntries::iterator cacheEntryIter = cacheEntries.find(cacheKey);
+        if (cacheEntryIter != cacheEntries.end()) {
+            // move entry to the front of the LRU list
+            cacheList.splice(cacheList.begin(), cacheList, cacheEntryIter->second);
+            return cacheEntryIter->second->second;
         }
     }
 
-    // cache result
-    if (cacheEntries.size() >= 1000) cacheEntries.clear();
-    cacheEntries[cacheKey] = pSend;
+    // calculate bounding box of transmission
+    Coord bboxP1 = Coord(std::min(senderPos.x, receiverPos.x), std::min(senderPos.y, receiverPos.y));
+    Coord bboxP2 = Coord(std::max(senderPos.x, receiverPos.x), std::max(senderPos.y, receiverPos.y));
+
+    // start a new query: obstacles stamped with an older value have not been processed yet
+    if (++visitStamp == 0) {
+        for (Obstacles::const_iterator i = obstacles.begin(); i != obstacles.end(); ++i)
+            for (ObstacleGridRow::const_iterator j = i->begin(); j != i->end(); ++j)
+                for (ObstacleGridCell::const_iterator k = j->begin(); k != j->end(); ++k)
+                    (*k)->visitStamp = 0;
+        visitStamp = 1;
+    }
+
+    // walk only the grid cells crossed by the line of sight (Amanatides-Woo traversal);
+    // negative coordinates map to the first row/column, like in add()
+    const double inf = std::numeric_limits<double>::infinity();
+    double x0 = senderPos.x / GRIDCELL_SIZE, y0 = senderPos.y / GRIDCELL_SIZE;
+    double x1 = receiverPos.x / GRIDCELL_SIZE, y1 = receiverPos.y / GRIDCELL_SIZE;
+    int cellX = (int)floor(x0), cellY = (int)floor(y0);
+    int endCellX = (int)floor(x1), endCellY = (int)floor(y1);
+    double dx = x1 - x0, dy = y1 - y0;
+    int stepX = dx > 0 ? 1 : (dx < 0 ? -1 : 0);
+    int stepY = dy > 0 ? 1 : (dy < 0 ? -1 : 0);
+    double tDeltaX = stepX ? 1.0 / fabs(dx) : inf;
+    double tDeltaY = stepY ? 1.0 / fabs(dy) : inf;
+    double tMaxX = stepX > 0 ? (cellX + 1 - x0) / dx : (stepX < 0 ? (x0 - cellX) / -dx : inf);
+    double tMaxY = stepY > 0 ? (cellY + 1 - y0) / dy : (stepY < 0 ? (y0 - cellY) / -dy : inf);
+
+    int numCells = abs(endCellX - cellX) + abs(endCellY - cellY) + 1;
+    for (int n = 0; n < numCells && pSend >= 1e-30; ++n) {
+        size_t row = std::max(0, cellX);
+        size_t col = std::max(0, cellY);
+        if (col < obstacles.size() && row < obstacles[col].size())
+            pSend = attenuateCell((obstacles[col])[row], pSend, carrierFrequency, senderPos, senderAngle, receiverPos, receiverAngle, bboxP1, bboxP2);
+
+        if (tMaxX < tMaxY) {
+            tMaxX += tDeltaX;
+            cellX += stepX;
+        }
+        else {
+            tMaxY += tDeltaY;
+            cellY += stepY;
+        }
+    }
+
+    // cache result, evicting the least recently used entry if full
+    if (cacheSize > 0) {
+        if (cacheEntries.size() >= cacheSize) {
+            cacheEntries.erase(cacheList.back().first);
+            cacheList.pop_back();
+        }
+        cacheList.push_front(CacheEntry(cacheKey, pSend));
+        cacheEntries[cacheKey] = cacheList.begin();
+    }
 
     return pSend;
 }
@@ -22,6 +22,7 @@
 #define WORLD_OBSTACLE_OBSTACLECONTROL_H
 
 #include <list>
+#include <map>
 
 #include "INETDefs.h"
 
@@ -57,40 +58,30 @@ class INET_API ObstacleControl : public cSimpleModule
         double calculateReceivedPower(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) const;
 
     protected:
+        /**
+         * Key of the received power cache. Positions and angles are quantized
+         * to integers (each with its own quantum) so that nearly identical
+         * queries share an entry; a hash of all fields is compared first to
+         * keep lookups cheap.
+         */
         struct CacheKey {
-            const double pSend;
-            const double carrierFrequency;
-            const Coord senderPos;
-            const double senderAngle;
-            const Coord receiverPos;
-            const double receiverAngle;
-
-            CacheKey(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle) :
-                pSend(pSend),
-                carrierFrequency(carrierFrequency),
-                senderPos(senderPos),
-                senderAngle(senderAngle),
-                receiverPos(receiverPos),
-                receiverAngle(receiverAngle) {
-            }
+            int64 senderX, senderY, receiverX, receiverY;
+            int64 senderAngle, receiverAngle;
+            double pSend;
+            double carrierFrequency;
+            size_t hash;
+
+            CacheKey(double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle, double quantum, double angleQuantum);
             bool operator<(const CacheKey& o) const {
-                if (senderPos.x < o.senderPos.x) return true;
-                if (senderPos.x > o.senderPos.x) return false;
-                if (senderPos.y < o.senderPos.y) return true;
-                if (senderPos.y > o.senderPos.y) return false;
-                if (receiverPos.x < o.receiverPos.x) return true;
-                if (receiverPos.x > o.receiverPos.x) return false;
-                if (receiverPos.y < o.receiverPos.y) return true;
-                if (receiverPos.y > o.receiverPos.y) return false;
-                if (pSend < o.pSend) return true;
-                if (pSend > o.pSend) return false;
-                if (senderAngle < o.senderAngle) return true;
-                if (senderAngle > o.senderAngle) return false;
-                if (receiverAngle < o.receiverAngle) return true;
-                if (receiverAngle > o.receiverAngle) return false;
-                if (carrierFrequency < o.carrierFrequency) return true;
-                if (carrierFrequency > o.carrierFrequency) return false;
-                return false;
+                if (hash != o.hash) return hash < o.hash;
+                if (senderX != o.senderX) return senderX < o.senderX;
+                if (senderY != o.senderY) return senderY < o.senderY;
+                if (receiverX != o.receiverX) return receiverX < o.receiverX;
+                if (receiverY != o.receiverY) return receiverY < o.receiverY;
+                if (pSend != o.pSend) return pSend < o.pSend;
+                if (senderAngle != o.senderAngle) return senderAngle < o.senderAngle;
+                if (receiverAngle != o.receiverAngle) return receiverAngle < o.receiverAngle;
+                return carrierFrequency < o.carrierFrequency;
             }
         };
 
@@ -99,7 +90,9 @@ class INET_API ObstacleControl : public cSimpleModule
         typedef std::list<Obstacle*> ObstacleGridCell;
         typedef std::vector<ObstacleGridCell> ObstacleGridRow;
         typedef std::vector<ObstacleGridRow> Obstacles;
-        typedef std::map<CacheKey, double> CacheEntries;
+        typedef std::pair<CacheKey, double> CacheEntry;
+        typedef std::list<CacheEntry> CacheList; /**< most recently used entry first */
+        typedef std::map<CacheKey, CacheList::iterator> CacheEntries;
 
         cXMLElement* obstaclesXml; /**< obstacles to add at startup */
 
@@ -107,6 +100,14 @@ class INET_API ObstacleControl : public cSimpleModule
         AnnotationManager* annotations;
         AnnotationManager::Group* annotationGroup;
         mutable CacheEntries cacheEntries;
+        mutable CacheList cacheList;
+        size_t cacheSize; /**< maximum number of cached results, 0 disables the cache */
+        double cacheQuantum; /**< in m, resolution of positions in cache keys */
+        double cacheAngleQuantum; /**< in rad, resolution of angles in cache keys */
+        mutable unsigned int visitStamp; /**< incremented per query, marks already processed obstacles */
+
+        void clearCache();
+        double attenuateCell(const ObstacleGridCell& cell, double pSend, double carrierFrequency, const Coord& senderPos, double senderAngle, const Coord& receiverPos, double receiverAngle, const Coord& bboxP1, const Coord& bboxP2) const;
 };
 
 class ObstacleControlAccess
@@ -18,6 +18,7 @@
 
 #include "ChannelAccess.h"
 #include "IMobility.h"
+#include "MovingMobilityBase.h"
 
 #define coreEV (ev.isDisabled()||!coreDebug) ? EV : EV << logName() << "::ChannelAccess: "
 
@@ -60,6 +61,8 @@ void ChannelAccess::initialize(int stage)
         hostModule = findHost();
         myRadioRef = NULL;
 
+        radioSpeed = Coord::ZERO;
+        radioPosTime = simTime();
         positionUpdateArrived = false;
         // register to get a notification when position changes
         hostModule->subscribe(mobilityStateChangedSignal, this);
@@ -85,7 +88,7 @@ void ChannelAccess::initialize(int stage)
         }
 
         myRadioRef = cc->registerRadio(this);
-        cc->setRadioPosition(myRadioRef, radioPos);
+        cc->setRadioMovement(myRadioRef, radioPos, radioSpeed);
     }
 }
 
@@ -118,10 +121,15 @@ void ChannelAccess::receiveSignal(cComponent *source, simsignal_t signalID, cObj
     {
         IMobility *mobility = check_and_cast<IMobility*>(obj);
         radioPos = mobility->getCurrentPosition();
+        radioPosTime = simTime();
+        // event driven models only signal changes of the movement, in between
+        // the position is extrapolated from the speed
+        MovingMobilityBase *movingMobility = dynamic_cast<MovingMobilityBase*>(obj);
+        radioSpeed = movingMobility && movingMobility->isEventDriven() ? mobility->getCurrentSpeed() : Coord::ZERO;
         positionUpdateArrived = true;
 
         if (myRadioRef)
-            cc->setRadioPosition(myRadioRef, radioPos);
+            cc->setRadioMovement(myRadioRef, radioPos, radioSpeed);
     }
 }
 
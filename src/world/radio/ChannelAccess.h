@@ -57,7 +57,9 @@ class INET_API ChannelAccess : public BasicModule, protected cListener
     IChannelControl* cc;  // Pointer to the ChannelControl module
     IChannelControl::RadioRef myRadioRef;  // Identifies this radio in the ChannelControl module
     cModule *hostModule;    // the host that contains this radio model
-    Coord radioPos;  // the physical position of the radio (derived from display string or from mobility models)
+    Coord radioPos;  // the physical position of the radio at radioPosTime (derived from display string or from mobility models)
+    Coord radioSpeed;  // the speed of the radio since radioPosTime, only set for event driven mobility models
+    simtime_t radioPosTime;
     bool positionUpdateArrived;
 
   public:
@@ -79,7 +81,9 @@ class INET_API ChannelAccess : public BasicModule, protected cListener
     virtual void sendToChannel(AirFrame *msg);
 
     virtual cPar& getChannelControlPar(const char *parName) { return dynamic_cast<cModule *>(cc)->par(parName); }
-    const Coord& getRadioPosition() const { return radioPos; }
+    Coord getRadioPosition() const {
+        return radioSpeed == Coord::ZERO ? radioPos : radioPos + radioSpeed * (simTime() - radioPosTime).dbl();
+    }
     cModule *getHostModule() const { return hostModule; }
 
     /** Register with ChannelControl and subscribe to hostPos*/
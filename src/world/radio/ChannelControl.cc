@@ -21,7 +21,13 @@
 
 #include "AirFrame_m.h"
 
-#define coreEV (ev.isDisabled()||!coreDebug) ? EV : EV << "ChannelControl: "
+#define coreEV (!INET_LOG_ENABLED(DETAIL)||!coreDebug) ? EV : EV << "ChannelControl: "
+
+// module specific compile-time log level, see Compat.h
+#ifdef CHANNELCONTROL_LOG_LEVEL
+#  undef INET_LOG_LEVEL
+#  define INET_LOG_LEVEL  CHANNELCONTROL_LOG_LEVEL
+#endif
 
 Define_Module(ChannelControl);
 
@@ -42,10 +48,14 @@ std::ostream& operator<<(std::ostream& os, const ChannelControl::TransmissionLis
 
 ChannelControl::ChannelControl()
 {
+    rangeCrossingTimer = NULL;
+    rangeCrossingsPurgeLimit = 1024;
 }
 
 ChannelControl::~ChannelControl()
 {
+    cancelAndDelete(rangeCrossingTimer);
+
     for (unsigned int i = 0; i < transmissions.size(); i++)
         for (TransmissionList::iterator it = transmissions[i].begin(); it != transmissions[i].end(); it++)
             delete *it;
@@ -67,6 +77,8 @@ void ChannelControl::initialize()
 
     lastOngoingTransmissionsUpdate = 0;
 
+    rangeCrossingTimer = new cMessage("rangeCrossing");
+
     maxInterferenceDistance = calcInterfDist();
 
     WATCH(maxInterferenceDistance);
@@ -123,6 +135,8 @@ ChannelControl::RadioRef ChannelControl::registerRadio(cModule *radio, cGate *ra
     re.radioModule = radio;
     re.radioInGate = radioInGate->getPathStartGate();
     re.isNeighborListValid = false;
+    re.posTime = simTime();
+    re.movementVersion = 0;
     re.channel = 0;  // for now
     re.isActive = true;
     radios.push_back(re);
@@ -137,6 +151,17 @@ void ChannelControl::unregisterRadio(RadioRef r)
         if (it->radioModule == r->radioModule)
         {
             RadioRef radioToRemove = &*it;
+
+            // forget predicted range crossings of the radio
+            for (RangeCrossings::iterator i2 = rangeCrossings.begin(); i2 != rangeCrossings.end(); )
+            {
+                if (i2->second.a == radioToRemove || i2->second.b == radioToRemove)
+                    rangeCrossings.erase(i2++);
+                else
+                    ++i2;
+            }
+            scheduleRangeCrossingTimer();
+
             // erase radio from all registered radios' neighbor list
             for (RadioList::iterator i2 = radios.begin(); i2 != radios.end(); ++i2)
             {
@@ -157,7 +182,7 @@ void ChannelControl::unregisterRadio(RadioRef r)
 
 ChannelControl::RadioRef ChannelControl::lookupRadio(cModule *radio)
 {
-    Enter_Method_Silent();
+    Enter_Method_Query_Silent();
     for (RadioList::iterator it = radios.begin(); it != radios.end(); it++)
         if (it->radioModule == radio)
             return &(*it);
@@ -166,7 +191,7 @@ ChannelControl::RadioRef ChannelControl::lookupRadio(cModule *radio)
 
 const ChannelControl::RadioRefVector& ChannelControl::getNeighbors(RadioRef h)
 {
-    Enter_Method_Silent();
+    Enter_Method_Query_Silent();
     if (!h->isNeighborListValid)
     {
         h->neighborList.clear();
@@ -179,7 +204,7 @@ const ChannelControl::RadioRefVector& ChannelControl::getNeighbors(RadioRef h)
 
 void ChannelControl::updateConnections(RadioRef h)
 {
-    Coord& hpos = h->pos;
+    Coord hpos = getCurrentPosition(h);
     double maxDistSquared = maxInterferenceDistance * maxInterferenceDistance;
     for (RadioList::iterator it = radios.begin(); it != radios.end(); ++it)
     {
@@ -189,29 +214,133 @@ void ChannelControl::updateConnections(RadioRef h)
 
         // get the distance between the two radios.
         // (omitting the square root (calling sqrdist() instead of distance()) saves about 5% CPU)
-        bool inRange = hpos.sqrdist(hi->pos) < maxDistSquared;
+        Coord hipos = getCurrentPosition(hi);
+        bool inRange = hpos.sqrdist(hipos) < maxDistSquared;
 
         if (inRange)
-        {
             // nodes within communication range: connect
-            if (h->neighbors.insert(hi).second == true)
-            {
-                hi->neighbors.insert(h);
-                h->isNeighborListValid = hi->isNeighborListValid = false;
-            }
-        }
+            connect(h, hi);
         else
-        {
             // out of range: disconnect
-            if (h->neighbors.erase(hi))
-            {
-                hi->neighbors.erase(h);
-                h->isNeighborListValid = hi->isNeighborListValid = false;
-            }
+            disconnect(h, hi);
+
+        // if any of them moves, predict when the connection changes
+        if (h->speed != Coord::ZERO || hi->speed != Coord::ZERO)
+            scheduleRangeCrossings(h, hi, hpos, hipos);
+    }
+    if (rangeCrossings.size() > rangeCrossingsPurgeLimit)
+        purgeRangeCrossings();
+    scheduleRangeCrossingTimer();
+}
+
+void ChannelControl::connect(RadioRef a, RadioRef b)
+{
+    if (a->neighbors.insert(b).second == true)
+    {
+        b->neighbors.insert(a);
+        a->isNeighborListValid = b->isNeighborListValid = false;
+    }
+}
+
+void ChannelControl::disconnect(RadioRef a, RadioRef b)
+{
+    if (a->neighbors.erase(b))
+    {
+        b->neighbors.erase(a);
+        a->isNeighborListValid = b->isNeighborListValid = false;
+    }
+}
+
+void ChannelControl::scheduleRangeCrossings(RadioRef a, RadioRef b, const Coord& posA, const Coord& posB)
+{
+    // solve |d + w*t|^2 = R^2 for the relative position d and relative speed w
+    Coord d = posA - posB;
+    Coord w = a->speed - b->speed;
+    double ww = w.x * w.x + w.y * w.y + w.z * w.z;
+    if (ww == 0)
+        return;
+    double dw = d.x * w.x + d.y * w.y + d.z * w.z;
+    double dd = d.x * d.x + d.y * d.y + d.z * d.z;
+    double maxDistSquared = maxInterferenceDistance * maxInterferenceDistance;
+    double discriminant = dw * dw - ww * (dd - maxDistSquared);
+    if (discriminant <= 0)
+        return; // never in range
+    double sqrtDiscriminant = sqrt(discriminant);
+    double enterTime = (-dw - sqrtDiscriminant) / ww;
+    double leaveTime = (-dw + sqrtDiscriminant) / ww;
+    if (leaveTime <= 0)
+        return; // moving away from each other
+
+    simtime_t now = simTime();
+    double maxDelta = (MAXTIME - now).dbl();
+    RangeCrossing crossing;
+    crossing.a = a;
+    crossing.b = b;
+    crossing.versionA = a->movementVersion;
+    crossing.versionB = b->movementVersion;
+    if (enterTime > 0 && enterTime < maxDelta)
+    {
+        crossing.connect = true;
+        rangeCrossings.insert(std::make_pair(now + enterTime, crossing));
+    }
+    if (leaveTime < maxDelta)
+    {
+        crossing.connect = false;
+        rangeCrossings.insert(std::make_pair(now + leaveTime, crossing));
+    }
+}
+
+void ChannelControl::purgeRangeCrossings()
+{
+    for (RangeCrossings::iterator it = rangeCrossings.begin(); it != rangeCrossings.end(); )
+    {
+        const RangeCrossing& crossing = it->second;
+        if (crossing.a->movementVersion != crossing.versionA || crossing.b->movementVersion != crossing.versionB)
+            rangeCrossings.erase(it++);
+        else
+            ++it;
+    }
+    rangeCrossingsPurgeLimit = std::max((size_t)1024, 2 * rangeCrossings.size());
+}
+
+void ChannelControl::scheduleRangeCrossingTimer()
+{
+    if (rangeCrossings.empty())
+        cancelEvent(rangeCrossingTimer);
+    else
+    {
+        simtime_t next = rangeCrossings.begin()->first;
+        if (!rangeCrossingTimer->isScheduled() || rangeCrossingTimer->getArrivalTime() != next)
+        {
+            cancelEvent(rangeCrossingTimer);
+            scheduleAt(next, rangeCrossingTimer);
         }
     }
 }
 
+void ChannelControl::handleMessage(cMessage *msg)
+{
+    if (msg != rangeCrossingTimer)
+        error("ChannelControl doesn't handle messages from other modules");
+
+    simtime_t now = simTime();
+    while (!rangeCrossings.empty() && rangeCrossings.begin()->first <= now)
+    {
+        RangeCrossing crossing = rangeCrossings.begin()->second;
+        rangeCrossings.erase(rangeCrossings.begin());
+
+        // skip predictions made obsolete by a newer movement
+        if (crossing.a->movementVersion != crossing.versionA || crossing.b->movementVersion != crossing.versionB)
+            continue;
+
+        if (crossing.connect)
+            connect(crossing.a, crossing.b);
+        else
+            disconnect(crossing.a, crossing.b);
+    }
+    scheduleRangeCrossingTimer();
+}
+
 void ChannelControl::checkChannel(int channel)
 {
     if (channel >= numChannels || channel < 0)
@@ -219,9 +348,17 @@ void ChannelControl::checkChannel(int channel)
 }
 
 void ChannelControl::setRadioPosition(RadioRef r, const Coord& pos)
+{
+    setRadioMovement(r, pos, Coord::ZERO);
+}
+
+void ChannelControl::setRadioMovement(RadioRef r, const Coord& pos, const Coord& speed)
 {
     Enter_Method_Silent();
     r->pos = pos;
+    r->speed = speed;
+    r->posTime = simTime();
+    r->movementVersion++;
     updateConnections(r);
 }
 
@@ -233,6 +370,12 @@ void ChannelControl::setRadioChannel(RadioRef r, int channel)
     r->channel = channel;
 }
 
+void ChannelControl::setRadioAddress(RadioRef r, const MACAddress& address)
+{
+    Enter_Method_Silent();
+    r->address = address;
+}
+
 const ChannelControl::TransmissionList& ChannelControl::getOngoingTransmissions(int channel)
 {
     Enter_Method_Silent();
@@ -287,6 +430,22 @@ void ChannelControl::purgeOngoingTransmissions()
     }
 }
 
+AirFrame *ChannelControl::createHeaderOnlyFrame(AirFrame *airFrame)
+{
+    AirFrame *headerOnlyFrame = airFrame->dup();
+    cPacket *frame = headerOnlyFrame->decapsulate();
+    if (frame && frame->getEncapsulatedPacket())
+    {
+        int64 bitLength = frame->getBitLength();
+        delete frame->decapsulate();
+        frame->setBitLength(bitLength);
+    }
+    if (frame)
+        headerOnlyFrame->encapsulate(frame);
+    headerOnlyFrame->setHeaderOnly(true);
+    return headerOnlyFrame;
+}
+
 void ChannelControl::sendToChannel(RadioRef srcRadio, AirFrame *airFrame)
 {
     // NOTE: no Enter_Method()! We pretend this method is part of ChannelAccess
@@ -295,6 +454,8 @@ void ChannelControl::sendToChannel(RadioRef srcRadio, AirFrame *airFrame)
     const RadioRefVector& neighbors = getNeighbors(srcRadio);
     int n = neighbors.size();
     int channel = airFrame->getChannelNumber();
+    const MACAddress& receiverAddress = airFrame->getReceiverAddress();
+    AirFrame *headerOnlyFrame = NULL; // created on demand, shared by all radios that overhear the frame
     for (int i=0; i<n; i++)
     {
         RadioRef r = neighbors[i];
@@ -308,12 +469,22 @@ void ChannelControl::sendToChannel(RadioRef srcRadio, AirFrame *airFrame)
             coreEV << "sending message to radio listening on the same channel\n";
             // account for propagation delay, based on distance in meters
             // Over 300m, dt=1us=10 bit times @ 10Mbps
-            simtime_t delay = srcRadio->pos.distance(r->pos) / SPEED_OF_LIGHT;
-            check_and_cast<cSimpleModule*>(srcRadio->radioModule)->sendDirect(airFrame->dup(), delay, airFrame->getDuration(), r->radioInGate);
+            simtime_t delay = getCurrentPosition(srcRadio).distance(getCurrentPosition(r)) / SPEED_OF_LIGHT;
+            AirFrame *copy;
+            if (!receiverAddress.isUnspecified() && !r->address.isUnspecified() && r->address != receiverAddress)
+            {
+                if (!headerOnlyFrame)
+                    headerOnlyFrame = createHeaderOnlyFrame(airFrame);
+                copy = headerOnlyFrame->dup();
+            }
+            else
+                copy = airFrame->dup();
+            check_and_cast<cSimpleModule*>(srcRadio->radioModule)->sendDirect(copy, delay, airFrame->getDuration(), r->radioInGate);
         }
         else
             coreEV << "skipping radio listening on a different channel\n";
     }
+    delete headerOnlyFrame;
 
     // register transmission
     addOngoingTransmission(srcRadio, airFrame);
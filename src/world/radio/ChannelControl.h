@@ -20,6 +20,7 @@
 #include <vector>
 #include <list>
 #include <set>
+#include <map>
 
 #include "INETDefs.h"
 #include "Coord.h"
@@ -39,7 +40,11 @@ struct IChannelControl::RadioEntry {
     cModule *radioModule;  // the module that registered this radio interface
     cGate *radioInGate;  // gate on host module used to receive airframes
     int channel;
-    Coord pos; // cached radio position
+    Coord pos; // cached radio position at posTime
+    Coord speed; // constant speed since posTime, zero if the radio only reports positions
+    simtime_t posTime;
+    unsigned int movementVersion; // incremented on every position update, invalidates predicted range crossings
+    MACAddress address; // if specified, unicast frames for other addresses are received header-only
 
     struct Compare {
         bool operator() (const RadioRef &lhs, const RadioRef &rhs) const {
@@ -91,9 +96,47 @@ class INET_API ChannelControl : public cSimpleModule, public IChannelControl
     /** the number of controlled channels */
     int numChannels;
 
+    /**
+     * A predicted point in time when two radios with known speeds enter or leave
+     * each other's interference range. Only valid if none of the radios reported
+     * a new movement since the prediction.
+     */
+    struct RangeCrossing {
+        RadioRef a;
+        RadioRef b;
+        unsigned int versionA;
+        unsigned int versionB;
+        bool connect;
+    };
+    typedef std::multimap<simtime_t, RangeCrossing> RangeCrossings;
+    RangeCrossings rangeCrossings;
+    size_t rangeCrossingsPurgeLimit; // obsolete predictions are removed when the size exceeds this
+    cMessage *rangeCrossingTimer;
+
   protected:
     virtual void updateConnections(RadioRef h);
 
+    /** Adds/removes the two radios to/from each other's neighbor set */
+    virtual void connect(RadioRef a, RadioRef b);
+    virtual void disconnect(RadioRef a, RadioRef b);
+
+    /** Returns the position of the radio at the current simulation time */
+    Coord getCurrentPosition(RadioRef r) const {
+        return r->speed == Coord::ZERO ? r->pos : r->pos + r->speed * (simTime() - r->posTime).dbl();
+    }
+
+    /** Predicts when two moving radios enter or leave each other's interference range */
+    virtual void scheduleRangeCrossings(RadioRef a, RadioRef b, const Coord& posA, const Coord& posB);
+
+    /** Removes predicted range crossings made obsolete by newer movements */
+    virtual void purgeRangeCrossings();
+
+    /** Schedules the timer for the earliest predicted range crossing */
+    virtual void scheduleRangeCrossingTimer();
+
+    /** Applies predicted range crossings */
+    virtual void handleMessage(cMessage *msg);
+
     /** Calculate interference distance*/
     virtual double calcInterfDist();
 
@@ -112,6 +155,13 @@ class INET_API ChannelControl : public cSimpleModule, public IChannelControl
     /** Notifies the channel control with an ongoing transmission */
     virtual void addOngoingTransmission(RadioRef h, AirFrame *frame);
 
+    /**
+     * Returns a copy of the airframe whose encapsulated frame lacks the payload
+     * but keeps its original length. It is sent to the radios that overhear
+     * a unicast frame, see setRadioAddress().
+     */
+    virtual AirFrame *createHeaderOnlyFrame(AirFrame *airFrame);
+
     /** Returns the "handle" of a previously registered radio. The pointer to the registering (radio) module must be provided */
     virtual RadioRef lookupRadio(cModule *radioModule);
 
@@ -137,9 +187,15 @@ class INET_API ChannelControl : public cSimpleModule, public IChannelControl
     /** To be called when the host moved; updates proximity info */
     virtual void setRadioPosition(RadioRef r, const Coord& pos);
 
+    /** To be called when the host moved and continues moving with the given constant speed; updates proximity info */
+    virtual void setRadioMovement(RadioRef r, const Coord& pos, const Coord& speed);
+
     /** Called when host switches channel */
     virtual void setRadioChannel(RadioRef r, int channel);
 
+    /** Sets the link-layer address of the radio; overheard unicast frames are then received header-only */
+    virtual void setRadioAddress(RadioRef r, const MACAddress& address);
+
     /** Returns the number of radio channels (frequencies) simulated */
     virtual int getNumChannels() { return numChannels; }
 
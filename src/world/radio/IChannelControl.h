@@ -22,6 +22,7 @@
 
 #include "INETDefs.h"
 #include "Coord.h"
+#include "MACAddress.h"
 
 // Forward declarations
 class AirFrame;
@@ -59,9 +60,19 @@ class INET_API IChannelControl
     /** To be called when the host moved; updates proximity info */
     virtual void setRadioPosition(RadioRef r, const Coord& pos) = 0;
 
+    /** To be called when the host moved and continues moving with the given constant speed; updates proximity info */
+    virtual void setRadioMovement(RadioRef r, const Coord& pos, const Coord& speed) = 0;
+
     /** Called when host switches channel */
     virtual void setRadioChannel(RadioRef r, int channel) = 0;
 
+    /**
+     * Sets the link-layer address of the radio's interface. Unicast frames
+     * addressed to someone else are then delivered to this radio header-only;
+     * an unspecified address turns this off.
+     */
+    virtual void setRadioAddress(RadioRef r, const MACAddress& address) = 0;
+
     /** Returns the number of radio channels (frequencies) simulated */
     virtual int getNumChannels() = 0;
 
@@ -62,6 +62,7 @@ void TraCIScenarioManager::initialize(int stage)
         moduleName = par("moduleName").stdstringValue();
         moduleDisplayString = par("moduleDisplayString").stdstringValue();
         penetrationRate = par("penetrationRate").doubleValue();
+        asyncSteps = par("asyncSteps");
         host = par("host").stdstringValue();
         port = par("port");
         autoShutdown = par("autoShutdown");
@@ -95,12 +96,17 @@ void TraCIScenarioManager::initialize(int stage)
 
         nextNodeVectorIndex = 0;
         hosts.clear();
+        hostMobilities.clear();
         subscribedVehicles.clear();
         activeVehicleCount = 0;
         autoShutdownTriggered = false;
 
         socketPtr = 0;
 
+        numVehicleUpdates = 0;
+        stepRequestPending = false;
+        stepResponseAvailable = false;
+
         connectAndStartTrigger = new cMessage("connect");
         scheduleAt(connectAt, connectAndStartTrigger);
         executeOneTimestepTrigger = new cMessage("step");
@@ -110,47 +116,38 @@ void TraCIScenarioManager::initialize(int stage)
     }
 }
 
+void TraCIScenarioManager::receiveTraCIBytes(char* buf, size_t len) {
+    size_t bytesRead = 0;
+    while (bytesRead < len) {
+        int receivedBytes = ::recv(MYSOCKET, buf + bytesRead, len - bytesRead, 0);
+        if (receivedBytes > 0) {
+            bytesRead += receivedBytes;
+        } else if (receivedBytes == 0) {
+            error("Connection to TraCI server closed unexpectedly. Check your server's log");
+        } else {
+            if (sock_errno() == EINTR) continue;
+            if (sock_errno() == EAGAIN) continue;
+            error("Connection to TraCI server lost. Check your server's log. Error message: %d: %s", sock_errno(), strerror(sock_errno()));
+        }
+    }
+}
+
 std::string TraCIScenarioManager::receiveTraCIMessage() {
     if (!socketPtr) error("Connection to TraCI server lost");
 
     uint32_t msgLength;
     {
         char buf2[sizeof(uint32_t)];
-        uint32_t bytesRead = 0;
-        while (bytesRead < sizeof(uint32_t)) {
-            int receivedBytes = ::recv(MYSOCKET, reinterpret_cast<char*>(&buf2) + bytesRead, sizeof(uint32_t) - bytesRead, 0);
-            if (receivedBytes > 0) {
-                bytesRead += receivedBytes;
-            } else if (receivedBytes == 0) {
-                error("Connection to TraCI server closed unexpectedly. Check your server's log");
-            } else {
-                if (sock_errno() == EINTR) continue;
-                if (sock_errno() == EAGAIN) continue;
-                error("Connection to TraCI server lost. Check your server's log. Error message: %d: %s", sock_errno(), strerror(sock_errno()));
-            }
-        }
+        receiveTraCIBytes(buf2, sizeof(uint32_t));
         TraCIBuffer(std::string(buf2, sizeof(uint32_t))) >> msgLength;
     }
 
+    // receive the whole message body directly into the returned string
     uint32_t bufLength = msgLength - sizeof(msgLength);
-    char buf[bufLength];
-    {
-        EV_DEBUG << "Reading TraCI message of " << bufLength << " bytes" << endl;
-        uint32_t bytesRead = 0;
-        while (bytesRead < bufLength) {
-            int receivedBytes = ::recv(MYSOCKET, reinterpret_cast<char*>(&buf) + bytesRead, bufLength - bytesRead, 0);
-            if (receivedBytes > 0) {
-                bytesRead += receivedBytes;
-            } else if (receivedBytes == 0) {
-                error("Connection to TraCI server closed unexpectedly. Check your server's log");
-            } else {
-                if (sock_errno() == EINTR) continue;
-                if (sock_errno() == EAGAIN) continue;
-                error("Connection to TraCI server lost. Check your server's log. Error message: %d: %s", sock_errno(), strerror(sock_errno()));
-            }
-        }
-    }
-    return std::string(buf, bufLength);
+    std::string buf(bufLength, '\0');
+    EV_DEBUG << "Reading TraCI message of " << bufLength << " bytes" << endl;
+    if (bufLength > 0) receiveTraCIBytes(&buf[0], bufLength);
+    return buf;
 }
 
 void TraCIScenarioManager::sendTraCIMessage(std::string buf) {
@@ -198,10 +195,16 @@ std::string TraCIScenarioManager::makeTraCICommand(uint8_t commandId, TraCIBuffe
     return (TraCIBuffer() << len << commandId).str() + buf.str();
 }
 
-TraCIScenarioManager::TraCIBuffer TraCIScenarioManager::queryTraCI(uint8_t commandId, const TraCIBuffer& buf) {
+std::string TraCIScenarioManager::sendTraCICommand(uint8_t commandId, const TraCIBuffer& buf) {
+    // in asynchronous mode, the response of a pending time step arrives first
+    receiveStepResponse();
+
     sendTraCIMessage(makeTraCICommand(commandId, buf));
+    return receiveTraCIMessage();
+}
 
-    TraCIBuffer obuf(receiveTraCIMessage());
+TraCIScenarioManager::TraCIBuffer TraCIScenarioManager::queryTraCI(uint8_t commandId, const TraCIBuffer& buf) {
+    TraCIBuffer obuf(sendTraCICommand(commandId, buf));
     uint8_t cmdLength; obuf >> cmdLength;
     uint8_t commandResp; obuf >> commandResp;
     ASSERT(commandResp == commandId);
@@ -214,9 +217,7 @@ TraCIScenarioManager::TraCIBuffer TraCIScenarioManager::queryTraCI(uint8_t comma
 }
 
 TraCIScenarioManager::TraCIBuffer TraCIScenarioManager::queryTraCIOptional(uint8_t commandId, const TraCIBuffer& buf, bool& success, std::string* errorMsg) {
-    sendTraCIMessage(makeTraCICommand(commandId, buf));
-
-    TraCIBuffer obuf(receiveTraCIMessage());
+    TraCIBuffer obuf(sendTraCICommand(commandId, buf));
     uint8_t cmdLength; obuf >> cmdLength;
     uint8_t commandResp; obuf >> commandResp;
     ASSERT(commandResp == commandId);
@@ -324,6 +325,7 @@ void TraCIScenarioManager::init_traci() {
         TraCIBuffer buf = queryTraCI(CMD_SUBSCRIBE_VEHICLE_VARIABLE, TraCIBuffer() << beginTime << endTime << objectId << variableNumber << variable1);
         processSubcriptionResult(buf);
         ASSERT(buf.eof());
+        applyVehicleUpdates();
     }
 
 }
@@ -338,6 +340,8 @@ void TraCIScenarioManager::finish() {
         delete &MYSOCKET;
         socketPtr = 0;
     }
+    stepRequestPending = false;
+    stepResponseAvailable = false;
     while (hosts.begin() != hosts.end()) {
         deleteModule(hosts.begin()->first);
     }
@@ -426,6 +430,10 @@ std::string TraCIScenarioManager::commandGetLaneId(std::string nodeId) {
 }
 
 double TraCIScenarioManager::commandGetLanePosition(std::string nodeId) {
+    // the lane position of managed vehicles is part of their subscription
+    std::map<std::string, std::vector<TraCIMobility*> >::const_iterator i = hostMobilities.find(nodeId);
+    if (i != hostMobilities.end() && !i->second.empty() && i->second.front()->hasLanePosition())
+        return i->second.front()->getLanePosition();
     return genericGetDouble(CMD_GET_VEHICLE_VARIABLE, nodeId, VAR_LANEPOSITION, RESPONSE_GET_VEHICLE_VARIABLE);
 }
 
@@ -627,11 +635,14 @@ void TraCIScenarioManager::addModule(std::string nodeId, std::string type, std::
     mod->scheduleStart(simTime() + updateInterval);
 
     // pre-initialize TraCIMobility
+    std::vector<TraCIMobility*>& mobilities = hostMobilities[nodeId];
+    mobilities.clear();
     for (cModule::SubmoduleIterator iter(mod); !iter.end(); iter++) {
         cModule* submod = iter();
         TraCIMobility* mm = dynamic_cast<TraCIMobility*>(submod);
         if (!mm) continue;
         mm->preInitialize(nodeId, position, road_id, speed, angle);
+        mobilities.push_back(mm);
     }
 
     mod->callInitialize();
@@ -655,6 +666,7 @@ void TraCIScenarioManager::deleteModule(std::string nodeId) {
     if (!mod->getSubmodule("notificationBoard")) error("host has no submodule notificationBoard");
 
     hosts.erase(nodeId);
+    hostMobilities.erase(nodeId);
     mod->callFinish();
     mod->deleteModule();
 }
@@ -685,19 +697,65 @@ void TraCIScenarioManager::executeOneTimestep() {
     uint32_t targetTime = getCurrentTimeMs();
 
     if (targetTime > round(connectAt.dbl() * 1000)) {
-        TraCIBuffer buf = queryTraCI(CMD_SIMSTEP2, TraCIBuffer() << targetTime);
-
-        uint32_t count; buf >> count;
-        EV_DEBUG << "Getting " << count << " subscription results" << endl;
-        for (uint32_t i = 0; i < count; ++i) {
-            processSubcriptionResult(buf);
+        if (asyncSteps) {
+            // the request for this step was normally sent at the end of the previous step
+            if (!stepRequestPending && !stepResponseAvailable) sendStepRequest(targetTime);
+            receiveStepResponse();
+            stepResponseAvailable = false;
+            TraCIBuffer buf(stepResponse);
+            processStepResponse(buf);
+        }
+        else {
+            TraCIBuffer buf = queryTraCI(CMD_SIMSTEP2, TraCIBuffer() << targetTime);
+            processStepResponse(buf);
         }
     }
 
-    if (!autoShutdownTriggered) scheduleAt(simTime()+updateInterval, executeOneTimestepTrigger);
+    if (!autoShutdownTriggered) {
+        scheduleAt(simTime()+updateInterval, executeOneTimestepTrigger);
+
+        // let the TraCI server compute the next step while OMNeT++ simulates this one
+        if (asyncSteps) sendStepRequest(static_cast<uint32_t>(round((simTime() + updateInterval).dbl() * 1000)));
+    }
 
 }
 
+void TraCIScenarioManager::processStepResponse(TraCIBuffer& buf) {
+    uint32_t count; buf >> count;
+    EV_DEBUG << "Getting " << count << " subscription results" << endl;
+    for (uint32_t i = 0; i < count; ++i) {
+        processSubcriptionResult(buf);
+    }
+    applyVehicleUpdates();
+}
+
+void TraCIScenarioManager::sendStepRequest(uint32_t targetTime) {
+    ASSERT(!stepRequestPending && !stepResponseAvailable);
+    EV_DEBUG << "Requesting TraCI server simulation advance to t=" << targetTime << "ms" << endl;
+    sendTraCIMessage(makeTraCICommand(CMD_SIMSTEP2, TraCIBuffer() << targetTime));
+    stepRequestPending = true;
+}
+
+void TraCIScenarioManager::receiveStepResponse() {
+    if (!stepRequestPending) return;
+    stepRequestPending = false;
+
+    TraCIBuffer obuf(receiveTraCIMessage());
+    uint8_t cmdLength; obuf >> cmdLength;
+    uint8_t commandResp; obuf >> commandResp;
+    ASSERT(commandResp == CMD_SIMSTEP2);
+    uint8_t result; obuf >> result;
+    std::string description; obuf >> description;
+    if (result == RTYPE_NOTIMPLEMENTED) error("TraCI server reported command 0x%2x not implemented (\"%s\"). Might need newer version.", CMD_SIMSTEP2, description.c_str());
+    if (result == RTYPE_ERR) error("TraCI server reported error executing command 0x%2x (\"%s\").", CMD_SIMSTEP2, description.c_str());
+    ASSERT(result == RTYPE_OK);
+
+    // keep the subscription results until the matching OMNeT++ step
+    std::string response = obuf.str();
+    stepResponse = response.substr(response.length() - obuf.remaining());
+    stepResponseAvailable = true;
+}
+
 
 std::string TraCIScenarioManager::genericGetString(uint8_t commandId, std::string objectId, uint8_t variableId, uint8_t responseId) {
 
@@ -889,14 +947,15 @@ void TraCIScenarioManager::subscribeToVehicleVariables(std::string vehicleId) {
     uint32_t beginTime = 0;
     uint32_t endTime = 0x7FFFFFFF;
     std::string objectId = vehicleId;
-    uint8_t variableNumber = 5;
+    uint8_t variableNumber = 6;
     uint8_t variable1 = VAR_POSITION;
     uint8_t variable2 = VAR_ROAD_ID;
     uint8_t variable3 = VAR_SPEED;
     uint8_t variable4 = VAR_ANGLE;
     uint8_t variable5 = VAR_SIGNALS;
+    uint8_t variable6 = VAR_LANEPOSITION;
 
-    TraCIBuffer buf = queryTraCI(CMD_SUBSCRIBE_VEHICLE_VARIABLE, TraCIBuffer() << beginTime << endTime << objectId << variableNumber << variable1 << variable2 << variable3 << variable4 << variable5);
+    TraCIBuffer buf = queryTraCI(CMD_SUBSCRIBE_VEHICLE_VARIABLE, TraCIBuffer() << beginTime << endTime << objectId << variableNumber << variable1 << variable2 << variable3 << variable4 << variable5 << variable6);
     processSubcriptionResult(buf);
     ASSERT(buf.eof());
 }
@@ -985,6 +1044,7 @@ void TraCIScenarioManager::processVehicleSubscription(std::string objectId, TraC
     double speed;
     double angle_traci;
     int signals;
+    double lanePosition;
     int numRead = 0;
 
     uint8_t variableNumber_resp; buf >> variableNumber_resp;
@@ -1053,6 +1113,11 @@ void TraCIScenarioManager::processVehicleSubscription(std::string objectId, TraC
             ASSERT(varType == TYPE_INTEGER);
             buf >> signals;
             numRead++;
+        } else if (variable1_resp == VAR_LANEPOSITION) {
+            uint8_t varType; buf >> varType;
+            ASSERT(varType == TYPE_DOUBLE);
+            buf >> lanePosition;
+            numRead++;
         } else {
             error("Received unhandled vehicle subscription result");
         }
@@ -1062,48 +1127,70 @@ void TraCIScenarioManager::processVehicleSubscription(std::string objectId, TraC
     if (!isSubscribed) return;
 
     // make sure we got updates for all attributes
-    if (numRead != 5) return;
-
-    Coord p = traci2omnet(TraCICoord(px, py));
-    if ((p.x < 0) || (p.y < 0)) error("received bad node position (%.2f, %.2f), translated to (%.2f, %.2f)", px, py, p.x, p.y);
-
-    double angle = traci2omnetAngle(angle_traci);
-
-    cModule* mod = getManagedModule(objectId);
-
-    // is it in the ROI?
-    bool inRoi = isInRegionOfInterest(TraCICoord(px, py), edge, speed, angle);
-    if (!inRoi) {
-        if (mod) {
-            deleteModule(objectId);
-            EV_DEBUG << "Vehicle #" << objectId << " left region of interest" << endl;
-        }
-        else if(unEquippedHosts.find(objectId) != unEquippedHosts.end()) {
-            unEquippedHosts.erase(objectId);
-            EV_DEBUG << "Vehicle (unequipped) # " << objectId<< " left region of interest" << endl;
+    if (numRead != 6) return;
+
+    // store the decoded values, they are applied to the modules once all results of this step are read
+    if (numVehicleUpdates == vehicleUpdates.size()) vehicleUpdates.resize(std::max((size_t)16, 2 * vehicleUpdates.size()));
+    VehicleUpdate& update = vehicleUpdates[numVehicleUpdates++];
+    update.objectId = objectId;
+    update.position = TraCICoord(px, py);
+    update.edge = edge;
+    update.speed = speed;
+    update.angle = angle_traci;
+    update.lanePosition = lanePosition;
+}
+
+void TraCIScenarioManager::applyVehicleUpdates() {
+    for (size_t i = 0; i < numVehicleUpdates; ++i) {
+        const VehicleUpdate& update = vehicleUpdates[i];
+        const std::string& objectId = update.objectId;
+        double px = update.position.x;
+        double py = update.position.y;
+
+        Coord p = traci2omnet(update.position);
+        if ((p.x < 0) || (p.y < 0)) error("received bad node position (%.2f, %.2f), translated to (%.2f, %.2f)", px, py, p.x, p.y);
+
+        double angle = traci2omnetAngle(update.angle);
+
+        std::map<std::string, std::vector<TraCIMobility*> >::iterator mobilities = hostMobilities.find(objectId);
+        bool hasModule = mobilities != hostMobilities.end();
+
+        // is it in the ROI?
+        bool inRoi = isInRegionOfInterest(update.position, update.edge, update.speed, angle);
+        if (!inRoi) {
+            if (hasModule) {
+                deleteModule(objectId);
+                EV_DEBUG << "Vehicle #" << objectId << " left region of interest" << endl;
+            }
+            else if(unEquippedHosts.find(objectId) != unEquippedHosts.end()) {
+                unEquippedHosts.erase(objectId);
+                EV_DEBUG << "Vehicle (unequipped) # " << objectId<< " left region of interest" << endl;
+            }
+            continue;
         }
-        return;
-    }
 
-    if (isModuleUnequipped(objectId)) {
-        return;
-    }
+        if (isModuleUnequipped(objectId)) {
+            continue;
+        }
 
-    if (!mod) {
-        // no such module - need to create
-        addModule(objectId, moduleType, moduleName, moduleDisplayString, p, edge, speed, angle);
-        EV_DEBUG << "Added vehicle #" << objectId << endl;
-    } else {
-        // module existed - update position
-        for (cModule::SubmoduleIterator iter(mod); !iter.end(); iter++) {
-            cModule* submod = iter();
-            TraCIMobility* mm = dynamic_cast<TraCIMobility*>(submod);
-            if (!mm) continue;
-            EV_DEBUG << "module " << objectId << " moving to " << p.x << "," << p.y << endl;
-            mm->nextPosition(p, edge, speed, angle);
+        if (!hasModule) {
+            // no such module - need to create
+            addModule(objectId, moduleType, moduleName, moduleDisplayString, p, update.edge, update.speed, angle);
+            mobilities = hostMobilities.find(objectId);
+            EV_DEBUG << "Added vehicle #" << objectId << endl;
+            if (mobilities != hostMobilities.end())
+                for (std::vector<TraCIMobility*>::iterator mm = mobilities->second.begin(); mm != mobilities->second.end(); ++mm)
+                    (*mm)->setLanePosition(update.lanePosition);
+        } else {
+            // module existed - update position
+            for (std::vector<TraCIMobility*>::iterator mm = mobilities->second.begin(); mm != mobilities->second.end(); ++mm) {
+                EV_DEBUG << "module " << objectId << " moving to " << p.x << "," << p.y << endl;
+                (*mm)->setLanePosition(update.lanePosition);
+                (*mm)->nextPosition(p, update.edge, update.speed, angle);
+            }
         }
     }
-
+    numVehicleUpdates = 0;
 }
 
 void TraCIScenarioManager::processSubcriptionResult(TraCIBuffer& buf) {
@@ -24,8 +24,10 @@
 #include <utility>
 #include <map>
 #include <list>
+#include <vector>
 #include <sstream>
 #include <iomanip>
+#include <cstring>
 
 #include <omnetpp.h>
 
@@ -33,6 +35,8 @@
 #include "Coord.h"
 #include "ModuleAccess.h"
 
+class TraCIMobility;
+
 /**
  * @brief
  * Creates and moves nodes controlled by a TraCI server.
@@ -154,33 +158,33 @@ class INET_API TraCIScenarioManager : public cSimpleModule
                     T buf_to_return;
                     unsigned char *p_buf_to_return = reinterpret_cast<unsigned char*>(&buf_to_return);
 
+                    // check bounds once per value, then copy the whole value at once
+                    if (buf.length() - buf_index < sizeof(buf_to_return)) throw cRuntimeError("Attempted to read past end of byte buffer");
+                    const char *p_buf = buf.data() + buf_index;
                     if (isBigEndian()) {
-                        for (size_t i=0; i<sizeof(buf_to_return); ++i) {
-                            if (eof()) throw cRuntimeError("Attempted to read past end of byte buffer");
-                            p_buf_to_return[i] = buf[buf_index++];
-                        }
+                        memcpy(p_buf_to_return, p_buf, sizeof(buf_to_return));
                     } else {
                         for (size_t i=0; i<sizeof(buf_to_return); ++i) {
-                            if (eof()) throw cRuntimeError("Attempted to read past end of byte buffer");
-                            p_buf_to_return[sizeof(buf_to_return)-1-i] = buf[buf_index++];
+                            p_buf_to_return[sizeof(buf_to_return)-1-i] = p_buf[i];
                         }
                     }
+                    buf_index += sizeof(buf_to_return);
 
                     return buf_to_return;
                 }
 
                 template<typename T> void write(T inv) {
                     unsigned char *p_buf_to_send = reinterpret_cast<unsigned char*>(&inv);
+                    char p_buf[sizeof(inv)];
 
                     if (isBigEndian()) {
-                        for (size_t i=0; i<sizeof(inv); ++i) {
-                            buf += p_buf_to_send[i];
-                        }
+                        memcpy(p_buf, p_buf_to_send, sizeof(inv));
                     } else {
                         for (size_t i=0; i<sizeof(inv); ++i) {
-                            buf += p_buf_to_send[sizeof(inv)-1-i];
+                            p_buf[i] = p_buf_to_send[sizeof(inv)-1-i];
                         }
                     }
+                    buf.append(p_buf, sizeof(inv));
                 }
 
                 template<typename T> T read(T& out) {
@@ -202,6 +206,10 @@ class INET_API TraCIScenarioManager : public cSimpleModule
                     return buf_index == buf.length();
                 }
 
+                size_t remaining() const {
+                    return buf.length() - buf_index;
+                }
+
                 void set(std::string buf) {
                     this->buf = buf;
                     buf_index = 0;
@@ -225,10 +233,10 @@ class INET_API TraCIScenarioManager : public cSimpleModule
                 }
 
             protected:
-                bool isBigEndian() {
-                    short a = 0x0102;
-                    unsigned char *p_a = reinterpret_cast<unsigned char*>(&a);
-                    return (p_a[0] == 0x01);
+                static bool isBigEndian() {
+                    static const short a = 0x0102;
+                    static const bool bigEndian = (reinterpret_cast<const unsigned char*>(&a)[0] == 0x01);
+                    return bigEndian;
                 }
 
                 std::string buf;
@@ -248,6 +256,7 @@ class INET_API TraCIScenarioManager : public cSimpleModule
         double penetrationRate;
         std::list<std::string> roiRoads; /**< which roads (e.g. "hwy1 hwy2") are considered to consitute the region of interest, if not empty */
         std::list<std::pair<TraCICoord, TraCICoord> > roiRects; /**< which rectangles (e.g. "0,0-10,10 20,20-30,30) are considered to consitute the region of interest, if not empty */
+        bool asyncSteps; /**< request the next time step from the TraCI server before the current OMNeT++ step is simulated */
 
         void* socketPtr;
         TraCICoord netbounds1; /* network boundaries as reported by TraCI (x1, y1) */
@@ -255,6 +264,7 @@ class INET_API TraCIScenarioManager : public cSimpleModule
 
         size_t nextNodeVectorIndex; /**< next OMNeT++ module vector index to use */
         std::map<std::string, cModule*> hosts; /**< vector of all hosts managed by us */
+        std::map<std::string, std::vector<TraCIMobility*> > hostMobilities; /**< TraCIMobility submodules of all hosts managed by us */
         std::set<std::string> unEquippedHosts;
         std::set<std::string> subscribedVehicles; /**< all vehicles we have already subscribed to */
         uint32_t activeVehicleCount; /**< number of vehicles reported as active by TraCI server */
@@ -262,10 +272,33 @@ class INET_API TraCIScenarioManager : public cSimpleModule
         cMessage* connectAndStartTrigger; /**< self-message scheduled for when to connect to TraCI server and start running */
         cMessage* executeOneTimestepTrigger; /**< self-message scheduled for when to next call executeOneTimestep */
 
+        /**
+         * Decoded vehicle subscription result, applied after all results of a time step were read
+         */
+        struct VehicleUpdate {
+            std::string objectId;
+            TraCICoord position;
+            std::string edge;
+            double speed;
+            double angle;
+            double lanePosition;
+        };
+        std::vector<VehicleUpdate> vehicleUpdates; /**< vehicle updates of the current time step, reused between steps */
+        size_t numVehicleUpdates; /**< number of valid entries in vehicleUpdates */
+
+        bool stepRequestPending; /**< a time step request was sent, but its response was not read yet (asyncSteps only) */
+        bool stepResponseAvailable; /**< stepResponse holds an unprocessed time step response (asyncSteps only) */
+        std::string stepResponse;
+
         uint32_t getCurrentTimeMs(); /**< get current simulation time (in ms) */
 
         void executeOneTimestep(); /**< read and execute all commands for the next timestep */
 
+        void sendStepRequest(uint32_t targetTime); /**< asks the TraCI server to advance to targetTime without waiting for the response */
+        void receiveStepResponse(); /**< reads the response of a pending time step request, if any */
+        void processStepResponse(TraCIBuffer& buf); /**< processes all subscription results of a time step */
+        void applyVehicleUpdates(); /**< applies all decoded vehicle subscription results in one pass */
+
         void connect();
         virtual void init_traci();
 
@@ -291,6 +324,11 @@ class INET_API TraCIScenarioManager : public cSimpleModule
          */
         TraCIScenarioManager::TraCIBuffer queryTraCIOptional(uint8_t commandId, const TraCIBuffer& buf, bool& success, std::string* errorMsg = 0);
 
+        /**
+         * sends a single command via TraCI and returns the raw response; waits for pending time steps first
+         */
+        std::string sendTraCICommand(uint8_t commandId, const TraCIBuffer& buf);
+
         /**
          * returns byte-buffer containing a TraCI command with optional parameters
          */
@@ -306,6 +344,11 @@ class INET_API TraCIScenarioManager : public cSimpleModule
          */
         std::string receiveTraCIMessage();
 
+        /**
+         * receives exactly len bytes via TraCI
+         */
+        void receiveTraCIBytes(char* buf, size_t len);
+
         /**
          * commonly employed technique to get string values via TraCI
          */
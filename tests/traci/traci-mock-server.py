@@ -0,0 +1,242 @@
+#!/usr/bin/env python
+#
+# Minimal TraCI server for testing and benchmarking TraCIScenarioManager
+# without SUMO. Vehicles depart at the first time step and drive along
+# parallel straight lanes with constant speed until the end time.
+#
+# Usage: traci-mock-server.py [--port 9999] [--vehicles 100] [--end 100]
+#        [--speed 14] [--lanes 4]
+#
+# Only the commands used by TraCIScenarioManager during a simulation run
+# are supported; everything else is answered with "not implemented".
+#
+
+import socket
+import struct
+import sys
+import time
+from optparse import OptionParser
+
+CMD_GETVERSION = 0x00
+CMD_SIMSTEP2 = 0x02
+CMD_CLOSE = 0x7F
+CMD_GET_SIM_VARIABLE = 0xab
+RESPONSE_GET_SIM_VARIABLE = 0xbb
+CMD_SUBSCRIBE_SIM_VARIABLE = 0xdb
+RESPONSE_SUBSCRIBE_SIM_VARIABLE = 0xeb
+CMD_SUBSCRIBE_VEHICLE_VARIABLE = 0xd4
+RESPONSE_SUBSCRIBE_VEHICLE_VARIABLE = 0xe4
+
+POSITION_2D = 0x01
+TYPE_BOUNDINGBOX = 0x05
+TYPE_INTEGER = 0x09
+TYPE_DOUBLE = 0x0B
+TYPE_STRING = 0x0C
+TYPE_STRINGLIST = 0x0E
+
+RTYPE_OK = 0x00
+RTYPE_NOTIMPLEMENTED = 0x01
+
+ID_LIST = 0x00
+VAR_SPEED = 0x40
+VAR_POSITION = 0x42
+VAR_ANGLE = 0x43
+VAR_ROAD_ID = 0x50
+VAR_LANEPOSITION = 0x56
+VAR_SIGNALS = 0x5b
+VAR_TIME_STEP = 0x70
+VAR_DEPARTED_VEHICLES_IDS = 0x74
+VAR_ARRIVED_VEHICLES_IDS = 0x7a
+VAR_NET_BOUNDING_BOX = 0x7c
+
+LANE_WIDTH = 3.2
+
+
+def pack_string(s):
+    return struct.pack("!i", len(s)) + s.encode("ascii")
+
+
+def pack_stringlist(l):
+    return struct.pack("!i", len(l)) + b"".join(pack_string(s) for s in l)
+
+
+def pack_command(commandId, payload):
+    if len(payload) + 2 <= 0xFF:
+        return struct.pack("!BB", len(payload) + 2, commandId) + payload
+    return struct.pack("!BiB", 0, len(payload) + 6, commandId) + payload
+
+
+def pack_status(commandId, result=RTYPE_OK, description=""):
+    return pack_command(commandId, struct.pack("!B", result) + pack_string(description))
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def eof(self):
+        return self.pos >= len(self.data)
+
+    def read(self, fmt):
+        values = struct.unpack_from("!" + fmt, self.data, self.pos)
+        self.pos += struct.calcsize("!" + fmt)
+        return values if len(values) > 1 else values[0]
+
+    def read_string(self):
+        length = self.read("i")
+        s = self.data[self.pos:self.pos + length].decode("ascii")
+        self.pos += length
+        return s
+
+
+class MockServer:
+    def __init__(self, options):
+        self.options = options
+        self.time = 0
+        self.lengthOfNet = options.speed * options.end + 100
+        self.vehicles = ["veh%d" % i for i in range(options.vehicles)]
+        self.departed = False
+        self.arrived = False
+        self.subscribed = set()
+        self.steps = 0
+
+    def vehicle_values(self, vehicleId):
+        index = int(vehicleId[3:])
+        t = self.time / 1000.0
+        lanePosition = self.options.speed * t + (index // self.options.lanes) * 10.0
+        x = lanePosition
+        y = 50 + (index % self.options.lanes) * LANE_WIDTH
+        return [(VAR_POSITION, struct.pack("!Bdd", POSITION_2D, x, y)),
+                (VAR_ROAD_ID, struct.pack("!B", TYPE_STRING) + pack_string("road0")),
+                (VAR_SPEED, struct.pack("!Bd", TYPE_DOUBLE, self.options.speed)),
+                (VAR_ANGLE, struct.pack("!Bd", TYPE_DOUBLE, 90.0)),
+                (VAR_SIGNALS, struct.pack("!Bi", TYPE_INTEGER, 0)),
+                (VAR_LANEPOSITION, struct.pack("!Bd", TYPE_DOUBLE, lanePosition))]
+
+    def subscription_result(self, responseId, objectId, values):
+        payload = pack_string(objectId) + struct.pack("!B", len(values))
+        for variableId, value in values:
+            payload += struct.pack("!BB", variableId, RTYPE_OK) + value
+        return struct.pack("!BiB", 0, len(payload) + 6, responseId) + payload
+
+    def sim_result(self, departed, arrived):
+        return self.subscription_result(RESPONSE_SUBSCRIBE_SIM_VARIABLE, "", [
+            (VAR_DEPARTED_VEHICLES_IDS, struct.pack("!B", TYPE_STRINGLIST) + pack_stringlist(departed)),
+            (VAR_ARRIVED_VEHICLES_IDS, struct.pack("!B", TYPE_STRINGLIST) + pack_stringlist(arrived)),
+            (VAR_TIME_STEP, struct.pack("!Bi", TYPE_INTEGER, self.time))])
+
+    def active_vehicles(self):
+        return self.vehicles if self.departed and not self.arrived else []
+
+    def id_list_result(self):
+        return self.subscription_result(RESPONSE_SUBSCRIBE_VEHICLE_VARIABLE, "", [
+            (ID_LIST, struct.pack("!B", TYPE_STRINGLIST) + pack_stringlist(self.active_vehicles()))])
+
+    def simstep(self, targetTime):
+        self.time = targetTime
+        self.steps += 1
+        departed = []
+        arrived = []
+        if not self.departed:
+            self.departed = True
+            departed = self.vehicles
+        elif not self.arrived and self.time >= self.options.end * 1000:
+            self.arrived = True
+            arrived = self.vehicles
+        results = [self.sim_result(departed, arrived), self.id_list_result()]
+        for vehicleId in self.active_vehicles():
+            if vehicleId in self.subscribed:
+                results.append(self.subscription_result(RESPONSE_SUBSCRIBE_VEHICLE_VARIABLE, vehicleId, self.vehicle_values(vehicleId)))
+        if arrived:
+            self.subscribed.clear()
+        return pack_status(CMD_SIMSTEP2) + struct.pack("!i", len(results)) + b"".join(results)
+
+    def handle_command(self, commandId, r):
+        if commandId == CMD_GETVERSION:
+            return pack_status(commandId) + pack_command(CMD_GETVERSION, struct.pack("!i", 3) + pack_string("TraCI mock server"))
+        if commandId == CMD_SIMSTEP2:
+            return self.simstep(r.read("i"))
+        if commandId == CMD_GET_SIM_VARIABLE:
+            variableId = r.read("B")
+            objectId = r.read_string()
+            if variableId == VAR_NET_BOUNDING_BOX:
+                payload = struct.pack("!B", variableId) + pack_string(objectId) + struct.pack("!Bdddd", TYPE_BOUNDINGBOX, 0, 0, self.lengthOfNet, 100)
+                return pack_status(commandId) + pack_command(RESPONSE_GET_SIM_VARIABLE, payload)
+        if commandId == CMD_SUBSCRIBE_SIM_VARIABLE:
+            return pack_status(commandId) + self.sim_result([], [])
+        if commandId == CMD_SUBSCRIBE_VEHICLE_VARIABLE:
+            beginTime, endTime = r.read("ii")
+            objectId = r.read_string()
+            variableNumber = r.read("B")
+            if objectId == "":
+                return pack_status(commandId) + self.id_list_result()
+            if variableNumber == 0:
+                self.subscribed.discard(objectId)
+                return pack_status(commandId)
+            self.subscribed.add(objectId)
+            return pack_status(commandId) + self.subscription_result(RESPONSE_SUBSCRIBE_VEHICLE_VARIABLE, objectId, self.vehicle_values(objectId))
+        return pack_status(commandId, RTYPE_NOTIMPLEMENTED, "not supported by the mock server")
+
+    def handle_message(self, data):
+        r = Reader(data)
+        response = b""
+        while not r.eof():
+            start = r.pos
+            length = r.read("B")
+            if length == 0:
+                length = r.read("i")
+            commandId = r.read("B")
+            if commandId == CMD_CLOSE:
+                return None
+            response += self.handle_command(commandId, Reader(data[r.pos:start + length]))
+            r.pos = start + length
+        return response
+
+
+def recv_exactly(conn, length):
+    data = b""
+    while len(data) < length:
+        chunk = conn.recv(length - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+
+def main():
+    parser = OptionParser()
+    parser.add_option("--port", type="int", default=9999)
+    parser.add_option("--vehicles", type="int", default=100)
+    parser.add_option("--end", type="int", default=100, help="time when all vehicles arrive, in s")
+    parser.add_option("--speed", type="float", default=14.0)
+    parser.add_option("--lanes", type="int", default=4)
+    (options, args) = parser.parse_args()
+
+    listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    listener.bind(("localhost", options.port))
+    listener.listen(1)
+    conn, addr = listener.accept()
+    conn.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+
+    server = MockServer(options)
+    startTime = time.time()
+    while True:
+        header = recv_exactly(conn, 4)
+        if header is None:
+            break
+        data = recv_exactly(conn, struct.unpack("!i", header)[0] - 4)
+        if data is None:
+            break
+        response = server.handle_message(data)
+        if response is None:
+            break
+        conn.sendall(struct.pack("!i", len(response) + 4) + response)
+    elapsed = time.time() - startTime
+    conn.close()
+    sys.stdout.write("%d steps with %d vehicles in %.3fs (%.1f steps/s)\n" % (server.steps, options.vehicles, elapsed, server.steps / max(elapsed, 1e-9)))
+
+
+if __name__ == "__main__":
+    main()